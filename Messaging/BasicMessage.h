@@ -7,22 +7,46 @@
 #include "MessageHelpers.h"
 #include "MessagingTupleUtils.h"
 #include "MessageTupleBuilder.h"
+#include "MessagePool.h"
+#include "MessageHash.h"
 
 namespace messaging {
 namespace INTERNAL {
 
 	class BinaryDeserializer;
 	class BinarySerializer;
+
+	//DECLSTATICMESSAGE declares an overload of IsStaticMessageDeclaration for its message type
+	//next to the message, it is found by ADL and selects the non virtual base for it
+	constexpr std::false_type IsStaticMessageDeclaration(const void*) noexcept { return {}; }
+
+	template<typename MessageType>
+	using IsStaticMessage = decltype(IsStaticMessageDeclaration(static_cast<const MessageType*>(nullptr)));
+
+	class StaticMessageBase {};
+
+	template<typename MessageType>
+	using MessageBaseType = std::conditional_t<IsStaticMessage<MessageType>::value, StaticMessageBase, IMessage>;
+
+	//static messages never cache their hash, they stay trivially copyable
+	template<typename MessageType>
+	using MessageHashCacheBase = MessageHashCache<DECLMESSAGE_CACHE_HASH && !IsStaticMessage<MessageType>::value, MessageBaseType<MessageType>>;
 }
+	template<typename...> class CombinedMessage;
+
+	//IMessage is only a base if the message was not declared with DECLSTATICMESSAGE,
+	//GetMessageSize and IsEqual are overrides in that case and plain member functions otherwise
 	template<typename DerivedMessageType, typename... BasicMessageFieldTypes>
-	class BasicMessage : public IMessage
+	class BasicMessage : public INTERNAL::MessageHashCacheBase<DerivedMessageType>
 	{
 	public:
 		using TupleFieldTypes = std::tuple<BasicMessageFieldTypes...>;
+		static constexpr bool IsStaticMessage = INTERNAL::IsStaticMessage<DerivedMessageType>::value;
 	protected:
 		using FilterdTupleType = typename INTERNAL::TupleTypeFilter<std::tuple<>, BasicMessageFieldTypes...>::Type;
-		using BuildedTupleType = typename INTERNAL::MessageTupleBuilder<std::tuple<BasicMessageFieldTypes...>,
+		using StdTupleType = typename INTERNAL::MessageTupleBuilder<std::tuple<BasicMessageFieldTypes...>,
 			std::tuple<>, FilterdTupleType>::Type;
+		using BuildedTupleType = std::conditional_t<IsStaticMessage, typename INTERNAL::ToFlatTuple<StdTupleType>::Type, StdTupleType>;
 
 		using BasicMessageType = BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>;
 
@@ -30,15 +54,16 @@ namespace INTERNAL {
 		template<typename...> friend class CombinedMessage;
 		friend INTERNAL::BinarySerializer;
 		friend INTERNAL::BinaryDeserializer;
+		friend INTERNAL::MessageHasher;
 
-		BuildedTupleType m_memberFields;
+		BuildedTupleType m_memberFields{};
 		
 		template<typename FieldType>
 		constexpr decltype(auto) GetArrayFields() const;
 		template<typename FieldType>
 		constexpr decltype(auto) GetArrayFields();
 
-		constexpr decltype(auto) GetAllArrayFields() const;
+		constexpr const BuildedTupleType& GetAllArrayFields() const noexcept;
 
 	public:
 		//Todo replace std::size_t with real Idx Type
@@ -48,6 +73,10 @@ namespace INTERNAL {
 		template<typename... InitVarArgTypes>
 		void SetAll(InitVarArgTypes&&... fields);
 
+		//constructs field Idx from args, returns a reference to it
+		template<std::size_t Idx, typename... ArgTypes>
+		decltype(auto) EmplaceOne(ArgTypes&&... args);
+
 		template<std::size_t Idx>
 		decltype(auto) GetOne();
 		template<std::size_t Idx>
@@ -67,11 +96,16 @@ namespace INTERNAL {
 		template<typename PredType>
 		constexpr void ForEachField(PredType&& pred);
 
-		virtual std::size_t GetMessageSize() const noexcept override;
+		std::size_t GetMessageSize() const noexcept;
 
 		bool operator == (const BasicMessageType& other) const;
 		bool operator != (const BasicMessageType& other) const;
 
+		//the type of other is known, no dynamic_cast needed
+		bool IsEqual(const DerivedMessageType& other) const;
+
+		DECLMESSAGE_POOL_OPERATORS(DerivedMessageType)
+
 	public:
 
 		template<typename... InitVarArgTypes, 
@@ -89,11 +123,17 @@ namespace INTERNAL {
 		BasicMessage(BasicMessage&&) = default;
 		BasicMessage& operator=(BasicMessage&&) = default;
 
-		virtual bool IsEqual(const IMessage&) const override;
+		bool IsEqual(const IMessage&) const;
 	private:
+		template<std::size_t Idx>
+		decltype(auto) GetOneImpl();
+
 		template<typename PredType, std::size_t... Indices>
 		static constexpr void ForEachFieldHelper(BasicMessageType& msg, std::index_sequence<Indices...>, PredType&& pred);
 
+		template<typename... FieldTypes>
+		bool InternalIsEqual(const BasicMessageType& other, const std::tuple<FieldTypes...>& dummyTuple) const;
+
 		template<typename TupleType, std::size_t... Indices>
 		decltype(auto) InitVarArgs(TupleType&& tupleArgs, std::index_sequence<Indices...>);
 		std::size_t InternalGetMessageSize() const noexcept;
@@ -111,7 +151,7 @@ namespace INTERNAL {
 
 
 	template<typename DerivedMessageType>
-	class BasicMessage<DerivedMessageType> : public IMessage {
+	class BasicMessage<DerivedMessageType> : public INTERNAL::MessageHashCache<false, IMessage> {
 	public:
 		constexpr static std::size_t GetStaticMessageSize() noexcept { return 0; }
 		constexpr static std::size_t GetStaticFieldCount() noexcept { return 0; }
@@ -120,6 +160,7 @@ namespace INTERNAL {
 		constexpr inline void ForEachArrayFieldDo(PredicateType&& predicate) const noexcept { (void)predicate; }
 		template<typename PredType>
 		constexpr void ForEachField(PredType&& pred) const noexcept { (void)pred; }
+		DECLMESSAGE_POOL_OPERATORS(DerivedMessageType)
 	};
 }
 
@@ -127,14 +168,16 @@ namespace INTERNAL {
 template<typename DerivedMessageType, typename... BasicMessageFieldTypes>
 template<typename FieldType>
 constexpr decltype(auto) messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::GetArrayFields() const {
-	using Type = typename INTERNAL::EnumConverter<FieldType>::Type;
-	static constexpr std::size_t Count = INTERNAL::CountTypeInTuple<Type, TupleFieldTypes>::Count;
-	return std::get<std::array<Type, Count>>(m_memberFields);
+	//enum fields are stored as the enum type itself
+	using Type = INTERNAL::RemoveCVREF<FieldType>;
+	constexpr std::size_t Count = INTERNAL::CountTypeInTuple<Type, TupleFieldTypes>::Count;
+	return INTERNAL::GetTupleMember<std::array<Type, Count>>(m_memberFields);
 }
 
 
 template<typename DerivedMessageType, typename... BasicMessageFieldTypes>
-constexpr decltype(auto) messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::GetAllArrayFields() const {
+constexpr const typename messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::BuildedTupleType&
+messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::GetAllArrayFields() const noexcept {
 	return m_memberFields;
 }
 
@@ -153,29 +196,39 @@ void messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::Set
 	using Type = std::tuple_element_t<Idx, TupleFieldTypes>;
 	using IndiceContainerType = typename INTERNAL::CreateIndicesByTupleType<Type, TupleFieldTypes>::Type;
 	static constexpr decltype(auto) ConvertedIndiceContainer = INTERNAL::CreateIndiceContainerZeroOffset(IndiceContainerType{});
-	static constexpr std::size_t Count = INTERNAL::CountTypeInTuple<Type, TupleFieldTypes>::Count;
-	std::get<std::array<Type, Count>>(m_memberFields)[ConvertedIndiceContainer[Idx]] = std::forward<ValueType>(value);
+	constexpr std::size_t Count = INTERNAL::CountTypeInTuple<Type, TupleFieldTypes>::Count;
+	this->InvalidateHash();
+	INTERNAL::GetTupleMember<std::array<Type, Count>>(m_memberFields)[ConvertedIndiceContainer[Idx]] = std::forward<ValueType>(value);
 }
 
 
 template<typename DerivedMessageType, typename... BasicMessageFieldTypes>
 template<std::size_t Idx>
 decltype(auto) messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::GetOne() {
+	//the field can be changed through the returned reference
+	this->InvalidateHash();
+	return GetOneImpl<Idx>();
+}
+
+
+template<typename DerivedMessageType, typename... BasicMessageFieldTypes>
+template<std::size_t Idx>
+decltype(auto) messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::GetOneImpl() {
 	using Type = std::tuple_element_t<Idx, TupleFieldTypes>;
-	static constexpr std::size_t Count = INTERNAL::CountTypeInTuple<Type, TupleFieldTypes>::Count;
+	constexpr std::size_t Count = INTERNAL::CountTypeInTuple<Type, TupleFieldTypes>::Count;
 	using IndiceContainerType = typename INTERNAL::CreateIndicesByTupleType<Type, TupleFieldTypes>::Type;
 	static constexpr decltype(auto) ConvertedIndiceContainer = INTERNAL::CreateIndiceContainerZeroOffset(IndiceContainerType{});
 	static_assert(Idx < ConvertedIndiceContainer.size(), R"(you probably did provide the wrong data type because 
 				there are no Field with that index and data type you specified!!!!!)");
-	return std::get<std::array<Type, Count>>(m_memberFields)[ConvertedIndiceContainer[Idx]];
+	return INTERNAL::GetTupleMember<std::array<Type, Count>>(m_memberFields)[ConvertedIndiceContainer[Idx]];
 }
 
 
 template<typename DerivedMessageType, typename... BasicMessageFieldTypes>
 template<std::size_t Idx>
 decltype(auto) messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::GetOne() const {
-	using Type = INTERNAL::RemoveCVREF<decltype(const_cast<BasicMessageType*>(this)->GetOne<Idx>())>;
-	return const_cast<const Type&>(const_cast<BasicMessageType*>(this)->GetOne<Idx>());
+	using Type = INTERNAL::RemoveCVREF<decltype(const_cast<BasicMessageType*>(this)->GetOneImpl<Idx>())>;
+	return const_cast<const Type&>(const_cast<BasicMessageType*>(this)->GetOneImpl<Idx>());
 }
 
 
@@ -197,6 +250,7 @@ constexpr void messaging::BasicMessage<DerivedMessageType, BasicMessageFieldType
 template<typename DerivedMessageType, typename... BasicMessageFieldTypes>
 template<typename PredType>
 constexpr void messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::ForEachField(PredType&& pred) {
+	this->InvalidateHash();
 	const_cast<const BasicMessageType*>(this)->ForEachField(std::forward<PredType>(pred));
 }
 
@@ -213,13 +267,31 @@ template<typename... InitVarArgTypes,
 		&& sizeof...(InitVarArgTypes) != 0)
 	, bool> Dummy>
 messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::BasicMessage(InitVarArgTypes&&... fields) {
-	InitVarArgs(std::forward_as_tuple(fields...), std::make_index_sequence<sizeof...(InitVarArgTypes)>{});
+	InitVarArgs(std::forward_as_tuple(std::forward<InitVarArgTypes>(fields)...), std::make_index_sequence<sizeof...(InitVarArgTypes)>{});
 }
 
 
 template<typename DerivedMessageType, typename... BasicMessageFieldTypes>
 bool messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::operator == (const BasicMessageType& other) const {
-	return GetAllArrayFields() == other.GetAllArrayFields();
+	return InternalIsEqual(other, FilterdTupleType{});
+}
+
+
+template<typename DerivedMessageType, typename... BasicMessageFieldTypes>
+template<typename... FieldTypes>
+inline bool messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::InternalIsEqual(const BasicMessageType& other,
+	const std::tuple<FieldTypes...>& dummyTuple) const {
+	(void)dummyTuple;
+	//one comparison per std::array of equally typed fields, integral ones are a single memcmp.
+	//Trivially copyable fields go first so most unequal messages never get to their strings and vectors
+	bool isEqual = true;
+	(void)std::initializer_list<int>{(isEqual = isEqual &&
+		(!std::is_trivially_copyable<FieldTypes>::value
+		|| INTERNAL::AreArrayFieldsEqual(GetArrayFields<FieldTypes>(), other.template GetArrayFields<FieldTypes>())), 0)...};
+	(void)std::initializer_list<int>{(isEqual = isEqual &&
+		(std::is_trivially_copyable<FieldTypes>::value
+		|| INTERNAL::AreArrayFieldsEqual(GetArrayFields<FieldTypes>(), other.template GetArrayFields<FieldTypes>())), 0)...};
+	return isEqual;
 }
 
 
@@ -231,12 +303,23 @@ inline bool messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes..
 
 template<typename DerivedMessageType, typename ...BasicMessageFieldTypes>
 inline bool messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::IsEqual(const IMessage& other) const {
-	return dynamic_cast<const BasicMessageType&>(other) == *this;
+	const auto* pOther = dynamic_cast<const BasicMessageType*>(&other);
+	return pOther != nullptr && *pOther == *this;
+}
+
+
+template<typename DerivedMessageType, typename ...BasicMessageFieldTypes>
+inline bool messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::IsEqual(const DerivedMessageType& other) const {
+	return static_cast<const BasicMessageType&>(other) == *this;
 }
 
 
 template<typename DerivedMessageType, typename ...BasicMessageFieldTypes>
 inline std::size_t messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::InternalGetMessageSize() const noexcept {
+	if (INTERNAL::IsStaticTuple<TupleFieldTypes>::Value) {
+		//only trivially copyable fields (e.g. FixedString), no need to visit them
+		return GetStaticMessageSize();
+	}
 	std::size_t res = 0;
 	ForEachArrayFieldDo([&res](const auto& val, const std::size_t Idx) { return res += INTERNAL::DynamicSizeOfMessageField(val); });
 	return res;
@@ -250,10 +333,19 @@ inline void messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes..
 }
 
 
+template<typename DerivedMessageType, typename... BasicMessageFieldTypes>
+template<std::size_t Idx, typename... ArgTypes>
+inline decltype(auto) messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::EmplaceOne(ArgTypes&&... args) {
+	auto& field = GetOne<Idx>();
+	INTERNAL::EmplaceField(field, std::forward<ArgTypes>(args)...);
+	return field;
+}
+
+
 template<typename DerivedMessageType, typename... BasicMessageFieldTypes>
 template<typename PredType, std::size_t... Indices>
 constexpr void messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::ForEachFieldHelper(BasicMessageType& msg, std::index_sequence<Indices...>, PredType&& pred) {
-	(void)std::initializer_list<int>{(pred(msg.GetOne<Indices>(), Indices), 0)...};
+	(void)std::initializer_list<int>{(pred(msg.GetOneImpl<Indices>(), Indices), 0)...};
 }
 
 
@@ -275,6 +367,7 @@ decltype(auto) messaging::BasicMessage<DerivedMessageType, BasicMessageFieldType
 template<typename DerivedMessageType, typename... BasicMessageFieldTypes>
 template<typename PredicateType>
 constexpr void messaging::BasicMessage<DerivedMessageType, BasicMessageFieldTypes...>::ForEachArrayFieldDo(PredicateType&& predicate) {
+	this->InvalidateHash();
 	const_cast<const BasicMessageType*>(this)->ForEachArrayFieldDo(std::forward<PredicateType>(predicate));
 }
 
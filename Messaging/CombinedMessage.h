@@ -36,9 +36,14 @@ namespace messaging {
 
 		bool operator != (const MyType& other) const;
 		bool operator == (const MyType& other) const;
+
+		//every base brings its own pool operators, this resolves the ambiguity
+		DECLMESSAGE_POOL_OPERATORS(CombinedMessage)
 	private:
 		template<typename PredType, std::size_t... Indices>
 		constexpr void ForEachFieldHelper(std::index_sequence<Indices...>, PredType&& pred);
+		template<typename TupleType, std::size_t... Indices>
+		void SetAllHelper(TupleType&& tupleArgs, std::index_sequence<Indices...>);
 
 		template<typename MessageType, std::size_t Idx>
 		struct MessageTypeInformation {
@@ -58,7 +63,9 @@ namespace messaging {
 
 template<typename... DerivedBasicMessageTypes>
 inline std::unique_ptr<messaging::IMessage> messaging::CombinedMessage<DerivedBasicMessageTypes...>::Clone() const {
-	return std::make_unique<CombinedMessage>();
+	//every base message has its own IMessage, the first one is used to get an unambiguous pointer
+	using FirstBaseType = std::tuple_element_t<0, MessageBaseClassTuple>;
+	return std::unique_ptr<IMessage>(static_cast<FirstBaseType*>(new CombinedMessage(*this)));
 }
 
 
@@ -93,14 +100,11 @@ inline bool messaging::CombinedMessage<DerivedBasicMessageTypes...>::operator!=(
 
 template<typename ...DerivedBasicMessageTypes>
 inline bool messaging::CombinedMessage<DerivedBasicMessageTypes...>::operator==(const MyType& other) const {
-	const IMessage* baseClassPtrs[] = { static_cast<const IMessage*>(static_cast<const DerivedBasicMessageTypes*>(this))... };
-	const IMessage* otherBaseClassPtrs[] = { static_cast<const IMessage*>(static_cast<const DerivedBasicMessageTypes*>(&other))... };
-	for (std::size_t i = 0; i < sizeof...(DerivedBasicMessageTypes); ++i) {
-		if (!baseClassPtrs[i]->IsEqual(*(otherBaseClassPtrs[i]))) {
-			return false;
-		}
-	}
-	return true;
+	//the part types are known, so the parts are compared directly without the virtual IsEqual
+	bool isEqual = true;
+	(void)std::initializer_list<int>{(isEqual = isEqual &&
+		static_cast<const DerivedBasicMessageTypes&>(*this) == static_cast<const DerivedBasicMessageTypes&>(other), 0)...};
+	return isEqual;
 }
 
 
@@ -131,8 +135,8 @@ inline constexpr std::pair<std::size_t, std::size_t> GetStepIndex(const std::siz
 template<typename ...DerivedBasicMessageTypes>
 template<std::size_t Idx> 
 inline constexpr decltype(auto) messaging::CombinedMessage<DerivedBasicMessageTypes...>::CreateTypeInformation() {
-	static constexpr std::size_t FieldCounts[] = { DerivedBasicMessageTypes::GetStaticFieldCount()... };
-	static constexpr auto IndexAndSubstractCount = GetStepIndex(FieldCounts, Idx);
+	constexpr std::size_t FieldCounts[] = { DerivedBasicMessageTypes::GetStaticFieldCount()... };
+	constexpr auto IndexAndSubstractCount = GetStepIndex(FieldCounts, Idx);
 	using BaseType = std::tuple_element_t<IndexAndSubstractCount.first, MessageBaseClassTuple>;
 	return MessageTypeInformation<BaseType, IndexAndSubstractCount.second>{};
 }
@@ -183,7 +187,18 @@ inline void messaging::CombinedMessage<DerivedBasicMessageTypes...>::SetOne(Valu
 template<typename ...DerivedBasicMessageTypes>
 template<typename ...FieldTypes>
 inline void messaging::CombinedMessage<DerivedBasicMessageTypes...>::SetAll(FieldTypes&&... fields) {
-	throw std::runtime_error{ "Not implemented yet!!!" };
+	static_assert(sizeof...(FieldTypes) <= GetStaticFieldCount(), "Too many arguments for SetAll!!!");
+	SetAllHelper(std::forward_as_tuple(std::forward<FieldTypes>(fields)...), std::make_index_sequence<sizeof...(FieldTypes)>{});
+}
+
+
+template<typename ...DerivedBasicMessageTypes>
+template<typename TupleType, std::size_t... Indices>
+inline void messaging::CombinedMessage<DerivedBasicMessageTypes...>::SetAllHelper(TupleType&& tupleArgs, std::index_sequence<Indices...>) {
+	(void)tupleArgs;
+	(void)std::initializer_list<int>{
+		(SetOne<Indices>(std::forward<std::tuple_element_t<Indices, std::remove_reference_t<TupleType>>>(std::get<Indices>(tupleArgs))), 0)...
+	};
 }
 
 
@@ -218,4 +233,210 @@ inline constexpr void messaging::CombinedMessage<DerivedBasicMessageTypes...>::F
 	(void)std::initializer_list<int>{
 		(pred(static_cast<DerivedBasicMessageTypes*>(inst)), 0)...
 	};
-}
\ No newline at end of file
+}
+
+namespace messaging {
+namespace INTERNAL {
+	template<typename, typename> struct BasicMessageFromTuple;
+
+	template<typename DerivedMessageType, typename... FieldTypes>
+	struct BasicMessageFromTuple<DerivedMessageType, std::tuple<FieldTypes...>> {
+		using Type = BasicMessage<DerivedMessageType, FieldTypes...>;
+	};
+
+	template<typename... MessageTypes>
+	using MergedFieldTypes = decltype(std::tuple_cat(std::declval<typename MessageTypes::FieldTypes>()...));
+
+	template<typename... MessageTypes>
+	constexpr utils::ConstexprStringView GetMergedFieldName(std::size_t idx) noexcept {
+		const utils::ConstexprStringView* const Names[] = { MessageTypes::FieldNameStrings.data()... };
+		const std::size_t FieldCounts[] = { MessageTypes::GetStaticFieldCount()... };
+		for (std::size_t i = 0; i < sizeof...(MessageTypes); ++i) {
+			if (idx < FieldCounts[i]) {
+				return Names[i][idx];
+			}
+			idx -= FieldCounts[i];
+		}
+		return utils::ConstexprStringView{ "None" };
+	}
+
+	//same layout as DECLENUMEX::EnumStrings : all field names followed by "None"
+	template<typename... MessageTypes, std::size_t... Indices>
+	constexpr std::array<utils::ConstexprStringView, sizeof...(Indices)> CreateMergedFieldNames(std::index_sequence<Indices...>) noexcept {
+		return { { GetMergedFieldName<MessageTypes...>(Indices)... } };
+	}
+
+	template<typename PartType, typename... PartMessageTypes>
+	constexpr std::size_t GetPartFieldOffset() noexcept {
+		const bool IsPart[] = { std::is_same<PartType, PartMessageTypes>::value... };
+		const std::size_t FieldCounts[] = { PartMessageTypes::GetStaticFieldCount()... };
+		std::size_t offset = 0;
+		for (std::size_t i = 0; i < sizeof...(PartMessageTypes) && !IsPart[i]; ++i) {
+			offset += FieldCounts[i];
+		}
+		return offset;
+	}
+
+	template<std::size_t Size>
+	struct ConstexprCharArray {
+		char Data[Size];
+	};
+
+	constexpr const char FlatCombinedMessageNamePrefix[] = "FlatCombinedMessage<";
+
+	//the terminating zero of every part name makes room for its ',' or the closing '>'
+	template<typename... PartMessageTypes>
+	constexpr std::size_t GetFlatCombinedMessageNameSize() noexcept {
+		const std::size_t NameSizes[] = { sizeof(PartMessageTypes::MessageStringName)... };
+		std::size_t size = sizeof(FlatCombinedMessageNamePrefix);
+		for (const std::size_t NameSize : NameSizes) {
+			size += NameSize;
+		}
+		return size;
+	}
+
+	//"FlatCombinedMessage<FirstPart,SecondPart>"
+	template<typename... PartMessageTypes>
+	constexpr ConstexprCharArray<GetFlatCombinedMessageNameSize<PartMessageTypes...>()> CreateFlatCombinedMessageName() noexcept {
+		ConstexprCharArray<GetFlatCombinedMessageNameSize<PartMessageTypes...>()> result{};
+		const char* const Names[] = { PartMessageTypes::MessageStringName... };
+		const std::size_t NameLens[] = { (sizeof(PartMessageTypes::MessageStringName) - 1)... };
+		std::size_t pos = 0;
+		for (std::size_t i = 0; i + 1 < sizeof(FlatCombinedMessageNamePrefix); ++i) {
+			result.Data[pos++] = FlatCombinedMessageNamePrefix[i];
+		}
+		for (std::size_t i = 0; i < sizeof...(PartMessageTypes); ++i) {
+			for (std::size_t c = 0; c < NameLens[i]; ++c) {
+				result.Data[pos++] = Names[i][c];
+			}
+			result.Data[pos++] = i + 1 < sizeof...(PartMessageTypes) ? ',' : '>';
+		}
+		result.Data[pos] = '\0';
+		return result;
+	}
+
+	template<typename... PartMessageTypes>
+	struct FlatCombinedMessageName {
+		static constexpr ConstexprCharArray<GetFlatCombinedMessageNameSize<PartMessageTypes...>()> Value =
+			CreateFlatCombinedMessageName<PartMessageTypes...>();
+	};
+
+	template<typename... PartMessageTypes>
+	constexpr ConstexprCharArray<GetFlatCombinedMessageNameSize<PartMessageTypes...>()> FlatCombinedMessageName<PartMessageTypes...>::Value;
+}//namespace INTERNAL
+
+
+	//CombinedMessage without virtual inheritance : the fields of all parts are merged into one BasicMessage,
+	//so there is a single vptr, GetOne/ForEachField/operator== are resolved at compile time
+	//and the binary serializer handles it like every other message.
+	//Fields are addressed by their global index (part after part), by part type + index inside the part
+	//or by the GetXxx/SetXxx/EmplaceXxx of the parts. MessageStringName is "FlatCombinedMessage<FirstPart,SecondPart>",
+	//so MessageTypeId, MessageBus and MessageLog take it like a DECLMESSAGE.
+	template<typename... PartMessageTypes>
+	class FlatCombinedMessage final : public INTERNAL::BasicMessageFromTuple<FlatCombinedMessage<PartMessageTypes...>,
+		INTERNAL::MergedFieldTypes<PartMessageTypes...>>::Type,
+		public PartMessageTypes::template PartAccessors<FlatCombinedMessage<PartMessageTypes...>,
+			INTERNAL::GetPartFieldOffset<PartMessageTypes, PartMessageTypes...>()>... {
+	public:
+		using MyBaseType = typename INTERNAL::BasicMessageFromTuple<FlatCombinedMessage<PartMessageTypes...>,
+			INTERNAL::MergedFieldTypes<PartMessageTypes...>>::Type;
+		using FieldTypes = INTERNAL::MergedFieldTypes<PartMessageTypes...>;
+		using MessagePartTuple = std::tuple<PartMessageTypes...>;
+		using MyBaseType::MyBaseType;
+		using MyBaseType::operator=;
+
+		static constexpr decltype(auto) FieldNameStrings = INTERNAL::CreateMergedFieldNames<PartMessageTypes...>(
+			std::make_index_sequence<std::tuple_size<FieldTypes>::value + 1>{});
+		static constexpr decltype(auto) FieldNameLens = INTERNAL::CreateMessageKeyLens(FieldNameStrings);
+		static constexpr const char(&MessageStringName)[sizeof(INTERNAL::FlatCombinedMessageName<PartMessageTypes...>::Value.Data)] =
+			INTERNAL::FlatCombinedMessageName<PartMessageTypes...>::Value.Data;
+
+		FlatCombinedMessage() = default;
+		virtual ~FlatCombinedMessage() noexcept = default;
+		virtual std::unique_ptr<IMessage> Clone() const override {
+			return std::unique_ptr<IMessage>(new FlatCombinedMessage(*this));
+		}
+
+		static FlatCombinedMessage FromParts(const PartMessageTypes&... parts);
+
+		template<typename PartType>
+		static constexpr std::size_t GetPartFieldOffset() noexcept;
+
+		template<typename PartType, std::size_t PartIdx>
+		decltype(auto) GetPartField() { return this->template GetOne<GetPartFieldOffset<PartType>() + PartIdx>(); }
+		template<typename PartType, std::size_t PartIdx>
+		decltype(auto) GetPartField() const { return this->template GetOne<GetPartFieldOffset<PartType>() + PartIdx>(); }
+		template<typename PartType, std::size_t PartIdx, typename ValueType>
+		void SetPartField(ValueType&& value) {
+			this->template SetOne<GetPartFieldOffset<PartType>() + PartIdx>(std::forward<ValueType>(value));
+		}
+
+		//copies (or moves for rvalues) all fields of part into this message
+		template<typename PartType>
+		void SetPart(PartType&& part);
+		template<typename PartType>
+		PartType GetPart() const;
+
+	private:
+		template<typename PartType, std::size_t... Indices>
+		void SetPartHelper(PartType&& part, std::index_sequence<Indices...>);
+		template<typename PartType, std::size_t... Indices>
+		void GetPartHelper(PartType& part, std::index_sequence<Indices...>) const;
+	};
+}
+
+
+template<typename... PartMessageTypes>
+inline messaging::FlatCombinedMessage<PartMessageTypes...> messaging::FlatCombinedMessage<PartMessageTypes...>::FromParts(
+	const PartMessageTypes&... parts) {
+	FlatCombinedMessage result;
+	(void)std::initializer_list<int>{(result.SetPart(parts), 0)...};
+	return result;
+}
+
+
+template<typename... PartMessageTypes>
+template<typename PartType>
+inline constexpr std::size_t messaging::FlatCombinedMessage<PartMessageTypes...>::GetPartFieldOffset() noexcept {
+	static_assert(INTERNAL::TupleHasType<PartType, MessagePartTuple>::value, "PartType is not a part of this FlatCombinedMessage!!!");
+	return INTERNAL::GetPartFieldOffset<PartType, PartMessageTypes...>();
+}
+
+
+template<typename... PartMessageTypes>
+template<typename PartType>
+inline void messaging::FlatCombinedMessage<PartMessageTypes...>::SetPart(PartType&& part) {
+	using DecayedPartType = INTERNAL::RemoveCVREF<PartType>;
+	SetPartHelper(std::forward<PartType>(part), std::make_index_sequence<DecayedPartType::GetStaticFieldCount()>{});
+}
+
+
+template<typename... PartMessageTypes>
+template<typename PartType>
+inline PartType messaging::FlatCombinedMessage<PartMessageTypes...>::GetPart() const {
+	PartType part;
+	GetPartHelper(part, std::make_index_sequence<PartType::GetStaticFieldCount()>{});
+	return part;
+}
+
+
+template<typename... PartMessageTypes>
+template<typename PartType, std::size_t... Indices>
+inline void messaging::FlatCombinedMessage<PartMessageTypes...>::SetPartHelper(PartType&& part, std::index_sequence<Indices...>) {
+	using DecayedPartType = INTERNAL::RemoveCVREF<PartType>;
+	constexpr std::size_t Offset = GetPartFieldOffset<DecayedPartType>();
+	(void)Offset;
+	(void)std::initializer_list<int>{(this->template SetOne<Offset + Indices>(
+		static_cast<std::conditional_t<std::is_lvalue_reference<PartType>::value,
+			const std::tuple_element_t<Indices, typename DecayedPartType::FieldTypes>&,
+			std::tuple_element_t<Indices, typename DecayedPartType::FieldTypes>&&>>(part.template GetOne<Indices>())), 0)...};
+}
+
+
+template<typename... PartMessageTypes>
+template<typename PartType, std::size_t... Indices>
+inline void messaging::FlatCombinedMessage<PartMessageTypes...>::GetPartHelper(PartType& part, std::index_sequence<Indices...>) const {
+	constexpr std::size_t Offset = GetPartFieldOffset<PartType>();
+	(void)Offset;
+	(void)std::initializer_list<int>{(part.template SetOne<Indices>(this->template GetOne<Offset + Indices>()), 0)...};
+}
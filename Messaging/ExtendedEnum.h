@@ -39,12 +39,14 @@ namespace Enum_INTERNAL {
 }
 
 #define STRINGIZE_TOCONSTEXPRVIEW(r, argument, i, e) ::utils::ConstexprStringView{BOOST_PP_STRINGIZE(e)},
+//BOOST_PP_EXPAND takes exactly one argument, the sequence expands to a comma separated list
+#define EXTENDEDENUM_EXPAND(...) __VA_ARGS__
 
 #define DECLENUMEX(enumName, enumType, ...) \
 	class enumName final { \
 	public: \
 		static constexpr std::array<utils::ConstexprStringView, BOOST_PP_ADD(BOOST_PP_VARIADIC_SIZE(__VA_ARGS__), 1)> EnumStrings = {\
-			BOOST_PP_EXPAND(BOOST_PP_SEQ_FOR_EACH_I(STRINGIZE_TOCONSTEXPRVIEW, 0, BOOST_PP_VARIADIC_TO_SEQ(__VA_ARGS__))) \
+			EXTENDEDENUM_EXPAND(BOOST_PP_SEQ_FOR_EACH_I(STRINGIZE_TOCONSTEXPRVIEW, 0, BOOST_PP_VARIADIC_TO_SEQ(__VA_ARGS__))) \
 			::utils::ConstexprStringView{"None"} \
 		}; \
 		enum enumName##_value : enumType {__VA_ARGS__, None = (std::numeric_limits<enumType>::max)()}; \
@@ -57,7 +59,7 @@ namespace Enum_INTERNAL {
 		static constexpr auto MaxValue() noexcept { return (std::max)({__VA_ARGS__}); } \
 		static constexpr std::size_t GetValueCount() noexcept { return EnumStrings.size(); } \
 		static constexpr decltype(auto) GetValues() noexcept { \
-			static constexpr messaging::ConstexprArray<enumName, GetValueCount()> AllValues = { __VA_ARGS__, None }; \
+			constexpr messaging::ConstexprArray<enumName, GetValueCount()> AllValues = { __VA_ARGS__, None }; \
 			return AllValues; \
 		} \
 		static constexpr decltype(auto) GetNames() noexcept { return EnumStrings; } \
@@ -72,7 +74,7 @@ namespace Enum_INTERNAL {
 		constexpr auto ToString() const noexcept { return ToString(m_value); } \
 		constexpr auto ToIntegral() const noexcept { return static_cast<IntegralType>(m_value); } \
 		static constexpr decltype(auto) GetEnumName() noexcept { \
-			static constexpr utils::ConstexprStringView str{BOOST_PP_STRINGIZE(enumName)}; \
+			constexpr utils::ConstexprStringView str{BOOST_PP_STRINGIZE(enumName)}; \
 			return str; \
 		} \
 	private: \
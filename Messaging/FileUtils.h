@@ -1,9 +1,31 @@
 #pragma once
 #include <cstdio>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <utility>
+#if defined(_WIN32) || defined(_MSC_VER)
+//windows.h would define min/max macros and SendMessage/GetMessage, which collide with the messaging names
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#undef SendMessage
+#undef GetMessage
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 namespace file_utils {
 	inline bool FileReadAllText(const char* fileName, std::string& outText) {
-		FILE* file = ::fopen(fileName, "r");
+		FILE* file = ::fopen(fileName, "rb");
 		if (file == nullptr) {
 			return false;
 		}
@@ -11,7 +33,7 @@ namespace file_utils {
 		const auto Size = ::ftell(file);
 		outText.resize(Size);
 		::fseek(file, 0, SEEK_SET);
-		::fread(outText.data(), outText.size(), 1, file);
+		::fread(&outText[0], outText.size(), 1, file);
 		::fclose(file);
 		return true;
 	}
@@ -26,4 +48,246 @@ namespace file_utils {
 		::fclose(file);
 		return true;
 	}
-}
\ No newline at end of file
+
+
+	//forces the already flushed content of file down to the disk
+	inline bool FileSync(FILE* file) {
+		if (file == nullptr || ::fflush(file) != 0) {
+			return false;
+		}
+#if defined(_WIN32) || defined(_MSC_VER)
+		return ::_commit(::_fileno(file)) == 0;
+#else
+		return ::fdatasync(::fileno(file)) == 0;
+#endif
+	}
+
+
+	//cuts file down to size bytes, e.g. to drop a torn tail before appending, the file position is undefined afterwards
+	inline bool FileTruncate(FILE* file, const std::uint64_t size) {
+		if (file == nullptr || ::fflush(file) != 0) {
+			return false;
+		}
+#if defined(_WIN32) || defined(_MSC_VER)
+		return ::_chsize_s(::_fileno(file), static_cast<__int64>(size)) == 0;
+#else
+		return ::ftruncate(::fileno(file), static_cast<off_t>(size)) == 0;
+#endif
+	}
+
+
+	enum class MapAccessHint { eNORMAL, eSEQUENTIAL, eRANDOM };
+
+	//read only view of a whole file, the content is served directly from the page cache
+	class MappedFile final {
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const char* fileName, MapAccessHint hint = MapAccessHint::eSEQUENTIAL) { Open(fileName, hint); }
+		~MappedFile() { Close(); }
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept { Swap(other); }
+		MappedFile& operator=(MappedFile&& other) noexcept {
+			if (this != &other) {
+				Close();
+				Swap(other);
+			}
+			return *this;
+		}
+
+		bool Open(const char* fileName, MapAccessHint hint = MapAccessHint::eSEQUENTIAL);
+		void Close() noexcept;
+
+		inline bool IsOpen() const noexcept { return m_isOpen; }
+		inline const char* Data() const noexcept { return m_pData; }
+		inline std::size_t Size() const noexcept { return m_size; }
+		inline const char* begin() const noexcept { return m_pData; }
+		inline const char* end() const noexcept { return m_pData + m_size; }
+
+	private:
+		void Swap(MappedFile& other) noexcept {
+			std::swap(m_pData, other.m_pData);
+			std::swap(m_size, other.m_size);
+			std::swap(m_isOpen, other.m_isOpen);
+#if defined(_WIN32) || defined(_MSC_VER)
+			std::swap(m_hFile, other.m_hFile);
+			std::swap(m_hMapping, other.m_hMapping);
+#endif
+		}
+
+		const char* m_pData = nullptr;
+		std::size_t m_size = 0;
+		bool m_isOpen = false;
+#if defined(_WIN32) || defined(_MSC_VER)
+		HANDLE m_hFile = INVALID_HANDLE_VALUE;
+		HANDLE m_hMapping = nullptr;
+#endif
+	};
+
+
+#if defined(_WIN32) || defined(_MSC_VER)
+	inline bool MappedFile::Open(const char* fileName, MapAccessHint hint) {
+		Close();
+		DWORD flags = FILE_ATTRIBUTE_NORMAL;
+		if (hint == MapAccessHint::eSEQUENTIAL) {
+			flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+		} else if (hint == MapAccessHint::eRANDOM) {
+			flags |= FILE_FLAG_RANDOM_ACCESS;
+		}
+		m_hFile = ::CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+		if (m_hFile == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		LARGE_INTEGER fileSize = {};
+		if (!::GetFileSizeEx(m_hFile, &fileSize)) {
+			Close();
+			return false;
+		}
+		m_size = static_cast<std::size_t>(fileSize.QuadPart);
+		m_isOpen = true;
+		if (m_size == 0) {
+			return true;
+		}
+		m_hMapping = ::CreateFileMappingA(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_hMapping == nullptr) {
+			Close();
+			return false;
+		}
+		m_pData = static_cast<const char*>(::MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+		if (m_pData == nullptr) {
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	inline void MappedFile::Close() noexcept {
+		if (m_pData != nullptr) {
+			::UnmapViewOfFile(m_pData);
+		}
+		if (m_hMapping != nullptr) {
+			::CloseHandle(m_hMapping);
+		}
+		if (m_hFile != INVALID_HANDLE_VALUE) {
+			::CloseHandle(m_hFile);
+		}
+		m_hFile = INVALID_HANDLE_VALUE;
+		m_hMapping = nullptr;
+		m_pData = nullptr;
+		m_size = 0;
+		m_isOpen = false;
+	}
+#else
+	inline bool MappedFile::Open(const char* fileName, MapAccessHint hint) {
+		Close();
+		const int fd = ::open(fileName, O_RDONLY | O_CLOEXEC);
+		if (fd == -1) {
+			return false;
+		}
+		struct stat fileStat = {};
+		if (::fstat(fd, &fileStat) == -1) {
+			::close(fd);
+			return false;
+		}
+		m_size = static_cast<std::size_t>(fileStat.st_size);
+		if (m_size != 0) {
+			void* pMapped = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (pMapped == MAP_FAILED) {
+				::close(fd);
+				m_size = 0;
+				return false;
+			}
+			if (hint == MapAccessHint::eSEQUENTIAL) {
+				::madvise(pMapped, m_size, MADV_SEQUENTIAL);
+				::madvise(pMapped, m_size, MADV_WILLNEED);
+			} else if (hint == MapAccessHint::eRANDOM) {
+				::madvise(pMapped, m_size, MADV_RANDOM);
+			}
+			m_pData = static_cast<const char*>(pMapped);
+		}
+		//the mapping keeps its own reference to the file
+		::close(fd);
+		m_isOpen = true;
+		return true;
+	}
+
+	inline void MappedFile::Close() noexcept {
+		if (m_pData != nullptr) {
+			::munmap(const_cast<char*>(m_pData), m_size);
+		}
+		m_pData = nullptr;
+		m_size = 0;
+		m_isOpen = false;
+	}
+#endif
+
+
+	//writes into fileName.tmp first and renames it over fileName afterwards,
+	//so readers either see the old or the complete new content but never a partial file.
+	//false if the directory could not be synced, the new content is in place then but may not survive a crash
+	inline bool FileWriteAllBytesAtomic(const char* fileName, const void* pData, const std::size_t len) {
+		const std::string tmpFileName = std::string{ fileName } + ".tmp";
+#if defined(_WIN32) || defined(_MSC_VER)
+		HANDLE hFile = ::CreateFileA(tmpFileName.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		DWORD written = 0;
+		const bool Success = len == 0 ||
+			(::WriteFile(hFile, pData, static_cast<DWORD>(len), &written, nullptr) && written == len);
+		::FlushFileBuffers(hFile);
+		::CloseHandle(hFile);
+		if (!Success || !::MoveFileExA(tmpFileName.c_str(), fileName, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+			::DeleteFileA(tmpFileName.c_str());
+			return false;
+		}
+		return true;
+#else
+		const int fd = ::open(tmpFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if (fd == -1) {
+			return false;
+		}
+		const char* pCur = static_cast<const char*>(pData);
+		std::size_t remaining = len;
+		while (remaining != 0) {
+			const auto written = ::write(fd, pCur, remaining);
+			if (written == -1 && errno == EINTR) {
+				continue;
+			}
+			if (written <= 0) {
+				::close(fd);
+				::unlink(tmpFileName.c_str());
+				return false;
+			}
+			pCur += written;
+			remaining -= static_cast<std::size_t>(written);
+		}
+		const bool Synced = ::fsync(fd) == 0;
+		if (::close(fd) == -1 || !Synced) {
+			::unlink(tmpFileName.c_str());
+			return false;
+		}
+		if (::rename(tmpFileName.c_str(), fileName) == -1) {
+			::unlink(tmpFileName.c_str());
+			return false;
+		}
+		//the rename itself is only durable once the directory entry is synced
+		const std::string FileName{ fileName };
+		const std::size_t SlashPos = FileName.find_last_of('/');
+		const std::string DirName = SlashPos == std::string::npos ? std::string{ "." } :
+			SlashPos == 0 ? std::string{ "/" } : FileName.substr(0, SlashPos);
+		const int dirFd = ::open(DirName.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (dirFd == -1) {
+			return false;
+		}
+		const bool DirSynced = ::fsync(dirFd) == 0;
+		::close(dirFd);
+		return DirSynced;
+#endif
+	}
+
+	inline bool FileWriteAllTextAtomic(const char* fileName, const std::string& inText) {
+		return FileWriteAllBytesAtomic(fileName, inText.data(), inText.size());
+	}
+}
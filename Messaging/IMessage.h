@@ -19,7 +19,7 @@ namespace messaging {
 				m_message = std::string{ "Message does not contain a array field of type " } +typeid(T).name();
 			}
 		}
-		virtual const char* what() const override { return m_message.c_str(); }
+		virtual const char* what() const noexcept override { return m_message.c_str(); }
 	private:
 		std::string m_message;
 	};
@@ -22,7 +22,9 @@
 	BOOST_PP_CAT(name, ConstFieldType) BOOST_PP_CAT(Get, name()) const noexcept { return this->GetOne<index>(); } \
 	BOOST_PP_CAT(name, Type&) BOOST_PP_CAT(Get, name()) noexcept { return this->GetOne<index>(); } \
 	template<typename FieldType> \
-	void BOOST_PP_CAT(Set, name)(FieldType&& value) { return this->SetOne<index>(std::forward<FieldType>(value)); }
+	void BOOST_PP_CAT(Set, name)(FieldType&& value) { return this->SetOne<index>(std::forward<FieldType>(value)); } \
+	template<typename... ArgTypes> \
+	BOOST_PP_CAT(name, Type&) BOOST_PP_CAT(Emplace, name)(ArgTypes&&... args) { return this->EmplaceOne<index>(std::forward<ArgTypes>(args)...); }
 
 
 namespace messaging {
@@ -33,8 +35,50 @@ namespace messaging {
 	};
 }
 
+#define GENERATE_ROW_FIELD(name, index) \
+	decltype(auto) BOOST_PP_CAT(Get, name()) const noexcept { return this->template GetOne<index>(); } \
+	template<typename FieldType> \
+	void BOOST_PP_CAT(Set, name)(FieldType&& value) const { this->template GetOne<index>() = std::forward<FieldType>(value); }
+
+//row proxy for column stores (see MessageColumnStore.h) with the same generated accessors as the message
+#define DECLROWVIEW(...) \
+	template<typename ColumnStoreType> \
+	class RowView final { \
+	public: \
+		constexpr RowView(ColumnStoreType& store, const std::size_t row) noexcept : m_pStore(&store), m_row(row) {} \
+		template<std::size_t Idx> \
+		decltype(auto) GetOne() const noexcept { return m_pStore->template GetColumn<Idx>()[m_row]; } \
+		constexpr std::size_t GetRowIndex() const noexcept { return m_row; } \
+		FOREACHFIELDNAME(GENERATE_ROW_FIELD, __VA_ARGS__) \
+	private: \
+		ColumnStoreType* m_pStore; \
+		std::size_t m_row; \
+	};
+
+#define GENERATE_PART_FIELD(name, index) \
+	BOOST_PP_CAT(name, ConstFieldType) BOOST_PP_CAT(Get, name()) const noexcept { \
+		return static_cast<const MessageType&>(*this).template GetOne<Offset + index>(); \
+	} \
+	BOOST_PP_CAT(name, Type&) BOOST_PP_CAT(Get, name()) noexcept { return static_cast<MessageType&>(*this).template GetOne<Offset + index>(); } \
+	template<typename FieldType> \
+	void BOOST_PP_CAT(Set, name)(FieldType&& value) { static_cast<MessageType&>(*this).template SetOne<Offset + index>(std::forward<FieldType>(value)); } \
+	template<typename... ArgTypes> \
+	BOOST_PP_CAT(name, Type&) BOOST_PP_CAT(Emplace, name)(ArgTypes&&... args) { \
+		return static_cast<MessageType&>(*this).template EmplaceOne<Offset + index>(std::forward<ArgTypes>(args)...); \
+	}
+
+//the generated accessors for a message which holds the fields of this one starting at field Offset (see FlatCombinedMessage)
+#define DECLPARTACCESSORS(...) \
+	template<typename MessageType, std::size_t Offset> \
+	class PartAccessors { \
+	public: \
+		FOREACHFIELDNAME(GENERATE_PART_FIELD, __VA_ARGS__) \
+	};
+
 #define DECLFIELDNAMES(...) \
 	FOREACHFIELDNAME(GENERATE_FIELD, __VA_ARGS__) \
+	DECLROWVIEW(__VA_ARGS__) \
+	DECLPARTACCESSORS(__VA_ARGS__) \
 	DECLENUMEX(FieldName, std::size_t, __VA_ARGS__) \
 	static constexpr decltype(auto) FieldNameStrings = FieldName::EnumStrings; \
 	static constexpr decltype(auto) FieldNameLens = messaging::INTERNAL::CreateMessageKeyLens(FieldNameStrings);
@@ -83,3 +127,21 @@ namespace messaging {
 	}; \
 	DECLMESSAGE_DECLARE_EXTERN_TEMPLATE(messaging::BasicMessage<msgName, CREATE_TYPECOMMALIST_FROM_VARARGS(__VA_ARGS__)>) \
 	DECLMESSAGE_EXPLICIT_TEMPLATE_INSTANTATION(messaging::BasicMessage<msgName, CREATE_TYPECOMMALIST_FROM_VARARGS(__VA_ARGS__)>)
+
+
+//same as DECLMESSAGE but without IMessage : no vtable, no Clone and standard layout.
+//If all fields are trivially copyable the message is too, so arrays of it can be memcpy'd or put into shared memory
+#define DECLSTATICMESSAGE(msgName, ...) \
+	class msgName; \
+	constexpr std::true_type IsStaticMessageDeclaration(const msgName*) noexcept { return {}; } \
+	class msgName : public messaging::BasicMessage<msgName, CREATE_TYPECOMMALIST_FROM_VARARGS(__VA_ARGS__)> { \
+	public:\
+		static constexpr const char MessageStringName[] = #msgName; \
+		using MyBaseType = messaging::BasicMessage<msgName, CREATE_TYPECOMMALIST_FROM_VARARGS(__VA_ARGS__)>; \
+		using FieldTypes = std::tuple<CREATE_TYPECOMMALIST_FROM_VARARGS(__VA_ARGS__)>; \
+		using BasicMessage<msgName, CREATE_TYPECOMMALIST_FROM_VARARGS(__VA_ARGS__)>::BasicMessage;\
+		using BasicMessage<msgName, CREATE_TYPECOMMALIST_FROM_VARARGS(__VA_ARGS__)>::operator =; \
+		DECLFIELDNAMES(CREATE_NAMECOMMALIST_FROM_VARARGS(__VA_ARGS__)) \
+	}; \
+	DECLMESSAGE_DECLARE_EXTERN_TEMPLATE(messaging::BasicMessage<msgName, CREATE_TYPECOMMALIST_FROM_VARARGS(__VA_ARGS__)>) \
+	DECLMESSAGE_EXPLICIT_TEMPLATE_INSTANTATION(messaging::BasicMessage<msgName, CREATE_TYPECOMMALIST_FROM_VARARGS(__VA_ARGS__)>)
@@ -7,13 +7,18 @@
 #include "MessagingTupleUtils.h"
 
 namespace messaging {
+namespace binary_serilization {
+	//declared before the deserializer, nested messages are deserialized through it
+	template<typename DerivedType, typename... MessageTypes>
+	std::size_t Deserialize(BasicMessage<DerivedType, MessageTypes...>& message, const Byte* pSource, const std::int32_t len = -1);
+}//namespace binary_serilization
 
 namespace INTERNAL {
 	template<typename T>
-	using EnableBoolIfIsTrivial = std::enable_if_t<std::is_trivially_copyable<INTERNAL::RemoveCVREF<T>>::value, bool>;
+	using EnableBoolIfIsTrivial = std::enable_if_t<INTERNAL::IsRawField<INTERNAL::RemoveCVREF<T>>::value, bool>;
 
 	template<typename T>
-	using EnableBoolIfNotIsTrivial = std::enable_if_t<(!std::is_trivially_copyable<INTERNAL::RemoveCVREF<T>>::value), bool>;
+	using EnableBoolIfNotIsTrivial = std::enable_if_t<(!INTERNAL::IsRawField<INTERNAL::RemoveCVREF<T>>::value), bool>;
 
 class BinaryDeserializer final {
 public:
@@ -27,10 +32,18 @@ public:
 		auto* pStart = pSource;
 		m_curPtr = pSource;
 		m_endPtr = m_curPtr + m_len;
-		message.ForEachArrayFieldDo([this](auto& array, const std::size_t Index) {
-			static_assert(INTERNAL::IsStdArray<INTERNAL::RemoveCVREF<decltype(array)>>::Value, "Weired that should be a std::array!!!");
-			DeserializeOne(array);
-		});
+		DeserializePart(message);
+		return m_curPtr - pStart;
+	}
+
+
+	template<typename... MessageTypes>
+	std::size_t Deserialize(CombinedMessage<MessageTypes...>& message, const Byte* pSource, const std::int32_t len) {
+		m_len = len;
+		auto* pStart = pSource;
+		m_curPtr = pSource;
+		m_endPtr = m_curPtr + m_len;
+		(void)std::initializer_list<int>{(DeserializePart(static_cast<MessageTypes&>(message)), 0)...};
 		return m_curPtr - pStart;
 	}
 
@@ -39,8 +52,17 @@ private:
 	const Byte* m_endPtr = nullptr;
 	std::int32_t m_len = -1;
 
-	void DoSizeCheck(const std::int32_t len) const {
-		if (m_len != -1 && m_curPtr + len > m_endPtr) {
+	template<typename DerivedType, typename... MessageTypes>
+	void DeserializePart(BasicMessage<DerivedType, MessageTypes...>& message) {
+		message.ForEachArrayFieldDo([this](auto& array, const std::size_t Index) {
+			static_assert(INTERNAL::IsStdArray<INTERNAL::RemoveCVREF<decltype(array)>>::Value, "Weired that should be a std::array!!!");
+			DeserializeOne(array);
+		});
+	}
+
+	//compares against the remaining bytes, m_curPtr + len could point past the end of the buffer
+	void DoSizeCheck(const std::size_t len) const {
+		if (m_len != -1 && len > static_cast<std::size_t>(m_endPtr - m_curPtr)) {
 			throw std::runtime_error("bytes from client were lower then expected!! got : "+std::to_string(m_len));
 		}
 	}
@@ -56,42 +78,75 @@ private:
 
 	template<typename DerivedType, typename...FieldTypes>
 	void DeserializeOne(BasicMessage<DerivedType, FieldTypes...>& childMsg) {
-		m_curPtr += binary_serilization::Deserialize(childMsg, m_curPtr, m_endPtr - m_curPtr);
+		const std::int32_t RemainingLen = (m_len == -1) ? -1 : static_cast<std::int32_t>(m_endPtr - m_curPtr);
+		m_curPtr += binary_serilization::Deserialize(childMsg, m_curPtr, RemainingLen);
 	}
 
 
-	void DeserializeOne(std::string& str) {
+	template<typename TraitsType, typename AllocatorType>
+	void DeserializeOne(std::basic_string<char, TraitsType, AllocatorType>& str) {
 		const std::size_t StrSize = DeserializeBufferLen();
 		DoSizeCheck(StrSize);
-		str.assign(reinterpret_cast<const std::string::value_type*>(m_curPtr), StrSize);
-		m_curPtr += (str.size() * sizeof(std::string::value_type));
+		str.assign(reinterpret_cast<const char*>(m_curPtr), StrSize);
+		m_curPtr += (str.size() * sizeof(char));
 	}
 
 
-	template<typename T, INTERNAL::EnableBoolIfIsTrivial<T> Dummy = false>
-	void DeserializeOne(std::vector<T>& field) {
-		using VecValT = typename std::vector<T>::value_type;
+	template<typename T, typename AllocatorType, INTERNAL::EnableBoolIfIsTrivial<T> Dummy = false>
+	void DeserializeOne(std::vector<T, AllocatorType>& field) {
+		using VecValT = T;
 		auto bufLen = DeserializeBufferLen();
+		DoSizeCheck(bufLen * sizeof(VecValT));
 		field.resize(bufLen);
 		std::memcpy(field.data(), m_curPtr, field.size() * sizeof(VecValT));
 		m_curPtr += (field.size() * sizeof(VecValT));
 	}
 
 
-	void DeserializeOne(std::vector<bool>& field) {
+	template<typename AllocatorType>
+	void DeserializeOne(std::vector<bool, AllocatorType>& field) {
 		auto bufLen = DeserializeBufferLen();
-		DoSizeCheck(bufLen);
+		DoSizeCheck(bufLen * sizeof(bool));
 		field.resize(bufLen);
 		for (auto&& val : field) {
-			val = *reinterpret_cast<const bool*>(m_curPtr);
+			val = (*m_curPtr != Byte{ 0 });
 			m_curPtr += sizeof(bool);
 		}
 	}
 
 
+	template<std::size_t N>
+	void DeserializeOne(InlineString<N>& str) {
+		const std::size_t StrSize = DeserializeBufferLen();
+		DoSizeCheck(StrSize);
+		str.assign(reinterpret_cast<const char*>(m_curPtr), StrSize);
+		m_curPtr += StrSize;
+	}
+
+
+	template<typename T, std::size_t N, INTERNAL::EnableBoolIfIsTrivial<T> Dummy = false>
+	void DeserializeOne(SmallVector<T, N>& field) {
+		const std::size_t BufLen = DeserializeBufferLen();
+		DoSizeCheck(BufLen * sizeof(T));
+		field.resize(BufLen);
+		std::memcpy(field.data(), m_curPtr, BufLen * sizeof(T));
+		m_curPtr += BufLen * sizeof(T);
+	}
+
+
+	template<typename T, std::size_t N, INTERNAL::EnableBoolIfNotIsTrivial<T> Dummy = false>
+	void DeserializeOne(SmallVector<T, N>& field) {
+		field.resize(DeserializeBufferLen());
+		for (auto& entry : field) {
+			DeserializeOne(entry);
+		}
+	}
+
+
 	std::size_t DeserializeBufferLen() {
-		auto ret = *reinterpret_cast<const INTERNAL::SerializedSizeDataType*>(m_curPtr);
 		DoSizeCheck(sizeof(INTERNAL::SerializedSizeDataType));
+		INTERNAL::SerializedSizeDataType ret = 0;
+		std::memcpy(&ret, m_curPtr, sizeof(ret));
 		m_curPtr += sizeof(INTERNAL::SerializedSizeDataType);
 		if (ret >= (std::numeric_limits<std::uint16_t>::max)()) {
 			throw std::runtime_error{"buffer len was higher than uin16t max!!!!"};
@@ -100,8 +155,8 @@ private:
 	}
 
 
-	template<typename T, INTERNAL::EnableBoolIfNotIsTrivial<T> Dummy = false>
-	void DeserializeOne(std::vector<T>& field) {
+	template<typename T, typename AllocatorType, INTERNAL::EnableBoolIfNotIsTrivial<T> Dummy = false>
+	void DeserializeOne(std::vector<T, AllocatorType>& field) {
 		field.resize(DeserializeBufferLen());
 		for (auto& entry : field) {
 			DeserializeOne(entry);
@@ -120,7 +175,7 @@ private:
 namespace binary_serilization {
 
 	template<typename DerivedType, typename... MessageTypes>
-	inline std::size_t Deserialize(BasicMessage<DerivedType, MessageTypes...>& message, const Byte* pSource, const std::int32_t len = -1) {
+	inline std::size_t Deserialize(BasicMessage<DerivedType, MessageTypes...>& message, const Byte* pSource, const std::int32_t len) {
 		INTERNAL::BinaryDeserializer s;
 		return s.Deserialize(message, pSource, len);
 	}
@@ -131,5 +186,17 @@ namespace binary_serilization {
 		return s.Deserialize(message, pSource.data(), pSource.size());
 	}
 
+	template<typename... MessageTypes>
+	inline std::size_t Deserialize(CombinedMessage<MessageTypes...>& message, const Byte* pSource, const std::int32_t len = -1) {
+		INTERNAL::BinaryDeserializer s;
+		return s.Deserialize(message, pSource, len);
+	}
+
+	template<typename... MessageTypes>
+	inline std::size_t Deserialize(CombinedMessage<MessageTypes...>& message, const std::vector<Byte>& pSource) {
+		INTERNAL::BinaryDeserializer s;
+		return s.Deserialize(message, pSource.data(), pSource.size());
+	}
+
 }//namespace binary_serilization
 }//namespace messaging
\ No newline at end of file
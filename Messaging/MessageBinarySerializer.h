@@ -7,12 +7,18 @@
 #include "MessagingTupleUtils.h"
 
 namespace messaging {
+namespace binary_serilization {
+	//declared before the serializer, nested messages are serialized through it
+	template<typename DerivedType, typename... MessageTypes>
+	std::size_t Serialize(const BasicMessage<DerivedType, MessageTypes...>& message, Byte* pDestination);
+}//namespace binary_serilization
+
 namespace INTERNAL {
 	template<typename T>
-	using EnableBoolIfIsTrivial = std::enable_if_t<std::is_trivially_copyable<INTERNAL::RemoveCVREF<T>>::value, bool>;
+	using EnableBoolIfIsTrivial = std::enable_if_t<INTERNAL::IsRawField<INTERNAL::RemoveCVREF<T>>::value, bool>;
 
 	template<typename T>
-	using EnableBoolIfNotIsTrivial = std::enable_if_t<(!std::is_trivially_copyable<INTERNAL::RemoveCVREF<T>>::value), bool>;
+	using EnableBoolIfNotIsTrivial = std::enable_if_t<(!INTERNAL::IsRawField<INTERNAL::RemoveCVREF<T>>::value), bool>;
 
 class BinarySerializer final {
 public:
@@ -25,10 +31,17 @@ public:
 	inline std::size_t Serialize(const BasicMessage<DerivedType, MessageTypes...>& message, Byte* pDestination) {
 		auto* start = pDestination;
 		m_pDest = pDestination;
-		message.ForEachArrayFieldDo([this](const auto& array, const std::size_t Index) {
-			static_assert(INTERNAL::IsStdArray<INTERNAL::RemoveCVREF<decltype(array)>>::Value, "Weired that should be a std::array!!!");
-			SerializeOne(array);
-		});
+		SerializePart(message);
+		return m_pDest - start;
+	}
+
+
+	//all base messages are written one after another into the same buffer
+	template<typename... MessageTypes>
+	inline std::size_t Serialize(const CombinedMessage<MessageTypes...>& message, Byte* pDestination) {
+		auto* start = pDestination;
+		m_pDest = pDestination;
+		(void)std::initializer_list<int>{(SerializePart(static_cast<const MessageTypes&>(message)), 0)...};
 		return m_pDest - start;
 	}
 
@@ -43,10 +56,30 @@ public:
 		return result;
 	}
 
+
+	template<typename... MessageTypes>
+	inline std::vector<Byte> Serialize(const CombinedMessage<MessageTypes...>& message) {
+		std::vector<Byte> result;
+		result.resize(message.GetMessageSize());
+		if (result.size() < Serialize(message, result.data())) {
+			throw std::runtime_error("FATAL ERROR !!! ACCESS VIOLATION!!!");
+		}
+		return result;
+	}
+
 private:
 	Byte* m_pDest = nullptr;
 
 
+	template<typename DerivedType, typename... MessageTypes>
+	void SerializePart(const BasicMessage<DerivedType, MessageTypes...>& message) {
+		message.ForEachArrayFieldDo([this](const auto& array, const std::size_t Index) {
+			static_assert(INTERNAL::IsStdArray<INTERNAL::RemoveCVREF<decltype(array)>>::Value, "Weired that should be a std::array!!!");
+			SerializeOne(array);
+		});
+	}
+
+
 	template<typename T, INTERNAL::EnableBoolIfIsTrivial<T> Dummy = false>
 	void SerializeOne(const T& field) {
 		using Type = INTERNAL::RemoveCVREF<T>;
@@ -61,24 +94,26 @@ private:
 	}
 
 
-	void SerializeOne(const std::string& str) {
+	template<typename TraitsType, typename AllocatorType>
+	void SerializeOne(const std::basic_string<char, TraitsType, AllocatorType>& str) {
 		SerializeBufferCount(str.size());
-		const std::size_t strSize = str.size() * sizeof(std::string::value_type);
+		const std::size_t strSize = str.size() * sizeof(char);
 		std::memcpy(m_pDest, str.data(), strSize);
 		m_pDest += strSize;
 	}
 
 
-	template<typename T, INTERNAL::EnableBoolIfIsTrivial<T> Dummy = false>
-	void SerializeOne(const std::vector<T>& field) {
+	template<typename T, typename AllocatorType, INTERNAL::EnableBoolIfIsTrivial<T> Dummy = false>
+	void SerializeOne(const std::vector<T, AllocatorType>& field) {
 		SerializeBufferCount(field.size());
-		const std::size_t VecSize = field.size() * sizeof(typename std::vector<T>::value_type);
+		const std::size_t VecSize = field.size() * sizeof(T);
 		std::memcpy(m_pDest, field.data(), VecSize);
 		m_pDest += VecSize;
 	}
 
 
-	void SerializeOne(const std::vector<bool>& field) {
+	template<typename AllocatorType>
+	void SerializeOne(const std::vector<bool, AllocatorType>& field) {
 		SerializeBufferCount(field.size());
 		for (const auto bmem : field) {
 			std::memcpy(m_pDest, &bmem, sizeof(bool));
@@ -87,6 +122,32 @@ private:
 	}
 
 
+	template<std::size_t N>
+	void SerializeOne(const InlineString<N>& str) {
+		SerializeBufferCount(str.size());
+		std::memcpy(m_pDest, str.data(), str.size());
+		m_pDest += str.size();
+	}
+
+
+	template<typename T, std::size_t N, INTERNAL::EnableBoolIfIsTrivial<T> Dummy = false>
+	void SerializeOne(const SmallVector<T, N>& field) {
+		SerializeBufferCount(field.size());
+		const std::size_t VecSize = field.size() * sizeof(T);
+		std::memcpy(m_pDest, field.data(), VecSize);
+		m_pDest += VecSize;
+	}
+
+
+	template<typename T, std::size_t N, INTERNAL::EnableBoolIfNotIsTrivial<T> Dummy = false>
+	void SerializeOne(const SmallVector<T, N>& field) {
+		SerializeBufferCount(field.size());
+		for (const auto& entry : field) {
+			SerializeOne(entry);
+		}
+	}
+
+
 	void SerializeBufferCount(const std::size_t BufferLen) {
 		const auto bufLen = static_cast<INTERNAL::SerializedSizeDataType>(BufferLen);
 		std::memcpy(m_pDest, &bufLen, sizeof(INTERNAL::SerializedSizeDataType));
@@ -94,8 +155,8 @@ private:
 	}
 
 
-	template<typename T, INTERNAL::EnableBoolIfNotIsTrivial<T> Dummy = false>
-	void SerializeOne(const std::vector<T>& field) {
+	template<typename T, typename AllocatorType, INTERNAL::EnableBoolIfNotIsTrivial<T> Dummy = false>
+	void SerializeOne(const std::vector<T, AllocatorType>& field) {
 		SerializeBufferCount(field.size());
 		for (const auto& entry : field) {
 			SerializeOne(entry);
@@ -124,5 +185,17 @@ namespace binary_serilization {
 		INTERNAL::BinarySerializer s;
 		return s.Serialize(message);
 	}
+
+	template<typename... MessageTypes>
+	inline std::size_t Serialize(const CombinedMessage<MessageTypes...>& message, Byte* pDestination) {
+		INTERNAL::BinarySerializer s;
+		return s.Serialize(message, pDestination);
+	}
+
+	template<typename... MessageTypes>
+	inline std::vector<Byte> Serialize(const CombinedMessage<MessageTypes...>& message) {
+		INTERNAL::BinarySerializer s;
+		return s.Serialize(message);
+	}
 }//namespace binary_serilization
 }//namespace messaging
\ No newline at end of file
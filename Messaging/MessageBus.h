@@ -0,0 +1,185 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include "MessageHelpers.h"
+
+namespace messaging {
+
+	//routes messages to the handlers subscribed to their type, keyed by MessageTypeId.
+	//Every type has a flat vector of handlers which are called through a plain function pointer,
+	//the message is never cast at runtime. Not thread safe, use one bus per thread or lock around it.
+	class MessageBus final {
+	public:
+		using SubscriptionId = std::uint64_t;
+
+		MessageBus() = default;
+		MessageBus(const MessageBus&) = delete;
+		MessageBus& operator=(const MessageBus&) = delete;
+
+		//handler(const MessageType&) is called for every published message
+		template<typename MessageType, typename FuncType>
+		SubscriptionId Subscribe(FuncType&& handler) {
+			using HandlerType = std::decay_t<FuncType>;
+			return AddHandler<MessageType>(new HandlerType(std::forward<FuncType>(handler)), &InvokeEach<MessageType, HandlerType>, &DeleteHandler<HandlerType>);
+		}
+
+		//handler(const MessageType* pMsgs, std::size_t count) gets a PublishBatch with a single call
+		template<typename MessageType, typename FuncType>
+		SubscriptionId SubscribeBatch(FuncType&& handler) {
+			using HandlerType = std::decay_t<FuncType>;
+			return AddHandler<MessageType>(new HandlerType(std::forward<FuncType>(handler)), &InvokeBatch<MessageType, HandlerType>, &DeleteHandler<HandlerType>);
+		}
+
+		//may be called from a handler, even for the handler itself
+		bool Unsubscribe(const SubscriptionId id) {
+			const auto It = m_topics.find(static_cast<std::uint32_t>(id >> 32));
+			if (It == m_topics.end()) {
+				return false;
+			}
+			for (Handler& handler : It->second.handlers) {
+				if (handler.serial == static_cast<std::uint32_t>(id) && handler.pInvoke != nullptr) {
+					//the handler may be running, it is destroyed once no Publish is in progress
+					handler.pInvoke = nullptr;
+					m_hasRemoved = true;
+					if (m_dispatchDepth == 0) {
+						Compact();
+					}
+					return true;
+				}
+			}
+			return false;
+		}
+
+		//returns the number of handlers called
+		template<typename MessageType>
+		std::size_t Publish(const MessageType& msg) { return PublishBatch(&msg, 1); }
+
+		template<typename MessageType>
+		std::size_t PublishBatch(const MessageType* pMsgs, const std::size_t count) {
+			Topic* pTopic = FindTopic<MessageType>();
+			if (pTopic == nullptr || count == 0) {
+				return 0;
+			}
+			DispatchGuard guard(*this);
+			//handlers subscribed meanwhile get the next message, the vector may grow so it is indexed every time
+			const std::size_t HandlerCount = pTopic->handlers.size();
+			std::size_t called = 0;
+			for (std::size_t i = 0; i < HandlerCount; ++i) {
+				const Handler& handler = pTopic->handlers[i];
+				if (handler.pInvoke != nullptr) {
+					handler.pInvoke(handler.pCallable.get(), pMsgs, count);
+					++called;
+				}
+			}
+			return called;
+		}
+
+		template<typename MessageType>
+		std::size_t GetHandlerCount() const {
+			const auto It = m_topics.find(MessageTypeId<MessageType>);
+			if (It == m_topics.end()) {
+				return 0;
+			}
+			return static_cast<std::size_t>(std::count_if(It->second.handlers.begin(), It->second.handlers.end(),
+				[](const Handler& handler) { return handler.pInvoke != nullptr; }));
+		}
+
+	private:
+		using InvokeFuncType = void(*)(void* pCallable, const void* pMsgs, std::size_t count);
+		using DeleteFuncType = void(*)(void* pCallable);
+
+		struct Handler {
+			std::uint32_t serial;
+			//nullptr once unsubscribed
+			InvokeFuncType pInvoke;
+			std::unique_ptr<void, DeleteFuncType> pCallable;
+		};
+
+		struct Topic {
+			//MessageTypeId is a hash, the tag catches two types with the same id
+			const void* pTypeTag;
+			std::vector<Handler> handlers;
+		};
+
+		class DispatchGuard final {
+		public:
+			explicit DispatchGuard(MessageBus& bus) noexcept : m_bus(bus) { ++m_bus.m_dispatchDepth; }
+			~DispatchGuard() noexcept {
+				if (--m_bus.m_dispatchDepth == 0 && m_bus.m_hasRemoved) {
+					m_bus.Compact();
+				}
+			}
+		private:
+			MessageBus& m_bus;
+		};
+
+		template<typename MessageType>
+		static const void* GetTypeTag() noexcept {
+			static const char Tag = 0;
+			return &Tag;
+		}
+
+		template<typename MessageType, typename HandlerType>
+		static void InvokeEach(void* pCallable, const void* pMsgs, const std::size_t count) {
+			HandlerType& handler = *static_cast<HandlerType*>(pCallable);
+			const MessageType* pTyped = static_cast<const MessageType*>(pMsgs);
+			for (std::size_t i = 0; i < count; ++i) {
+				handler(pTyped[i]);
+			}
+		}
+
+		template<typename MessageType, typename HandlerType>
+		static void InvokeBatch(void* pCallable, const void* pMsgs, const std::size_t count) {
+			(*static_cast<HandlerType*>(pCallable))(static_cast<const MessageType*>(pMsgs), count);
+		}
+
+		template<typename HandlerType>
+		static void DeleteHandler(void* pCallable) noexcept { delete static_cast<HandlerType*>(pCallable); }
+
+		template<typename MessageType>
+		Topic* FindTopic() {
+			const auto It = m_topics.find(MessageTypeId<MessageType>);
+			if (It == m_topics.end()) {
+				return nullptr;
+			}
+			if (It->second.pTypeTag != GetTypeTag<MessageType>()) {
+				throw std::runtime_error("two message types with the same MessageTypeId!!!");
+			}
+			return &It->second;
+		}
+
+		template<typename MessageType, typename HandlerType>
+		SubscriptionId AddHandler(HandlerType* pCallable, const InvokeFuncType pInvoke, const DeleteFuncType pDelete) {
+			std::unique_ptr<void, DeleteFuncType> callable(pCallable, pDelete);
+			Topic* pTopic = FindTopic<MessageType>();
+			if (pTopic == nullptr) {
+				pTopic = &m_topics.emplace(MessageTypeId<MessageType>, Topic{ GetTypeTag<MessageType>(), {} }).first->second;
+			}
+			const std::uint32_t Serial = ++m_lastSerial;
+			pTopic->handlers.push_back(Handler{ Serial, pInvoke, std::move(callable) });
+			return (static_cast<SubscriptionId>(MessageTypeId<MessageType>) << 32) | Serial;
+		}
+
+		void Compact() {
+			for (auto it = m_topics.begin(); it != m_topics.end();) {
+				auto& handlers = it->second.handlers;
+				handlers.erase(std::remove_if(handlers.begin(), handlers.end(),
+					[](const Handler& handler) { return handler.pInvoke == nullptr; }), handlers.end());
+				it = handlers.empty() ? m_topics.erase(it) : std::next(it);
+			}
+			m_hasRemoved = false;
+		}
+
+		std::unordered_map<std::uint32_t, Topic> m_topics;
+		std::uint32_t m_lastSerial = 0;
+		std::size_t m_dispatchDepth = 0;
+		bool m_hasRemoved = false;
+	};
+}//namespace messaging
@@ -0,0 +1,678 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "FileUtils.h"
+#include "MessageColumnStore.h"
+
+//Columnar file format for many messages of one DECLMESSAGE type.
+//
+//	header : uint32 magic, uint32 version
+//	blocks : for every block of RowsPerBlock rows every column is encoded on its own (raw, delta varint or run length)
+//	footer : message name, per field name + type code, row/block counts and per block and column
+//	         offset, size, encoding and min/max stats
+//	tail   : uint64 footer offset, uint32 magic
+//
+//Readers only touch the footer and the column blocks they need, so scanning 2 of 40 fields only pages in those columns.
+namespace messaging {
+
+	struct ColumnFileOptions {
+		std::size_t RowsPerBlock = 64 * 1024;
+		//false writes every block raw, which is faster to write but larger
+		bool Compress = true;
+	};
+
+	template<typename T>
+	struct ColumnBlockStats {
+		bool HasStats = false;
+		T Min{};
+		T Max{};
+	};
+
+namespace INTERNAL {
+	static constexpr std::uint32_t ColumnFileMagic = 0x46434D52; // "RMCF"
+	static constexpr std::uint32_t ColumnFileVersion = 1;
+	static constexpr std::size_t ColumnFileTailSize = sizeof(std::uint64_t) + sizeof(std::uint32_t);
+
+	enum class ColumnTypeCode : std::uint8_t {
+		eNONE, eBOOL, eINT8, eUINT8, eINT16, eUINT16, eINT32, eUINT32, eINT64, eUINT64, eFLOAT, eDOUBLE, eSTRING, eVECTOR
+	};
+
+	enum class ColumnEncoding : std::uint8_t { eRAW, eDELTA_VARINT, eRUN_LENGTH };
+
+	template<typename T, typename = void>
+	struct ColumnTypeTraits {
+		static constexpr ColumnTypeCode Code = ColumnTypeCode::eNONE;
+		static constexpr ColumnTypeCode ElementCode = ColumnTypeCode::eNONE;
+	};
+
+	template<typename T>
+	struct ColumnTypeTraits<T, std::enable_if_t<std::is_arithmetic<T>::value>> {
+		static constexpr ColumnTypeCode Code =
+			std::is_same<T, bool>::value ? ColumnTypeCode::eBOOL :
+			std::is_floating_point<T>::value ? (sizeof(T) == sizeof(float) ? ColumnTypeCode::eFLOAT :
+				sizeof(T) == sizeof(double) ? ColumnTypeCode::eDOUBLE : ColumnTypeCode::eNONE) :
+			sizeof(T) == 1 ? (std::is_signed<T>::value ? ColumnTypeCode::eINT8 : ColumnTypeCode::eUINT8) :
+			sizeof(T) == 2 ? (std::is_signed<T>::value ? ColumnTypeCode::eINT16 : ColumnTypeCode::eUINT16) :
+			sizeof(T) == 4 ? (std::is_signed<T>::value ? ColumnTypeCode::eINT32 : ColumnTypeCode::eUINT32) :
+			(std::is_signed<T>::value ? ColumnTypeCode::eINT64 : ColumnTypeCode::eUINT64);
+		static constexpr ColumnTypeCode ElementCode = ColumnTypeCode::eNONE;
+	};
+
+	template<typename T>
+	struct ColumnTypeTraits<T, std::enable_if_t<std::is_enum<T>::value>> : ColumnTypeTraits<std::underlying_type_t<T>> {};
+
+	template<>
+	struct ColumnTypeTraits<std::string, void> {
+		static constexpr ColumnTypeCode Code = ColumnTypeCode::eSTRING;
+		static constexpr ColumnTypeCode ElementCode = ColumnTypeCode::eNONE;
+	};
+
+	template<typename T>
+	struct ColumnTypeTraits<std::vector<T>, std::enable_if_t<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>> {
+		static constexpr ColumnTypeCode Code = ColumnTypeCode::eVECTOR;
+		static constexpr ColumnTypeCode ElementCode = ColumnTypeTraits<T>::Code;
+	};
+
+	template<typename T>
+	constexpr bool IsScalarColumn = std::is_arithmetic<T>::value || std::is_enum<T>::value;
+
+
+	inline void AppendVarUInt(std::vector<Byte>& buffer, std::uint64_t value) {
+		while (value >= 0x80) {
+			buffer.push_back(static_cast<Byte>((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+		buffer.push_back(static_cast<Byte>(value));
+	}
+
+	inline std::uint64_t ReadVarUInt(const Byte*& pCur, const Byte* pEnd) {
+		std::uint64_t value = 0;
+		for (std::uint32_t shift = 0; shift < 64; shift += 7) {
+			if (pCur >= pEnd) {
+				throw std::runtime_error{ "column block is truncated!!!" };
+			}
+			const auto Cur = static_cast<std::uint8_t>(*pCur++);
+			value |= static_cast<std::uint64_t>(Cur & 0x7F) << shift;
+			if ((Cur & 0x80) == 0) {
+				return value;
+			}
+		}
+		throw std::runtime_error{ "invalid varint in column block!!!" };
+	}
+
+	inline void AppendBytes(std::vector<Byte>& buffer, const void* pData, const std::size_t len) {
+		const std::size_t Offset = buffer.size();
+		buffer.resize(Offset + len);
+		if (len != 0) {
+			std::memcpy(buffer.data() + Offset, pData, len);
+		}
+	}
+
+	inline void ReadBytes(const Byte*& pCur, const Byte* pEnd, void* pDest, const std::size_t len) {
+		if (static_cast<std::size_t>(pEnd - pCur) < len) {
+			throw std::runtime_error{ "column block is truncated!!!" };
+		}
+		if (len != 0) {
+			std::memcpy(pDest, pCur, len);
+		}
+		pCur += len;
+	}
+
+	//integral values are widened to 64 bit (sign extended) so deltas wrap consistently
+	template<typename T>
+	inline std::uint64_t ToWideBits(const T value) noexcept {
+		using IntegralType = typename EnumConverter<T>::Type;
+		return static_cast<std::uint64_t>(static_cast<std::conditional_t<std::is_signed<IntegralType>::value, std::int64_t, std::uint64_t>>(
+			static_cast<IntegralType>(value)));
+	}
+
+	template<typename T>
+	inline T FromWideBits(const std::uint64_t value) noexcept {
+		using IntegralType = typename EnumConverter<T>::Type;
+		return static_cast<T>(static_cast<IntegralType>(value));
+	}
+
+	template<typename T>
+	inline void EncodeDeltaVarInt(const T* pValues, const std::size_t count, std::vector<Byte>& out) {
+		std::uint64_t previous = 0;
+		for (std::size_t i = 0; i < count; ++i) {
+			const std::uint64_t Current = ToWideBits(pValues[i]);
+			const auto Delta = static_cast<std::int64_t>(Current - previous);
+			AppendVarUInt(out, (static_cast<std::uint64_t>(Delta) << 1) ^ static_cast<std::uint64_t>(Delta >> 63));
+			previous = Current;
+		}
+	}
+
+	template<typename T>
+	inline void DecodeDeltaVarInt(const Byte* pCur, const Byte* pEnd, T* pValues, const std::size_t count) {
+		std::uint64_t previous = 0;
+		for (std::size_t i = 0; i < count; ++i) {
+			const std::uint64_t ZigZag = ReadVarUInt(pCur, pEnd);
+			previous += (ZigZag >> 1) ^ (~(ZigZag & 1) + 1);
+			pValues[i] = FromWideBits<T>(previous);
+		}
+	}
+
+	template<typename T>
+	inline void EncodeRunLength(const T* pValues, const std::size_t count, std::vector<Byte>& out) {
+		for (std::size_t i = 0; i < count;) {
+			std::size_t runEnd = i + 1;
+			while (runEnd < count && std::memcmp(&pValues[runEnd], &pValues[i], sizeof(T)) == 0) {
+				++runEnd;
+			}
+			AppendVarUInt(out, runEnd - i);
+			AppendBytes(out, &pValues[i], sizeof(T));
+			i = runEnd;
+		}
+	}
+
+	template<typename T>
+	inline void DecodeRunLength(const Byte* pCur, const Byte* pEnd, T* pValues, const std::size_t count) {
+		for (std::size_t i = 0; i < count;) {
+			const std::uint64_t RunLength = ReadVarUInt(pCur, pEnd);
+			if (RunLength == 0 || RunLength > count - i) {
+				throw std::runtime_error{ "invalid run length in column block!!!" };
+			}
+			T value;
+			ReadBytes(pCur, pEnd, &value, sizeof(T));
+			std::fill(pValues + i, pValues + i + RunLength, value);
+			i += static_cast<std::size_t>(RunLength);
+		}
+	}
+
+	//scalar columns pick the smallest of the available encodings per block
+	template<typename T, std::enable_if_t<IsScalarColumn<T>, bool> Dummy = false>
+	inline ColumnEncoding EncodeColumnBlock(const T* pValues, const std::size_t count, const bool Compress, std::vector<Byte>& out) {
+		const std::size_t RawSize = count * sizeof(T);
+		if (Compress) {
+			std::vector<Byte> runLength;
+			EncodeRunLength(pValues, count, runLength);
+			std::vector<Byte> delta;
+			if (!std::is_floating_point<T>::value && !std::is_same<T, bool>::value) {
+				EncodeDeltaVarInt(pValues, count, delta);
+			}
+			if (!delta.empty() && delta.size() < RawSize && delta.size() <= runLength.size()) {
+				AppendBytes(out, delta.data(), delta.size());
+				return ColumnEncoding::eDELTA_VARINT;
+			}
+			if (runLength.size() < RawSize) {
+				AppendBytes(out, runLength.data(), runLength.size());
+				return ColumnEncoding::eRUN_LENGTH;
+			}
+		}
+		AppendBytes(out, pValues, RawSize);
+		return ColumnEncoding::eRAW;
+	}
+
+	template<typename T, std::enable_if_t<IsScalarColumn<T>, bool> Dummy = false>
+	inline void DecodeColumnBlock(const ColumnEncoding encoding, const Byte* pCur, const Byte* pEnd, T* pValues, const std::size_t count) {
+		switch (encoding) {
+		case ColumnEncoding::eRAW:
+			ReadBytes(pCur, pEnd, pValues, count * sizeof(T));
+			break;
+		case ColumnEncoding::eDELTA_VARINT:
+			DecodeDeltaVarInt(pCur, pEnd, pValues, count);
+			break;
+		case ColumnEncoding::eRUN_LENGTH:
+			DecodeRunLength(pCur, pEnd, pValues, count);
+			break;
+		default:
+			throw std::runtime_error{ "unknown column block encoding!!!" };
+		}
+	}
+
+	inline ColumnEncoding EncodeColumnBlock(const std::string* pValues, const std::size_t count, const bool Compress, std::vector<Byte>& out) {
+		(void)Compress;
+		for (std::size_t i = 0; i < count; ++i) {
+			AppendVarUInt(out, pValues[i].size());
+			AppendBytes(out, pValues[i].data(), pValues[i].size());
+		}
+		return ColumnEncoding::eRAW;
+	}
+
+	inline void DecodeColumnBlock(const ColumnEncoding encoding, const Byte* pCur, const Byte* pEnd, std::string* pValues, const std::size_t count) {
+		(void)encoding;
+		for (std::size_t i = 0; i < count; ++i) {
+			const auto Len = static_cast<std::size_t>(ReadVarUInt(pCur, pEnd));
+			if (Len > static_cast<std::size_t>(pEnd - pCur)) {
+				throw std::runtime_error{ "column block is truncated!!!" };
+			}
+			pValues[i].resize(Len);
+			ReadBytes(pCur, pEnd, &pValues[i][0], Len);
+		}
+	}
+
+	template<typename T>
+	inline ColumnEncoding EncodeColumnBlock(const std::vector<T>* pValues, const std::size_t count, const bool Compress, std::vector<Byte>& out) {
+		(void)Compress;
+		for (std::size_t i = 0; i < count; ++i) {
+			AppendVarUInt(out, pValues[i].size());
+			AppendBytes(out, pValues[i].data(), pValues[i].size() * sizeof(T));
+		}
+		return ColumnEncoding::eRAW;
+	}
+
+	template<typename T>
+	inline void DecodeColumnBlock(const ColumnEncoding encoding, const Byte* pCur, const Byte* pEnd, std::vector<T>* pValues, const std::size_t count) {
+		(void)encoding;
+		for (std::size_t i = 0; i < count; ++i) {
+			const auto Len = static_cast<std::size_t>(ReadVarUInt(pCur, pEnd));
+			if (Len > static_cast<std::size_t>(pEnd - pCur) / sizeof(T)) {
+				throw std::runtime_error{ "column block is truncated!!!" };
+			}
+			pValues[i].resize(Len);
+			ReadBytes(pCur, pEnd, pValues[i].data(), Len * sizeof(T));
+		}
+	}
+
+	//NaNs are left out, they would make every comparison of a block filter fail. A block of NaNs only has no stats
+	template<typename T, std::enable_if_t<IsScalarColumn<T>, bool> Dummy = false>
+	inline void ComputeBlockStats(const T* pValues, const std::size_t count, ColumnBlockStats<T>& outStats) {
+		outStats.HasStats = false;
+		for (std::size_t i = 0; i < count; ++i) {
+			const T& Value = pValues[i];
+			if (!(Value == Value)) {
+				continue;
+			}
+			if (!outStats.HasStats) {
+				outStats.Min = Value;
+				outStats.Max = Value;
+				outStats.HasStats = true;
+			} else if (Value < outStats.Min) {
+				outStats.Min = Value;
+			} else if (outStats.Max < Value) {
+				outStats.Max = Value;
+			}
+		}
+	}
+
+	template<typename T, std::enable_if_t<!IsScalarColumn<T>, bool> Dummy = false>
+	inline void ComputeBlockStats(const T* pValues, const std::size_t count, ColumnBlockStats<T>& outStats) {
+		(void)pValues; (void)count;
+		outStats.HasStats = false;
+	}
+
+	struct ColumnFileChunkInfo {
+		std::uint64_t Offset = 0;
+		std::uint64_t Size = 0;
+		ColumnEncoding Encoding = ColumnEncoding::eRAW;
+		bool HasStats = false;
+		std::uint64_t Min = 0;
+		std::uint64_t Max = 0;
+	};
+
+	//the stats are stored in the 8 bytes of Min/Max of the chunk
+	template<typename T, std::enable_if_t<IsScalarColumn<T>, bool> Dummy = false>
+	inline void WriteBlockStats(const ColumnBlockStats<T>& stats, ColumnFileChunkInfo& chunk) noexcept {
+		static_assert(sizeof(T) <= sizeof(std::uint64_t), "column block stats are limited to 8 byte values!!!");
+		chunk.HasStats = stats.HasStats;
+		chunk.Min = 0;
+		chunk.Max = 0;
+		if (stats.HasStats) {
+			std::memcpy(&chunk.Min, &stats.Min, sizeof(T));
+			std::memcpy(&chunk.Max, &stats.Max, sizeof(T));
+		}
+	}
+
+	template<typename T, std::enable_if_t<!IsScalarColumn<T>, bool> Dummy = false>
+	inline void WriteBlockStats(const ColumnBlockStats<T>& stats, ColumnFileChunkInfo& chunk) noexcept {
+		(void)stats;
+		chunk.HasStats = false;
+	}
+
+	template<typename T, std::enable_if_t<IsScalarColumn<T>, bool> Dummy = false>
+	inline void ReadBlockStats(const ColumnFileChunkInfo& chunk, ColumnBlockStats<T>& outStats) noexcept {
+		static_assert(sizeof(T) <= sizeof(std::uint64_t), "column block stats are limited to 8 byte values!!!");
+		outStats.HasStats = chunk.HasStats;
+		if (chunk.HasStats) {
+			std::memcpy(&outStats.Min, &chunk.Min, sizeof(T));
+			std::memcpy(&outStats.Max, &chunk.Max, sizeof(T));
+		}
+	}
+
+	template<typename T, std::enable_if_t<!IsScalarColumn<T>, bool> Dummy = false>
+	inline void ReadBlockStats(const ColumnFileChunkInfo& chunk, ColumnBlockStats<T>& outStats) noexcept {
+		(void)chunk;
+		outStats.HasStats = false;
+	}
+
+	struct ColumnFileFieldInfo {
+		std::string Name;
+		ColumnTypeCode Code = ColumnTypeCode::eNONE;
+		ColumnTypeCode ElementCode = ColumnTypeCode::eNONE;
+	};
+
+	static constexpr std::size_t ColumnFileChunkInfoSize = sizeof(std::uint64_t) * 4 + 2;
+}//namespace INTERNAL
+
+
+	template<typename MessageType>
+	class ColumnFileReader final {
+	public:
+		using FieldTypes = typename MessageType::FieldTypes;
+		static constexpr std::size_t FieldCount = std::tuple_size<FieldTypes>::value;
+		template<std::size_t Idx>
+		using ColumnValueType = std::tuple_element_t<Idx, FieldTypes>;
+
+		ColumnFileReader() = default;
+		explicit ColumnFileReader(const char* fileName) { Open(fileName); }
+
+		//throws if the schema stored in the file does not match MessageType
+		bool Open(const char* fileName);
+
+		inline std::uint64_t GetRowCount() const noexcept { return m_rowCount; }
+		inline std::size_t GetBlockCount() const noexcept { return m_blockRowCounts.size(); }
+		inline std::size_t GetBlockRowCount(const std::size_t block) const noexcept { return m_blockRowCounts[block]; }
+
+		template<std::size_t Idx>
+		ColumnBlockStats<ColumnValueType<Idx>> GetBlockStats(const std::size_t block) const;
+
+		template<std::size_t Idx>
+		void ReadColumnBlock(const std::size_t block, MessageColumn<ColumnValueType<Idx>>& outColumn) const;
+		template<std::size_t Idx>
+		void ReadColumn(MessageColumn<ColumnValueType<Idx>>& outColumn) const;
+
+		//calls pred(const value&, row) for every row, blocks for which blockFilter(const ColumnBlockStats&) returns false are skipped
+		template<std::size_t Idx, typename PredType>
+		void ScanColumn(PredType&& pred) const;
+		template<std::size_t Idx, typename PredType, typename BlockFilterType>
+		void ScanColumn(PredType&& pred, BlockFilterType&& blockFilter) const;
+
+		//loads only the given columns, all other fields of the rows keep their default value
+		template<std::size_t... Indices>
+		void ReadColumns(MessageColumnStore<MessageType>& outStore) const;
+		void ReadAll(MessageColumnStore<MessageType>& outStore) const {
+			ReadAllHelper(outStore, std::make_index_sequence<FieldCount>{});
+		}
+
+	private:
+		template<std::size_t... Indices>
+		void ReadAllHelper(MessageColumnStore<MessageType>& outStore, std::index_sequence<Indices...>) const {
+			ReadColumns<Indices...>(outStore);
+		}
+
+		template<std::size_t... Indices>
+		bool VerifySchema(const std::vector<INTERNAL::ColumnFileFieldInfo>& fields, std::index_sequence<Indices...>) const;
+
+		inline const INTERNAL::ColumnFileChunkInfo& GetChunk(const std::size_t block, const std::size_t field) const noexcept {
+			return m_chunks[block * FieldCount + field];
+		}
+
+		file_utils::MappedFile m_file;
+		std::uint64_t m_rowCount = 0;
+		std::vector<std::uint32_t> m_blockRowCounts;
+		std::vector<std::uint64_t> m_blockFirstRows;
+		std::vector<INTERNAL::ColumnFileChunkInfo> m_chunks;
+	};
+
+
+namespace column_serilization {
+	template<typename MessageType>
+	bool Serialize(const char* fileName, const MessageColumnStore<MessageType>& store,
+		const ColumnFileOptions& options = ColumnFileOptions{});
+}//namespace column_serilization
+}//namespace messaging
+
+
+namespace messaging {
+namespace INTERNAL {
+	template<typename MessageType, std::size_t... Indices>
+	inline void WriteColumnFileBlock(const MessageColumnStore<MessageType>& store, const std::size_t firstRow, const std::size_t count,
+		const ColumnFileOptions& options, std::uint64_t fileOffset, std::vector<Byte>& outData,
+		std::vector<ColumnFileChunkInfo>& outChunks, std::index_sequence<Indices...>) {
+		const auto EncodeColumn = [&](const auto& column) {
+			using ValueType = typename RemoveCVREF<decltype(column)>::value_type;
+			static_assert(ColumnTypeTraits<ValueType>::Code != ColumnTypeCode::eNONE,
+				"column files support arithmetic, enum, std::string and std::vector<arithmetic> fields only!!!");
+			ColumnFileChunkInfo chunk;
+			const std::size_t Start = outData.size();
+			chunk.Offset = fileOffset + Start;
+			chunk.Encoding = EncodeColumnBlock(column.data() + firstRow, count, options.Compress, outData);
+			chunk.Size = outData.size() - Start;
+			ColumnBlockStats<ValueType> stats;
+			ComputeBlockStats(column.data() + firstRow, count, stats);
+			WriteBlockStats(stats, chunk);
+			outChunks.emplace_back(chunk);
+		};
+		(void)EncodeColumn;
+		(void)std::initializer_list<int>{(EncodeColumn(store.template GetColumn<Indices>()), 0)...};
+	}
+
+	template<typename FieldTypes, std::size_t... Indices>
+	inline void AppendColumnFileSchema(std::vector<Byte>& footer, const std::array<utils::ConstexprStringView, sizeof...(Indices) + 1>& names,
+		std::index_sequence<Indices...>) {
+		const auto AppendField = [&footer](const utils::ConstexprStringView& name, ColumnTypeCode code, ColumnTypeCode elementCode) {
+			AppendVarUInt(footer, name.size());
+			AppendBytes(footer, name.data(), name.size());
+			AppendPod(footer, code);
+			AppendPod(footer, elementCode);
+		};
+		(void)AppendField;
+		(void)std::initializer_list<int>{(AppendField(names[Indices],
+			ColumnTypeTraits<std::tuple_element_t<Indices, FieldTypes>>::Code,
+			ColumnTypeTraits<std::tuple_element_t<Indices, FieldTypes>>::ElementCode), 0)...};
+	}
+}//namespace INTERNAL
+}//namespace messaging
+
+
+template<typename MessageType>
+inline bool messaging::column_serilization::Serialize(const char* fileName, const MessageColumnStore<MessageType>& store,
+	const ColumnFileOptions& options) {
+	using FieldTypes = typename MessageType::FieldTypes;
+	constexpr std::size_t FieldCount = std::tuple_size<FieldTypes>::value;
+	const std::size_t RowsPerBlock = (std::max)(options.RowsPerBlock, std::size_t{ 1 });
+	FILE* file = ::fopen(fileName, "wb");
+	if (file == nullptr) {
+		return false;
+	}
+	//the header is written on its own, a store without rows still gives a readable file
+	std::vector<Byte> data;
+	INTERNAL::AppendPod(data, INTERNAL::ColumnFileMagic);
+	INTERNAL::AppendPod(data, INTERNAL::ColumnFileVersion);
+	bool success = ::fwrite(data.data(), data.size(), 1, file) == 1;
+	std::uint64_t fileOffset = data.size();
+	data.clear();
+	std::vector<std::uint32_t> blockRowCounts;
+	std::vector<INTERNAL::ColumnFileChunkInfo> chunks;
+	for (std::size_t firstRow = 0; firstRow < store.Size(); firstRow += RowsPerBlock) {
+		const std::size_t Count = (std::min)(RowsPerBlock, store.Size() - firstRow);
+		INTERNAL::WriteColumnFileBlock(store, firstRow, Count, options, fileOffset, data, chunks,
+			std::make_index_sequence<FieldCount>{});
+		blockRowCounts.emplace_back(static_cast<std::uint32_t>(Count));
+		success = success && ::fwrite(data.data(), data.size(), 1, file) == 1;
+		fileOffset += data.size();
+		data.clear();
+	}
+
+	std::vector<Byte> footer;
+	INTERNAL::AppendPod(footer, INTERNAL::ColumnFileMagic);
+	const std::size_t NameLen = sizeof(MessageType::MessageStringName) - 1;
+	INTERNAL::AppendVarUInt(footer, NameLen);
+	INTERNAL::AppendBytes(footer, MessageType::MessageStringName, NameLen);
+	INTERNAL::AppendPod(footer, static_cast<std::uint32_t>(FieldCount));
+	INTERNAL::AppendColumnFileSchema<FieldTypes>(footer, MessageType::FieldNameStrings, std::make_index_sequence<FieldCount>{});
+	INTERNAL::AppendPod(footer, static_cast<std::uint64_t>(store.Size()));
+	INTERNAL::AppendPod(footer, static_cast<std::uint32_t>(blockRowCounts.size()));
+	for (std::size_t block = 0; block < blockRowCounts.size(); ++block) {
+		INTERNAL::AppendPod(footer, blockRowCounts[block]);
+		for (std::size_t field = 0; field < FieldCount; ++field) {
+			const auto& chunk = chunks[block * FieldCount + field];
+			INTERNAL::AppendPod(footer, chunk.Offset);
+			INTERNAL::AppendPod(footer, chunk.Size);
+			INTERNAL::AppendPod(footer, chunk.Encoding);
+			INTERNAL::AppendPod(footer, static_cast<std::uint8_t>(chunk.HasStats));
+			INTERNAL::AppendPod(footer, chunk.Min);
+			INTERNAL::AppendPod(footer, chunk.Max);
+		}
+	}
+	INTERNAL::AppendPod(footer, fileOffset);
+	INTERNAL::AppendPod(footer, INTERNAL::ColumnFileMagic);
+	success = success && ::fwrite(footer.data(), footer.size(), 1, file) == 1;
+	success = ::fclose(file) == 0 && success;
+	return success;
+}
+
+
+template<typename MessageType>
+inline bool messaging::ColumnFileReader<MessageType>::Open(const char* fileName) {
+	m_rowCount = 0;
+	m_blockRowCounts.clear();
+	m_blockFirstRows.clear();
+	m_chunks.clear();
+	if (!m_file.Open(fileName, file_utils::MapAccessHint::eRANDOM)) {
+		return false;
+	}
+	const auto* pData = reinterpret_cast<const Byte*>(m_file.Data());
+	const std::size_t Size = m_file.Size();
+	if (Size < sizeof(std::uint32_t) * 2 + INTERNAL::ColumnFileTailSize ||
+		INTERNAL::ReadPod<std::uint32_t>(pData) != INTERNAL::ColumnFileMagic ||
+		INTERNAL::ReadPod<std::uint32_t>(pData + sizeof(std::uint32_t)) != INTERNAL::ColumnFileVersion ||
+		INTERNAL::ReadPod<std::uint32_t>(pData + Size - sizeof(std::uint32_t)) != INTERNAL::ColumnFileMagic) {
+		throw std::runtime_error{ std::string{ "invalid column file " } + fileName };
+	}
+	const std::uint64_t FooterOffset = INTERNAL::ReadPod<std::uint64_t>(pData + Size - INTERNAL::ColumnFileTailSize);
+	if (FooterOffset > Size - INTERNAL::ColumnFileTailSize) {
+		throw std::runtime_error{ std::string{ "invalid column file footer " } + fileName };
+	}
+	const Byte* pCur = pData + FooterOffset;
+	const Byte* const pEnd = pData + Size - INTERNAL::ColumnFileTailSize;
+	const auto ReadValue = [&pCur, pEnd](auto& value) { INTERNAL::ReadBytes(pCur, pEnd, &value, sizeof(value)); };
+
+	std::uint32_t magic = 0;
+	ReadValue(magic);
+	std::string messageName(static_cast<std::size_t>(INTERNAL::ReadVarUInt(pCur, pEnd)), '\0');
+	INTERNAL::ReadBytes(pCur, pEnd, &messageName[0], messageName.size());
+	std::uint32_t fieldCount = 0;
+	ReadValue(fieldCount);
+	if (magic != INTERNAL::ColumnFileMagic || messageName != MessageType::MessageStringName || fieldCount != FieldCount) {
+		throw std::runtime_error{ std::string{ "column file " } + fileName + " does not contain " + MessageType::MessageStringName };
+	}
+	std::vector<INTERNAL::ColumnFileFieldInfo> fields(fieldCount);
+	for (auto& field : fields) {
+		field.Name.resize(static_cast<std::size_t>(INTERNAL::ReadVarUInt(pCur, pEnd)));
+		INTERNAL::ReadBytes(pCur, pEnd, &field.Name[0], field.Name.size());
+		ReadValue(field.Code);
+		ReadValue(field.ElementCode);
+	}
+	if (!VerifySchema(fields, std::make_index_sequence<FieldCount>{})) {
+		throw std::runtime_error{ std::string{ "schema of column file " } + fileName + " does not match " + MessageType::MessageStringName };
+	}
+	std::uint32_t blockCount = 0;
+	ReadValue(m_rowCount);
+	ReadValue(blockCount);
+	if (static_cast<std::size_t>(pEnd - pCur) / (sizeof(std::uint32_t) + FieldCount * INTERNAL::ColumnFileChunkInfoSize) < blockCount) {
+		throw std::runtime_error{ std::string{ "invalid column file footer " } + fileName };
+	}
+	m_blockRowCounts.resize(blockCount);
+	m_blockFirstRows.resize(blockCount);
+	m_chunks.resize(static_cast<std::size_t>(blockCount) * FieldCount);
+	std::uint64_t firstRow = 0;
+	for (std::uint32_t block = 0; block < blockCount; ++block) {
+		ReadValue(m_blockRowCounts[block]);
+		m_blockFirstRows[block] = firstRow;
+		firstRow += m_blockRowCounts[block];
+		for (std::size_t field = 0; field < FieldCount; ++field) {
+			auto& chunk = m_chunks[block * FieldCount + field];
+			std::uint8_t hasStats = 0;
+			ReadValue(chunk.Offset);
+			ReadValue(chunk.Size);
+			ReadValue(chunk.Encoding);
+			ReadValue(hasStats);
+			ReadValue(chunk.Min);
+			ReadValue(chunk.Max);
+			chunk.HasStats = hasStats != 0;
+			if (chunk.Offset > FooterOffset || chunk.Size > FooterOffset - chunk.Offset) {
+				throw std::runtime_error{ std::string{ "invalid column block in " } + fileName };
+			}
+		}
+	}
+	if (firstRow != m_rowCount) {
+		throw std::runtime_error{ std::string{ "row count mismatch in column file " } + fileName };
+	}
+	return true;
+}
+
+
+template<typename MessageType>
+template<std::size_t... Indices>
+inline bool messaging::ColumnFileReader<MessageType>::VerifySchema(const std::vector<INTERNAL::ColumnFileFieldInfo>& fields,
+	std::index_sequence<Indices...>) const {
+	const bool Matches[] = { true, (fields[Indices].Name == MessageType::FieldNameStrings[Indices].ToStdString() &&
+		fields[Indices].Code == INTERNAL::ColumnTypeTraits<ColumnValueType<Indices>>::Code &&
+		fields[Indices].ElementCode == INTERNAL::ColumnTypeTraits<ColumnValueType<Indices>>::ElementCode)... };
+	return std::all_of(std::begin(Matches), std::end(Matches), [](const bool match) { return match; });
+}
+
+
+template<typename MessageType>
+template<std::size_t Idx>
+inline messaging::ColumnBlockStats<typename messaging::ColumnFileReader<MessageType>::template ColumnValueType<Idx>>
+messaging::ColumnFileReader<MessageType>::GetBlockStats(const std::size_t block) const {
+	ColumnBlockStats<ColumnValueType<Idx>> stats;
+	INTERNAL::ReadBlockStats(GetChunk(block, Idx), stats);
+	return stats;
+}
+
+
+template<typename MessageType>
+template<std::size_t Idx>
+inline void messaging::ColumnFileReader<MessageType>::ReadColumnBlock(const std::size_t block,
+	MessageColumn<ColumnValueType<Idx>>& outColumn) const {
+	const auto& chunk = GetChunk(block, Idx);
+	const auto* pBegin = reinterpret_cast<const Byte*>(m_file.Data()) + chunk.Offset;
+	outColumn.Resize(m_blockRowCounts[block]);
+	INTERNAL::DecodeColumnBlock(chunk.Encoding, pBegin, pBegin + chunk.Size, outColumn.data(), outColumn.size());
+}
+
+
+template<typename MessageType>
+template<std::size_t Idx>
+inline void messaging::ColumnFileReader<MessageType>::ReadColumn(MessageColumn<ColumnValueType<Idx>>& outColumn) const {
+	outColumn.Resize(static_cast<std::size_t>(m_rowCount));
+	for (std::size_t block = 0; block < m_blockRowCounts.size(); ++block) {
+		const auto& chunk = GetChunk(block, Idx);
+		const auto* pBegin = reinterpret_cast<const Byte*>(m_file.Data()) + chunk.Offset;
+		INTERNAL::DecodeColumnBlock(chunk.Encoding, pBegin, pBegin + chunk.Size,
+			outColumn.data() + m_blockFirstRows[block], m_blockRowCounts[block]);
+	}
+}
+
+
+template<typename MessageType>
+template<std::size_t Idx, typename PredType>
+inline void messaging::ColumnFileReader<MessageType>::ScanColumn(PredType&& pred) const {
+	ScanColumn<Idx>(std::forward<PredType>(pred), [](const auto& stats) { (void)stats; return true; });
+}
+
+
+template<typename MessageType>
+template<std::size_t Idx, typename PredType, typename BlockFilterType>
+inline void messaging::ColumnFileReader<MessageType>::ScanColumn(PredType&& pred, BlockFilterType&& blockFilter) const {
+	MessageColumn<ColumnValueType<Idx>> column;
+	for (std::size_t block = 0; block < m_blockRowCounts.size(); ++block) {
+		const auto Stats = GetBlockStats<Idx>(block);
+		if (Stats.HasStats && !blockFilter(Stats)) {
+			continue;
+		}
+		ReadColumnBlock<Idx>(block, column);
+		const std::uint64_t FirstRow = m_blockFirstRows[block];
+		for (std::size_t i = 0; i < column.size(); ++i) {
+			pred(static_cast<const ColumnValueType<Idx>&>(column[i]), FirstRow + i);
+		}
+	}
+}
+
+
+template<typename MessageType>
+template<std::size_t... Indices>
+inline void messaging::ColumnFileReader<MessageType>::ReadColumns(MessageColumnStore<MessageType>& outStore) const {
+	outStore.Resize(static_cast<std::size_t>(m_rowCount));
+	(void)std::initializer_list<int>{(ReadColumn<Indices>(outStore.template GetColumn<Indices>()), 0)...};
+}
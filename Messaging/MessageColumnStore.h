@@ -0,0 +1,336 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <initializer_list>
+#include "Message.h"
+
+namespace messaging {
+
+	//contiguous storage for one field of many messages, unlike std::vector<bool> a bool column is a real bool array
+	template<typename T>
+	class MessageColumn final {
+	public:
+		using value_type = T;
+
+		MessageColumn() = default;
+		MessageColumn(const MessageColumn& other) { *this = other; }
+		MessageColumn(MessageColumn&& other) noexcept { Swap(other); }
+		MessageColumn& operator=(const MessageColumn& other);
+		MessageColumn& operator=(MessageColumn&& other) noexcept {
+			MessageColumn tmp{ std::move(other) };
+			Swap(tmp);
+			return *this;
+		}
+
+		inline std::size_t size() const noexcept { return m_size; }
+		inline std::size_t capacity() const noexcept { return m_capacity; }
+		inline bool empty() const noexcept { return m_size == 0; }
+		inline T* data() noexcept { return m_data.get(); }
+		inline const T* data() const noexcept { return m_data.get(); }
+		inline T* begin() noexcept { return m_data.get(); }
+		inline T* end() noexcept { return m_data.get() + m_size; }
+		inline const T* begin() const noexcept { return m_data.get(); }
+		inline const T* end() const noexcept { return m_data.get() + m_size; }
+		inline T& operator[](const std::size_t Idx) noexcept { return m_data[Idx]; }
+		inline const T& operator[](const std::size_t Idx) const noexcept { return m_data[Idx]; }
+
+		void Reserve(const std::size_t capacity) {
+			if (capacity > m_capacity) {
+				Reallocate(capacity);
+			}
+		}
+
+		void Resize(const std::size_t size) {
+			if (size > m_capacity) {
+				Reallocate((std::max)(size, m_capacity * 2));
+			}
+			for (std::size_t i = size; i < m_size; ++i) {
+				m_data[i] = T{};
+			}
+			m_size = size;
+		}
+
+		template<typename ValueType>
+		void PushBack(ValueType&& value) {
+			if (m_size == m_capacity) {
+				Reallocate((std::max)(m_capacity * 2, std::size_t{ 16 }));
+			}
+			m_data[m_size++] = std::forward<ValueType>(value);
+		}
+
+		void Clear() { Resize(0); }
+
+	private:
+		void Reallocate(const std::size_t capacity) {
+			//value initialized, Resize hands out the rows past m_size as default rows
+			std::unique_ptr<T[]> newData{ new T[capacity]() };
+			std::move(begin(), end(), newData.get());
+			m_data = std::move(newData);
+			m_capacity = capacity;
+		}
+
+		void Swap(MessageColumn& other) noexcept {
+			std::swap(m_data, other.m_data);
+			std::swap(m_size, other.m_size);
+			std::swap(m_capacity, other.m_capacity);
+		}
+
+		std::unique_ptr<T[]> m_data;
+		std::size_t m_size = 0;
+		std::size_t m_capacity = 0;
+	};
+
+
+	//struct of arrays container for one DECLMESSAGE type, every field lives in its own contiguous column.
+	//rows are accessed through MessageType::RowView which offers the same GetXxx/SetXxx as the message
+	template<typename MessageType>
+	class MessageColumnStore final {
+	public:
+		using FieldTypes = typename MessageType::FieldTypes;
+		using RowType = typename MessageType::template RowView<MessageColumnStore>;
+		using ConstRowType = typename MessageType::template RowView<const MessageColumnStore>;
+		static constexpr std::size_t FieldCount = std::tuple_size<FieldTypes>::value;
+
+		template<std::size_t Idx>
+		using ColumnValueType = std::tuple_element_t<Idx, FieldTypes>;
+		template<std::size_t Idx>
+		using ColumnType = MessageColumn<ColumnValueType<Idx>>;
+
+		inline std::size_t Size() const noexcept { return m_size; }
+		inline bool IsEmpty() const noexcept { return m_size == 0; }
+
+		void Reserve(const std::size_t capacity);
+		void Resize(const std::size_t size);
+		void Clear() { Resize(0); }
+
+		void PushBack(const MessageType& msg);
+		void PushBack(MessageType&& msg);
+		RowType AddRow();
+
+		inline RowType operator[](const std::size_t row) noexcept { return RowType{ *this, row }; }
+		inline ConstRowType operator[](const std::size_t row) const noexcept { return ConstRowType{ *this, row }; }
+
+		MessageType GetMessage(const std::size_t row) const;
+
+		template<std::size_t Idx>
+		inline ColumnType<Idx>& GetColumn() noexcept { return std::get<Idx>(m_columns); }
+		template<std::size_t Idx>
+		inline const ColumnType<Idx>& GetColumn() const noexcept { return std::get<Idx>(m_columns); }
+
+		//pred(const value&) is called for every value of the column in row order
+		template<std::size_t Idx, typename PredType>
+		void ScanColumn(PredType&& pred) const;
+
+		//returns the rows whose value in column Idx satisfies pred, can be passed to the next Filter as selection
+		template<std::size_t Idx, typename PredType>
+		std::vector<std::size_t> Filter(PredType&& pred) const;
+		template<std::size_t Idx, typename PredType>
+		std::vector<std::size_t> Filter(PredType&& pred, const std::vector<std::size_t>& selection) const;
+
+		template<std::size_t Idx, typename PredType>
+		std::size_t CountIf(PredType&& pred) const;
+
+		template<std::size_t Idx, typename ResultType = ColumnValueType<Idx>>
+		ResultType Sum() const;
+		template<std::size_t Idx>
+		ColumnValueType<Idx> Min() const;
+		template<std::size_t Idx>
+		ColumnValueType<Idx> Max() const;
+
+	private:
+		template<typename PredType, std::size_t... Indices>
+		void ForEachColumnDo(PredType&& pred, std::index_sequence<Indices...>);
+
+		template<typename MsgType, std::size_t... Indices>
+		void PushBackFields(MsgType&& msg, std::index_sequence<Indices...>);
+
+		template<std::size_t... Indices>
+		void GetMessageFields(MessageType& msg, const std::size_t row, std::index_sequence<Indices...>) const;
+
+		using ColumnTupleType = typename INTERNAL::DoTraitOnEachTupleMember<MessageColumn, FieldTypes>::Type;
+
+		ColumnTupleType m_columns;
+		std::size_t m_size = 0;
+	};
+}
+
+
+template<typename T>
+inline messaging::MessageColumn<T>& messaging::MessageColumn<T>::operator=(const MessageColumn& other) {
+	if (this != &other) {
+		if (m_capacity < other.m_size) {
+			m_data.reset(new T[other.m_size]());
+			m_capacity = other.m_size;
+		}
+		std::copy(other.begin(), other.end(), m_data.get());
+		for (std::size_t i = other.m_size; i < m_size; ++i) {
+			m_data[i] = T{};
+		}
+		m_size = other.m_size;
+	}
+	return *this;
+}
+
+
+template<typename MessageType>
+inline void messaging::MessageColumnStore<MessageType>::Reserve(const std::size_t capacity) {
+	ForEachColumnDo([capacity](auto& column) { column.Reserve(capacity); }, std::make_index_sequence<FieldCount>{});
+}
+
+
+template<typename MessageType>
+inline void messaging::MessageColumnStore<MessageType>::Resize(const std::size_t size) {
+	ForEachColumnDo([size](auto& column) { column.Resize(size); }, std::make_index_sequence<FieldCount>{});
+	m_size = size;
+}
+
+
+template<typename MessageType>
+inline void messaging::MessageColumnStore<MessageType>::PushBack(const MessageType& msg) {
+	PushBackFields(msg, std::make_index_sequence<FieldCount>{});
+	++m_size;
+}
+
+
+template<typename MessageType>
+inline void messaging::MessageColumnStore<MessageType>::PushBack(MessageType&& msg) {
+	PushBackFields(std::move(msg), std::make_index_sequence<FieldCount>{});
+	++m_size;
+}
+
+
+template<typename MessageType>
+inline typename messaging::MessageColumnStore<MessageType>::RowType messaging::MessageColumnStore<MessageType>::AddRow() {
+	Resize(m_size + 1);
+	return RowType{ *this, m_size - 1 };
+}
+
+
+template<typename MessageType>
+inline MessageType messaging::MessageColumnStore<MessageType>::GetMessage(const std::size_t row) const {
+	MessageType msg;
+	GetMessageFields(msg, row, std::make_index_sequence<FieldCount>{});
+	return msg;
+}
+
+
+template<typename MessageType>
+template<std::size_t Idx, typename PredType>
+inline void messaging::MessageColumnStore<MessageType>::ScanColumn(PredType&& pred) const {
+	const auto* pData = GetColumn<Idx>().data();
+	for (std::size_t i = 0; i < m_size; ++i) {
+		pred(pData[i]);
+	}
+}
+
+
+template<typename MessageType>
+template<std::size_t Idx, typename PredType>
+inline std::vector<std::size_t> messaging::MessageColumnStore<MessageType>::Filter(PredType&& pred) const {
+	std::vector<std::size_t> result;
+	const auto* pData = GetColumn<Idx>().data();
+	for (std::size_t i = 0; i < m_size; ++i) {
+		if (pred(pData[i])) {
+			result.emplace_back(i);
+		}
+	}
+	return result;
+}
+
+
+template<typename MessageType>
+template<std::size_t Idx, typename PredType>
+inline std::vector<std::size_t> messaging::MessageColumnStore<MessageType>::Filter(PredType&& pred,
+	const std::vector<std::size_t>& selection) const {
+	std::vector<std::size_t> result;
+	const auto* pData = GetColumn<Idx>().data();
+	for (const auto row : selection) {
+		if (pred(pData[row])) {
+			result.emplace_back(row);
+		}
+	}
+	return result;
+}
+
+
+template<typename MessageType>
+template<std::size_t Idx, typename PredType>
+inline std::size_t messaging::MessageColumnStore<MessageType>::CountIf(PredType&& pred) const {
+	std::size_t count = 0;
+	const auto* pData = GetColumn<Idx>().data();
+	for (std::size_t i = 0; i < m_size; ++i) {
+		count += pred(pData[i]) ? 1 : 0;
+	}
+	return count;
+}
+
+
+template<typename MessageType>
+template<std::size_t Idx, typename ResultType>
+inline ResultType messaging::MessageColumnStore<MessageType>::Sum() const {
+	ResultType result{};
+	const auto* pData = GetColumn<Idx>().data();
+	for (std::size_t i = 0; i < m_size; ++i) {
+		result += pData[i];
+	}
+	return result;
+}
+
+
+template<typename MessageType>
+template<std::size_t Idx>
+inline typename messaging::MessageColumnStore<MessageType>::template ColumnValueType<Idx>
+messaging::MessageColumnStore<MessageType>::Min() const {
+	if (m_size == 0) {
+		throw std::runtime_error{ "Min of an empty column!!!" };
+	}
+	const auto& column = GetColumn<Idx>();
+	return *std::min_element(column.begin(), column.end());
+}
+
+
+template<typename MessageType>
+template<std::size_t Idx>
+inline typename messaging::MessageColumnStore<MessageType>::template ColumnValueType<Idx>
+messaging::MessageColumnStore<MessageType>::Max() const {
+	if (m_size == 0) {
+		throw std::runtime_error{ "Max of an empty column!!!" };
+	}
+	const auto& column = GetColumn<Idx>();
+	return *std::max_element(column.begin(), column.end());
+}
+
+
+template<typename MessageType>
+template<typename PredType, std::size_t... Indices>
+inline void messaging::MessageColumnStore<MessageType>::ForEachColumnDo(PredType&& pred, std::index_sequence<Indices...>) {
+	(void)std::initializer_list<int>{(pred(std::get<Indices>(m_columns)), 0)...};
+}
+
+
+template<typename MessageType>
+template<typename MsgType, std::size_t... Indices>
+inline void messaging::MessageColumnStore<MessageType>::PushBackFields(MsgType&& msg, std::index_sequence<Indices...>) {
+	//fields of an rvalue message are moved into the columns
+	try {
+		(void)std::initializer_list<int>{(std::get<Indices>(m_columns).PushBack(
+			static_cast<std::conditional_t<std::is_lvalue_reference<MsgType>::value,
+				const ColumnValueType<Indices>&, ColumnValueType<Indices>&&>>(msg.template GetOne<Indices>())), 0)...};
+	} catch (...) {
+		//the columns which already got their field are cut back, every column keeps m_size rows
+		ForEachColumnDo([this](auto& column) { column.Resize(m_size); }, std::make_index_sequence<FieldCount>{});
+		throw;
+	}
+}
+
+
+template<typename MessageType>
+template<std::size_t... Indices>
+inline void messaging::MessageColumnStore<MessageType>::GetMessageFields(MessageType& msg, const std::size_t row,
+	std::index_sequence<Indices...>) const {
+	(void)std::initializer_list<int>{(msg.template SetOne<Indices>(std::get<Indices>(m_columns)[row]), 0)...};
+}
@@ -0,0 +1,652 @@
+#pragma once
+#if defined(__has_include)
+	#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+		#include <coroutine>
+		#define MESSAGING_HAS_COROUTINES 1
+	#endif
+#endif
+#ifndef MESSAGING_HAS_COROUTINES
+	#define MESSAGING_HAS_COROUTINES 0
+#endif
+#if MESSAGING_HAS_COROUTINES && defined(__linux__)
+#include <new>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <functional>
+#include <unordered_map>
+#include "MessageTcpTransport.h"
+
+//C++20 coroutines on top of TcpEventLoop, only there if the compiler supports coroutines (Linux only).
+//
+//CoroutineExecutor runs one TcpEventLoop per thread, every connection belongs to one of them and its MessageTask
+//is only ever resumed on that thread, so tasks need no locking. Received frames wait in a ring per connection
+//until the task takes them with co_await channel.Receive<MessageType>(), co_await channel.Send(msg) only suspends
+//while more than SendHighWaterMark bytes of the connection wait for the socket.
+//Coroutine frames come from free lists per thread and the awaiters live inside the frame,
+//so receiving and sending allocate nothing but what the message fields need.
+namespace messaging {
+	class MessageChannel;
+	class CoroutineExecutor;
+
+namespace INTERNAL {
+	class CoroutineWorker;
+
+	//like MessagePool, but by size class since the size of a coroutine frame is only known at runtime
+	class CoroutineFramePool final {
+	public:
+		static constexpr std::size_t Granularity = 64;
+		static constexpr std::size_t ClassCount = 32;
+		static constexpr std::size_t MaxFreeCount = 1024;
+
+		CoroutineFramePool() = delete;
+
+		static void* Allocate(const std::size_t size) {
+			const std::size_t Class = GetClass(size);
+			if (Class >= ClassCount) {
+				return ::operator new(size);
+			}
+			FreeList& freeList = GetFreeLists().lists[Class];
+			if (freeList.pHead == nullptr) {
+				return ::operator new((Class + 1) * Granularity);
+			}
+			FreeNode* pNode = freeList.pHead;
+			freeList.pHead = pNode->pNext;
+			--freeList.count;
+			return pNode;
+		}
+
+		static void Deallocate(void* pData, const std::size_t size) noexcept {
+			const std::size_t Class = GetClass(size);
+			if (Class >= ClassCount || GetFreeLists().lists[Class].count >= MaxFreeCount) {
+				::operator delete(pData);
+				return;
+			}
+			FreeList& freeList = GetFreeLists().lists[Class];
+			freeList.pHead = ::new(pData) FreeNode{ freeList.pHead };
+			++freeList.count;
+		}
+
+	private:
+		struct FreeNode {
+			FreeNode* pNext;
+		};
+
+		struct FreeList {
+			FreeNode* pHead = nullptr;
+			std::size_t count = 0;
+		};
+
+		struct FreeLists {
+			std::array<FreeList, ClassCount> lists;
+
+			~FreeLists() {
+				for (FreeList& freeList : lists) {
+					while (freeList.pHead != nullptr) {
+						FreeNode* pNext = freeList.pHead->pNext;
+						::operator delete(freeList.pHead);
+						freeList.pHead = pNext;
+					}
+					//frames destroyed after this point during thread exit go straight to operator delete
+					freeList.count = MaxFreeCount;
+				}
+			}
+		};
+
+		static std::size_t GetClass(const std::size_t size) noexcept { return size == 0 ? 0 : (size - 1) / Granularity; }
+
+		static FreeLists& GetFreeLists() noexcept {
+			thread_local FreeLists freeLists;
+			return freeLists;
+		}
+	};
+}//namespace INTERNAL
+
+	//return type of the connection handlers of CoroutineExecutor, the task starts once the executor gave it its channel.
+	//When the task returns the connection is closed, an exception leaving it goes to the error handler of the executor
+	class MessageTask final {
+	public:
+		class promise_type final {
+		public:
+			MessageTask get_return_object() noexcept { return MessageTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+			std::suspend_always initial_suspend() const noexcept { return {}; }
+			auto final_suspend() const noexcept { return FinalAwaiter{}; }
+			void return_void() const noexcept {}
+			void unhandled_exception() noexcept { m_exception = std::current_exception(); }
+
+			static void* operator new(const std::size_t size) { return INTERNAL::CoroutineFramePool::Allocate(size); }
+			static void operator delete(void* pFrame, const std::size_t size) noexcept { INTERNAL::CoroutineFramePool::Deallocate(pFrame, size); }
+
+		private:
+			friend INTERNAL::CoroutineWorker;
+
+			//tells the worker the task is done and frees the frame
+			struct FinalAwaiter {
+				bool await_ready() const noexcept { return false; }
+				void await_suspend(const std::coroutine_handle<promise_type> handle) const noexcept {
+					handle.promise().NotifyDone();
+					handle.destroy();
+				}
+				void await_resume() const noexcept {}
+			};
+
+			void NotifyDone() noexcept;
+
+			MessageChannel* m_pChannel = nullptr;
+			std::exception_ptr m_exception;
+		};
+
+		MessageTask(MessageTask&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+		MessageTask& operator=(MessageTask&&) = delete;
+		~MessageTask() noexcept {
+			if (m_handle) {
+				m_handle.destroy();
+			}
+		}
+
+	private:
+		friend INTERNAL::CoroutineWorker;
+
+		explicit MessageTask(const std::coroutine_handle<promise_type> handle) noexcept : m_handle(handle) {}
+
+		std::coroutine_handle<promise_type> m_handle;
+	};
+
+
+	//the connection of one MessageTask, only to be used from within that task
+	class MessageChannel final {
+	public:
+		using FrameSizeType = TcpConnection::FrameSizeType;
+
+		static constexpr std::size_t SendHighWaterMark = 256 * 1024;
+
+		MessageChannel(const MessageChannel&) = delete;
+		MessageChannel& operator=(const MessageChannel&) = delete;
+
+		class ReceiveAwaiterBase {
+		public:
+			bool await_ready() const noexcept { return m_channel.IsReceiveReady(); }
+			void await_suspend(const std::coroutine_handle<> handle) noexcept { m_channel.m_receiver = handle; }
+
+		protected:
+			explicit ReceiveAwaiterBase(MessageChannel& channel) noexcept : m_channel(channel) {}
+
+			MessageChannel& m_channel;
+		};
+
+		template<typename MessageType>
+		class ReceiveAwaiter final : public ReceiveAwaiterBase {
+		public:
+			explicit ReceiveAwaiter(MessageChannel& channel) noexcept : ReceiveAwaiterBase(channel) {}
+
+			std::optional<MessageType> await_resume() {
+				std::optional<MessageType> msg(std::in_place);
+				if (!m_channel.PopFrame(*msg)) {
+					msg.reset();
+				}
+				return msg;
+			}
+		};
+
+		template<typename MessageType>
+		class ReceiveIntoAwaiter final : public ReceiveAwaiterBase {
+		public:
+			ReceiveIntoAwaiter(MessageChannel& channel, MessageType& msg) noexcept : ReceiveAwaiterBase(channel), m_msg(msg) {}
+
+			bool await_resume() { return m_channel.PopFrame(m_msg); }
+
+		private:
+			MessageType& m_msg;
+		};
+
+		class SendAwaiter final {
+		public:
+			SendAwaiter(MessageChannel& channel, const bool isSent, const bool isBlocked) noexcept
+				: m_channel(channel), m_isSent(isSent), m_isBlocked(isBlocked) {}
+
+			bool await_ready() const noexcept { return !m_isBlocked; }
+			void await_suspend(const std::coroutine_handle<> handle);
+			bool await_resume() const noexcept { return m_isSent; }
+
+		private:
+			MessageChannel& m_channel;
+			bool m_isSent;
+			bool m_isBlocked;
+		};
+
+		//co_await gives std::optional<MessageType>, empty once the connection closed and every received frame was taken.
+		//A frame which doesn't hold a MessageType throws std::runtime_error
+		template<typename MessageType>
+		ReceiveAwaiter<MessageType> Receive() noexcept { return ReceiveAwaiter<MessageType>(*this); }
+
+		//deserializes into msg so its strings and vectors keep their capacity, co_await gives false once the connection closed
+		template<typename MessageType>
+		ReceiveIntoAwaiter<MessageType> Receive(MessageType& msg) noexcept { return ReceiveIntoAwaiter<MessageType>(*this, msg); }
+
+		//msg is serialized right away, co_await gives false if the connection is closed
+		template<typename MessageType>
+		SendAwaiter Send(const MessageType& msg) {
+			if (!IsOpen()) {
+				return SendAwaiter(*this, false, false);
+			}
+			TransmitMessage(*m_pConnection, msg);
+			return SendAwaiter(*this, true, IsSendBlocked());
+		}
+
+		void Close();
+		bool IsOpen() const noexcept { return m_pConnection != nullptr && m_pConnection->IsOpen(); }
+		//nullptr once the connection is gone
+		TcpConnection* GetConnection() const noexcept { return m_pConnection; }
+
+	private:
+		friend INTERNAL::CoroutineWorker;
+		friend MessageTask::promise_type;
+
+		MessageChannel(INTERNAL::CoroutineWorker& worker, TcpConnection& connection) noexcept : m_worker(worker), m_pConnection(&connection) {}
+
+		bool IsReceiveReady() const noexcept { return !m_inbox.empty() || m_pConnection == nullptr; }
+		//a blocked sender goes on once half of the high water mark is written
+		bool IsSendBlocked(const std::size_t limit = SendHighWaterMark) const noexcept {
+			return m_pConnection != nullptr && m_pConnection->IsOpen() && m_pConnection->GetPendingBytes() > limit;
+		}
+
+		static std::size_t PadFrameSize(const std::size_t size) noexcept {
+			return (size + sizeof(FrameSizeType) - 1) / sizeof(FrameSizeType) * sizeof(FrameSizeType);
+		}
+
+		//frames are stored as size, payload and padding so every payload starts aligned
+		void PushFrame(const ByteSpan frame) {
+			static constexpr Byte Padding[sizeof(FrameSizeType)] = {};
+			const auto Size = static_cast<FrameSizeType>(frame.size());
+			m_inbox.Reserve(sizeof(FrameSizeType) + PadFrameSize(frame.size()));
+			m_inbox.Append(reinterpret_cast<const Byte*>(&Size), sizeof(FrameSizeType));
+			m_inbox.Append(frame.data(), frame.size());
+			m_inbox.Append(Padding, PadFrameSize(frame.size()) - frame.size());
+		}
+
+		template<typename MessageType>
+		bool PopFrame(MessageType& msg) {
+			if (m_inbox.empty()) {
+				return false;
+			}
+			FrameSizeType size = 0;
+			m_inbox.Peek(reinterpret_cast<Byte*>(&size), 0, sizeof(FrameSizeType));
+			const Byte* pFrame = m_inbox.GetContiguous(sizeof(FrameSizeType), size);
+			if (pFrame == nullptr) {
+				m_wrappedFrame.resize(size);
+				m_inbox.Peek(m_wrappedFrame.data(), sizeof(FrameSizeType), size);
+				pFrame = m_wrappedFrame.data();
+			}
+			const bool IsDeserialized = DeserializeFrame(msg, ByteSpan(pFrame, size));
+			m_inbox.Consume(sizeof(FrameSizeType) + PadFrameSize(size));
+			if (!IsDeserialized) {
+				throw std::runtime_error("the received frame doesn't hold the awaited message!!!");
+			}
+			return true;
+		}
+
+		INTERNAL::CoroutineWorker& m_worker;
+		TcpConnection* m_pConnection;
+		ByteRingBuffer m_inbox;
+		std::vector<Byte> m_wrappedFrame;
+		std::coroutine_handle<> m_receiver;
+		std::coroutine_handle<> m_sender;
+		std::exception_ptr m_exception;
+		bool m_isReady = false;
+		bool m_isTaskDone = false;
+		bool m_isReleased = false;
+	};
+
+
+namespace INTERNAL {
+	//one thread with its own TcpEventLoop and the channels of its connections
+	class CoroutineWorker final {
+	public:
+		using TaskFactory = std::function<MessageTask(MessageChannel&)>;
+		using ErrorHandler = std::function<void(std::exception_ptr)>;
+
+		explicit CoroutineWorker(const TcpBackend backend) : m_loop(TcpEventLoop::DefaultMaxFrameSize, backend) {
+			m_loop.SetFrameHandler([this](TcpConnection& connection, const ByteSpan frame) { OnFrame(connection, frame); });
+			m_loop.SetConnectHandler([this](TcpConnection& connection) { OnConnect(connection); });
+			m_loop.SetDisconnectHandler([this](TcpConnection& connection) { OnDisconnect(connection); });
+			m_thread = std::thread([this] { Run(); });
+		}
+
+		~CoroutineWorker() noexcept { Stop(); }
+
+		CoroutineWorker(const CoroutineWorker&) = delete;
+		CoroutineWorker& operator=(const CoroutineWorker&) = delete;
+
+		//runs func on the thread of the worker, the future has its result or exception
+		template<typename FuncType>
+		auto Post(FuncType&& func) -> std::future<decltype(func())> {
+			using ResultType = decltype(func());
+			auto pTask = std::make_shared<std::packaged_task<ResultType()>>(std::forward<FuncType>(func));
+			std::future<ResultType> future = pTask->get_future();
+			{
+				std::lock_guard<std::mutex> lock(m_postMutex);
+				m_posted.emplace_back([pTask] { (*pTask)(); });
+			}
+			m_loop.Wake();
+			return future;
+		}
+
+		void Stop() noexcept {
+			if (m_thread.joinable()) {
+				m_isStopping.store(true, std::memory_order_release);
+				m_loop.Wake();
+				m_thread.join();
+			}
+		}
+
+		//the following ones only on the thread of the worker
+		TcpEventLoop& GetLoop() noexcept { return m_loop; }
+		void SetListenHandler(TaskFactory handler) { m_listenHandler = std::move(handler); }
+		void SetErrorHandler(ErrorHandler handler) { m_errorHandler = std::move(handler); }
+		void StartTask(TcpConnection& connection, const TaskFactory& factory);
+		//an outgoing connection with its own task, the listen handler is never started for it
+		void Connect(const char* address, const std::uint16_t port, const TaskFactory& factory);
+
+		void AddBlockedSender(MessageChannel& channel) { m_blockedSenders.push_back(&channel); }
+		//the loop destroys closed connections at the end of a Poll, the wake keeps Run from waiting in Poll(-1) first
+		void CloseConnection(TcpConnection& connection) {
+			m_loop.Close(connection);
+			m_loop.Wake();
+		}
+		void OnTaskDone(MessageChannel& channel, std::exception_ptr exception) noexcept {
+			channel.m_isTaskDone = true;
+			channel.m_exception = std::move(exception);
+			m_finished.push_back(&channel);
+		}
+
+	private:
+		void Run() {
+			while (!m_isStopping.load(std::memory_order_acquire)) {
+				try {
+					m_loop.Poll(-1);
+					RunPosted();
+					ResumeBlockedSenders();
+					ResumeReceivers();
+					ReleaseFinished();
+				} catch (...) {
+					ReportError(std::current_exception());
+				}
+			}
+			DestroyTasks();
+		}
+
+		void RunPosted() {
+			{
+				std::lock_guard<std::mutex> lock(m_postMutex);
+				m_running.swap(m_posted);
+			}
+			for (auto& func : m_running) {
+				func();
+			}
+			m_running.clear();
+		}
+
+		void OnFrame(TcpConnection& connection, const ByteSpan frame) {
+			const auto It = m_channels.find(&connection);
+			if (It == m_channels.end() || It->second->m_isTaskDone) {
+				return;
+			}
+			MessageChannel& channel = *It->second;
+			channel.PushFrame(frame);
+			MarkReady(channel);
+		}
+
+		//accepted connections start the listen handler, outgoing ones already have their task.
+		//A connect which completes right away calls this from inside TcpEventLoop::Connect, before StartTask
+		void OnConnect(TcpConnection& connection) {
+			if (m_listenHandler && !m_isConnecting && m_channels.find(&connection) == m_channels.end()) {
+				StartTask(connection, m_listenHandler);
+			}
+		}
+
+		void OnDisconnect(TcpConnection& connection) {
+			const auto It = m_channels.find(&connection);
+			if (It == m_channels.end()) {
+				return;
+			}
+			std::unique_ptr<MessageChannel> pChannel = std::move(It->second);
+			m_channels.erase(It);
+			pChannel->m_pConnection = nullptr;
+			if (pChannel->m_isReleased) {
+				return;
+			}
+			//the task may still wait for a frame, the channel stays until it is done
+			MarkReady(*pChannel);
+			MessageChannel* pKey = pChannel.get();
+			m_detached.emplace(pKey, std::move(pChannel));
+		}
+
+		void MarkReady(MessageChannel& channel) {
+			if (channel.m_receiver && !channel.m_isReady) {
+				channel.m_isReady = true;
+				m_ready.push_back(&channel);
+			}
+		}
+
+		void ResumeReceivers() {
+			m_resuming.swap(m_ready);
+			for (MessageChannel* pChannel : m_resuming) {
+				pChannel->m_isReady = false;
+				if (pChannel->m_receiver && pChannel->IsReceiveReady()) {
+					std::exchange(pChannel->m_receiver, nullptr).resume();
+				}
+			}
+			m_resuming.clear();
+		}
+
+		//a resumed sender may block again and add itself while the list is walked, so the list is swapped out first
+		void ResumeBlockedSenders() {
+			m_resuming.swap(m_blockedSenders);
+			for (MessageChannel* pChannel : m_resuming) {
+				if (pChannel->IsSendBlocked(MessageChannel::SendHighWaterMark / 2)) {
+					m_blockedSenders.push_back(pChannel);
+				} else {
+					std::exchange(pChannel->m_sender, nullptr).resume();
+				}
+			}
+			m_resuming.clear();
+		}
+
+		//a done task closes its connection, the channel goes once the connection is gone
+		void ReleaseFinished() {
+			for (MessageChannel* pChannel : m_finished) {
+				pChannel->m_isReleased = true;
+				if (pChannel->m_exception) {
+					ReportError(std::exchange(pChannel->m_exception, nullptr));
+				}
+				if (pChannel->m_pConnection != nullptr) {
+					CloseConnection(*pChannel->m_pConnection);
+				} else {
+					m_detached.erase(pChannel);
+				}
+			}
+			m_finished.clear();
+		}
+
+		//tasks still waiting when the worker stops are destroyed without resuming them
+		void DestroyTasks() noexcept {
+			const auto Destroy = [](MessageChannel& channel) {
+				if (channel.m_receiver) {
+					std::exchange(channel.m_receiver, nullptr).destroy();
+				}
+				if (channel.m_sender) {
+					std::exchange(channel.m_sender, nullptr).destroy();
+				}
+			};
+			for (auto& entry : m_channels) {
+				Destroy(*entry.second);
+			}
+			for (auto& entry : m_detached) {
+				Destroy(*entry.second);
+			}
+			m_channels.clear();
+			m_detached.clear();
+		}
+
+		void ReportError(std::exception_ptr exception) noexcept {
+			if (!m_errorHandler) {
+				return;
+			}
+			try {
+				m_errorHandler(std::move(exception));
+			} catch (...) {
+			}
+		}
+
+		TcpEventLoop m_loop;
+		std::thread m_thread;
+		std::atomic<bool> m_isStopping{ false };
+		std::mutex m_postMutex;
+		std::vector<std::function<void()>> m_posted;
+		std::vector<std::function<void()>> m_running;
+		TaskFactory m_listenHandler;
+		ErrorHandler m_errorHandler;
+		bool m_isConnecting = false;
+		std::unordered_map<TcpConnection*, std::unique_ptr<MessageChannel>> m_channels;
+		//channels whose connection is gone while their task still runs
+		std::unordered_map<MessageChannel*, std::unique_ptr<MessageChannel>> m_detached;
+		std::vector<MessageChannel*> m_ready;
+		std::vector<MessageChannel*> m_resuming;
+		std::vector<MessageChannel*> m_blockedSenders;
+		std::vector<MessageChannel*> m_finished;
+	};
+}//namespace INTERNAL
+
+
+	//a few threads serving any number of connections with one MessageTask each
+	class CoroutineExecutor final {
+	public:
+		using TaskFactory = INTERNAL::CoroutineWorker::TaskFactory;
+		using ErrorHandler = INTERNAL::CoroutineWorker::ErrorHandler;
+
+		explicit CoroutineExecutor(const std::size_t threadCount = std::thread::hardware_concurrency(), const TcpBackend backend = TcpBackend::Auto) {
+			const std::size_t Count = (std::max)(threadCount, std::size_t(1));
+			m_workers.reserve(Count);
+			for (std::size_t i = 0; i < Count; ++i) {
+				m_workers.emplace_back(new INTERNAL::CoroutineWorker(backend));
+			}
+		}
+
+		~CoroutineExecutor() noexcept { Stop(); }
+
+		CoroutineExecutor(const CoroutineExecutor&) = delete;
+		CoroutineExecutor& operator=(const CoroutineExecutor&) = delete;
+
+		//exceptions leaving a task, called on the thread of the task
+		void SetErrorHandler(const ErrorHandler& handler) {
+			ForEachWorker([&handler](INTERNAL::CoroutineWorker& worker) { worker.SetErrorHandler(handler); });
+		}
+
+		//every thread listens on the port, handler(MessageChannel&) is started for each accepted connection.
+		//Returns the bound port, port 0 picks a free one. Waits for the threads, so never call it from a task
+		std::uint16_t Listen(std::uint16_t port, const char* address, const TaskFactory& handler) {
+			const std::string Address = address;
+			for (auto& pWorker : m_workers) {
+				INTERNAL::CoroutineWorker& worker = *pWorker;
+				port = worker.Post([&worker, &Address, &handler, port] {
+					worker.SetListenHandler(handler);
+					return worker.GetLoop().Listen(port, Address.c_str(), SOMAXCONN, true);
+				}).get();
+			}
+			return port;
+		}
+
+		//connects from the threads in turn and starts handler(MessageChannel&) right away, frames sent before
+		//the connection is established are buffered. The future throws if the connect failed
+		std::future<void> Connect(const char* address, const std::uint16_t port, TaskFactory handler) {
+			INTERNAL::CoroutineWorker& worker = *m_workers[m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size()];
+			return worker.Post([&worker, host = std::string(address), port, handler = std::move(handler)] {
+				worker.Connect(host.c_str(), port, handler);
+			});
+		}
+
+		//waits for the threads, tasks still running are destroyed
+		void Stop() noexcept {
+			for (auto& pWorker : m_workers) {
+				pWorker->Stop();
+			}
+		}
+
+		std::size_t GetThreadCount() const noexcept { return m_workers.size(); }
+
+	private:
+		template<typename FuncType>
+		void ForEachWorker(FuncType&& func) {
+			for (auto& pWorker : m_workers) {
+				INTERNAL::CoroutineWorker& worker = *pWorker;
+				worker.Post([&func, &worker] { func(worker); }).get();
+			}
+		}
+
+		std::vector<std::unique_ptr<INTERNAL::CoroutineWorker>> m_workers;
+		std::atomic<std::size_t> m_nextWorker{ 0 };
+	};
+}//namespace messaging
+
+
+inline void messaging::MessageTask::promise_type::NotifyDone() noexcept {
+	m_pChannel->m_worker.OnTaskDone(*m_pChannel, std::move(m_exception));
+}
+
+
+inline void messaging::MessageChannel::SendAwaiter::await_suspend(const std::coroutine_handle<> handle) {
+	m_channel.m_sender = handle;
+	m_channel.m_worker.AddBlockedSender(m_channel);
+}
+
+
+inline void messaging::MessageChannel::Close() {
+	if (IsOpen()) {
+		m_worker.CloseConnection(*m_pConnection);
+	}
+}
+
+
+inline void messaging::INTERNAL::CoroutineWorker::StartTask(TcpConnection& connection, const TaskFactory& factory) {
+	MessageChannel* pChannel = new MessageChannel(*this, connection);
+	m_channels[&connection].reset(pChannel);
+	std::coroutine_handle<MessageTask::promise_type> handle;
+	try {
+		MessageTask task = factory(*pChannel);
+		handle = std::exchange(task.m_handle, nullptr);
+	} catch (...) {
+		pChannel->m_isTaskDone = true;
+		pChannel->m_isReleased = true;
+		CloseConnection(connection);
+		throw;
+	}
+	handle.promise().m_pChannel = pChannel;
+	handle.resume();
+}
+
+
+inline void messaging::INTERNAL::CoroutineWorker::Connect(const char* address, const std::uint16_t port, const TaskFactory& factory) {
+	m_isConnecting = true;
+	TcpConnection* pConnection = nullptr;
+	try {
+		pConnection = &m_loop.Connect(address, port);
+	} catch (...) {
+		m_isConnecting = false;
+		throw;
+	}
+	m_isConnecting = false;
+	StartTask(*pConnection, factory);
+}
+#endif
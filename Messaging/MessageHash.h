@@ -0,0 +1,338 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include "IMessage.h"
+#include "MessageInlineFields.h"
+
+//set to 1 to let every (non static) message remember its last HashMessage result.
+//Setters, the non const getters and the deserializers drop it again,
+//after changing a field through a reference kept from earlier call InvalidateHash yourself
+#ifndef DECLMESSAGE_CACHE_HASH
+	#define DECLMESSAGE_CACHE_HASH 0
+#endif
+
+namespace messaging {
+	template<typename...> class CombinedMessage;
+
+namespace INTERNAL {
+
+	class MessageHasher;
+
+	//wyhash style hashing, fast for short fields and bulk data alike.
+	//The values are only meant for in process containers, they differ between platforms
+	constexpr std::array<std::uint64_t, 4> HashSecret = {
+		0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+	};
+	constexpr std::uint64_t HashSeed = 0x9e3779b97f4a7c15ull;
+
+	inline void HashMultiply(std::uint64_t& a, std::uint64_t& b) noexcept {
+#if defined(__SIZEOF_INT128__)
+		const unsigned __int128 Result = static_cast<unsigned __int128>(a) * b;
+		a = static_cast<std::uint64_t>(Result);
+		b = static_cast<std::uint64_t>(Result >> 64);
+#else
+		const std::uint64_t HighA = a >> 32;
+		const std::uint64_t HighB = b >> 32;
+		const std::uint64_t LowA = static_cast<std::uint32_t>(a);
+		const std::uint64_t LowB = static_cast<std::uint32_t>(b);
+		const std::uint64_t Mid0 = HighA * LowB;
+		const std::uint64_t Mid1 = HighB * LowA;
+		const std::uint64_t Low = LowA * LowB;
+		const std::uint64_t Tmp = Low + (Mid0 << 32);
+		std::uint64_t carry = Tmp < Low;
+		const std::uint64_t ResultLow = Tmp + (Mid1 << 32);
+		carry += ResultLow < Tmp;
+		b = HighA * HighB + (Mid0 >> 32) + (Mid1 >> 32) + carry;
+		a = ResultLow;
+#endif
+	}
+
+	inline std::uint64_t HashMix(std::uint64_t a, std::uint64_t b) noexcept {
+		HashMultiply(a, b);
+		return a ^ b;
+	}
+
+	inline std::uint64_t HashCombine(const std::uint64_t seed, const std::uint64_t value) noexcept {
+		return HashMix(seed ^ HashSecret[0], value ^ HashSecret[1]);
+	}
+
+	inline std::uint64_t HashRead8(const unsigned char* pData) noexcept {
+		std::uint64_t value;
+		std::memcpy(&value, pData, sizeof(value));
+		return value;
+	}
+
+	inline std::uint64_t HashRead4(const unsigned char* pData) noexcept {
+		std::uint32_t value;
+		std::memcpy(&value, pData, sizeof(value));
+		return value;
+	}
+
+	inline std::uint64_t HashBytes(const void* pBytes, const std::size_t len, std::uint64_t seed) noexcept {
+		const auto* pData = static_cast<const unsigned char*>(pBytes);
+		seed ^= HashMix(seed ^ HashSecret[0], HashSecret[1]);
+		std::uint64_t a = 0;
+		std::uint64_t b = 0;
+		if (len <= 16) {
+			if (len >= 4) {
+				const std::size_t Shift = (len >> 3) << 2;
+				a = (HashRead4(pData) << 32) | HashRead4(pData + Shift);
+				b = (HashRead4(pData + len - 4) << 32) | HashRead4(pData + len - 4 - Shift);
+			} else if (len > 0) {
+				a = (static_cast<std::uint64_t>(pData[0]) << 16) | (static_cast<std::uint64_t>(pData[len >> 1]) << 8) | pData[len - 1];
+			}
+		} else {
+			std::size_t rest = len;
+			if (rest > 48) {
+				std::uint64_t seed1 = seed;
+				std::uint64_t seed2 = seed;
+				do {
+					seed = HashMix(HashRead8(pData) ^ HashSecret[1], HashRead8(pData + 8) ^ seed);
+					seed1 = HashMix(HashRead8(pData + 16) ^ HashSecret[2], HashRead8(pData + 24) ^ seed1);
+					seed2 = HashMix(HashRead8(pData + 32) ^ HashSecret[3], HashRead8(pData + 40) ^ seed2);
+					pData += 48;
+					rest -= 48;
+				} while (rest > 48);
+				seed ^= seed1 ^ seed2;
+			}
+			while (rest > 16) {
+				seed = HashMix(HashRead8(pData) ^ HashSecret[1], HashRead8(pData + 8) ^ seed);
+				pData += 16;
+				rest -= 16;
+			}
+			a = HashRead8(pData + rest - 16);
+			b = HashRead8(pData + rest - 8);
+		}
+		a ^= HashSecret[1];
+		b ^= seed;
+		HashMultiply(a, b);
+		return HashMix(a ^ HashSecret[0] ^ len, b ^ HashSecret[1]);
+	}
+
+	template<typename T, std::enable_if_t<IsBytewiseComparable<T>::Value, bool> Dummy = false>
+	std::uint64_t HashField(const T& field, const std::uint64_t seed) noexcept;
+
+	template<typename T, std::enable_if_t<std::is_floating_point<T>::value, bool> Dummy = false>
+	std::uint64_t HashField(const T& field, const std::uint64_t seed) noexcept;
+
+	template<typename T, std::enable_if_t<IsMessageField<T>, bool> Dummy = false>
+	std::uint64_t HashField(const T& field, const std::uint64_t seed);
+
+	template<typename T, std::size_t N, std::enable_if_t<!IsBytewiseComparable<std::array<T, N>>::Value, bool> Dummy = false>
+	std::uint64_t HashField(const std::array<T, N>& field, std::uint64_t seed);
+
+	template<typename CharType, typename TraitsType, typename AllocatorType>
+	std::uint64_t HashField(const std::basic_string<CharType, TraitsType, AllocatorType>& field, const std::uint64_t seed) noexcept;
+
+	template<std::size_t N>
+	std::uint64_t HashField(const InlineString<N>& field, const std::uint64_t seed) noexcept;
+
+	template<std::size_t N>
+	std::uint64_t HashField(const FixedString<N>& field, const std::uint64_t seed) noexcept;
+
+	template<typename T, typename AllocatorType>
+	std::uint64_t HashField(const std::vector<T, AllocatorType>& field, const std::uint64_t seed);
+
+	template<typename AllocatorType>
+	std::uint64_t HashField(const std::vector<bool, AllocatorType>& field, std::uint64_t seed) noexcept;
+
+	template<typename T, std::size_t N>
+	std::uint64_t HashField(const SmallVector<T, N>& field, const std::uint64_t seed);
+
+	template<typename T, std::enable_if_t<!IsBytewiseComparable<T>::Value && !std::is_floating_point<T>::value
+		&& !IsMessageField<T> && !IsStdArray<T>::Value, bool> Dummy = false>
+	std::uint64_t HashField(const T& field, const std::uint64_t seed);
+
+	template<typename T>
+	inline std::uint64_t HashRange(const T* pData, const std::size_t count, std::uint64_t seed, std::true_type isBulk) noexcept {
+		(void)isBulk;
+		return HashBytes(pData, count * sizeof(T), seed);
+	}
+
+	template<typename T>
+	inline std::uint64_t HashRange(const T* pData, const std::size_t count, std::uint64_t seed, std::false_type isBulk) {
+		(void)isBulk;
+		seed = HashCombine(seed, count);
+		for (std::size_t i = 0; i < count; ++i) {
+			seed = HashField(pData[i], seed);
+		}
+		return seed;
+	}
+
+	template<typename T>
+	inline std::uint64_t HashRange(const T* pData, const std::size_t count, const std::uint64_t seed) {
+		return HashRange(pData, count, seed, std::integral_constant<bool, IsBytewiseComparable<T>::Value>{});
+	}
+
+
+	class MessageHasher final {
+	public:
+		template<typename MessageType>
+		static std::uint64_t Hash(const MessageType& msg) {
+			std::uint64_t hash = 0;
+			if (msg.GetCachedHash(hash)) {
+				return hash;
+			}
+			hash = HashSeed;
+			//one call per std::array of equally typed fields, integral arrays are a single HashBytes
+			msg.ForEachArrayFieldDo([&hash](const auto& array, const std::size_t Idx) {
+				(void)Idx;
+				hash = HashField(array, hash);
+			});
+			msg.SetCachedHash(hash);
+			return hash;
+		}
+
+		template<typename... PartMessageTypes>
+		static std::uint64_t Hash(const CombinedMessage<PartMessageTypes...>& msg) {
+			std::uint64_t hash = HashSeed;
+			(void)std::initializer_list<int>{(hash = HashCombine(hash, Hash(static_cast<const PartMessageTypes&>(msg))), 0)...};
+			return hash;
+		}
+	};
+
+
+	template<typename T, std::enable_if_t<IsBytewiseComparable<T>::Value, bool> Dummy>
+	inline std::uint64_t HashField(const T& field, const std::uint64_t seed) noexcept {
+		return HashBytes(&field, sizeof(T), seed);
+	}
+
+	template<typename T, std::enable_if_t<std::is_floating_point<T>::value, bool> Dummy>
+	inline std::uint64_t HashField(const T& field, const std::uint64_t seed) noexcept {
+		//0.0 == -0.0 so both need the same hash
+		const double Value = field == T(0) ? 0.0 : static_cast<double>(field);
+		return HashBytes(&Value, sizeof(Value), seed);
+	}
+
+	template<typename T, std::enable_if_t<IsMessageField<T>, bool> Dummy>
+	inline std::uint64_t HashField(const T& field, const std::uint64_t seed) {
+		return HashCombine(seed, MessageHasher::Hash(field));
+	}
+
+	template<typename T, std::size_t N, std::enable_if_t<!IsBytewiseComparable<std::array<T, N>>::Value, bool> Dummy>
+	inline std::uint64_t HashField(const std::array<T, N>& field, std::uint64_t seed) {
+		for (const auto& entry : field) {
+			seed = HashField(entry, seed);
+		}
+		return seed;
+	}
+
+	template<typename CharType, typename TraitsType, typename AllocatorType>
+	inline std::uint64_t HashField(const std::basic_string<CharType, TraitsType, AllocatorType>& field, const std::uint64_t seed) noexcept {
+		return HashBytes(field.data(), field.size() * sizeof(CharType), seed);
+	}
+
+	template<std::size_t N>
+	inline std::uint64_t HashField(const InlineString<N>& field, const std::uint64_t seed) noexcept {
+		return HashBytes(field.data(), field.size(), seed);
+	}
+
+	template<std::size_t N>
+	inline std::uint64_t HashField(const FixedString<N>& field, const std::uint64_t seed) noexcept {
+		return HashBytes(field.data(), field.size(), seed);
+	}
+
+	template<typename T, typename AllocatorType>
+	inline std::uint64_t HashField(const std::vector<T, AllocatorType>& field, const std::uint64_t seed) {
+		return HashRange(field.data(), field.size(), seed);
+	}
+
+	template<typename AllocatorType>
+	inline std::uint64_t HashField(const std::vector<bool, AllocatorType>& field, std::uint64_t seed) noexcept {
+		seed = HashCombine(seed, field.size());
+		std::uint64_t bits = 0;
+		for (std::size_t i = 0; i < field.size(); ++i) {
+			bits = (bits << 1) | static_cast<std::uint64_t>(field[i]);
+			if (i % 64 == 63) {
+				seed = HashCombine(seed, bits);
+				bits = 0;
+			}
+		}
+		return HashCombine(seed, bits);
+	}
+
+	template<typename T, std::size_t N>
+	inline std::uint64_t HashField(const SmallVector<T, N>& field, const std::uint64_t seed) {
+		return HashRange(field.data(), field.size(), seed);
+	}
+
+	template<typename T, std::enable_if_t<!IsBytewiseComparable<T>::Value && !std::is_floating_point<T>::value
+		&& !IsMessageField<T> && !IsStdArray<T>::Value, bool> Dummy>
+	inline std::uint64_t HashField(const T& field, const std::uint64_t seed) {
+		return HashCombine(seed, static_cast<std::uint64_t>(std::hash<T>{}(field)));
+	}
+
+
+	//remembers the last hash of a message, derives from the message base so it takes no space if disabled
+	template<bool IsEnabled, typename BaseType>
+	class MessageHashCache;
+
+	template<typename BaseType>
+	class MessageHashCache<false, BaseType> : public BaseType {
+	public:
+		void InvalidateHash() const noexcept {}
+	protected:
+		friend MessageHasher;
+		bool GetCachedHash(std::uint64_t& hash) const noexcept { (void)hash; return false; }
+		void SetCachedHash(const std::uint64_t hash) const noexcept { (void)hash; }
+	};
+
+	template<typename BaseType>
+	class MessageHashCache<true, BaseType> : public BaseType {
+	public:
+		void InvalidateHash() const noexcept { m_hash.store(0, std::memory_order_relaxed); }
+	protected:
+		friend MessageHasher;
+		MessageHashCache() noexcept = default;
+		MessageHashCache(const MessageHashCache& other) noexcept : BaseType(other), m_hash(other.m_hash.load(std::memory_order_relaxed)) {}
+		//the moved from message has other field values now
+		MessageHashCache(MessageHashCache&& other) noexcept : BaseType(std::move(other)), m_hash(other.m_hash.exchange(0, std::memory_order_relaxed)) {}
+		MessageHashCache& operator=(const MessageHashCache& other) noexcept {
+			BaseType::operator=(other);
+			m_hash.store(other.m_hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			return *this;
+		}
+		MessageHashCache& operator=(MessageHashCache&& other) noexcept {
+			BaseType::operator=(std::move(other));
+			m_hash.store(other.m_hash.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+			return *this;
+		}
+		~MessageHashCache() noexcept = default;
+
+		//0 means not cached, a real hash of 0 is simply computed again
+		bool GetCachedHash(std::uint64_t& hash) const noexcept {
+			hash = m_hash.load(std::memory_order_relaxed);
+			return hash != 0;
+		}
+		void SetCachedHash(const std::uint64_t hash) const noexcept { m_hash.store(hash, std::memory_order_relaxed); }
+	private:
+		mutable std::atomic<std::uint64_t> m_hash{ 0 };
+	};
+}//namespace INTERNAL
+
+	//content hash of a message which agrees with operator== : equal messages have equal hashes.
+	//Fields are hashed straight from the field storage, nothing is serialized
+	template<typename MessageType>
+	inline std::size_t HashMessage(const MessageType& msg) {
+		return static_cast<std::size_t>(INTERNAL::MessageHasher::Hash(msg));
+	}
+
+	//hash functor for unordered containers of messages, e.g. std::unordered_set<MyMessage, messaging::MessageHash>
+	struct MessageHash {
+		template<typename MessageType>
+		std::size_t operator()(const MessageType& msg) const { return HashMessage(msg); }
+	};
+}//namespace messaging
+
+//opt-in std::hash for a message declared with DECLMESSAGE/DECLSTATICMESSAGE.
+//Has to be used in the global namespace, messages declared in a namespace are passed qualified : DECLMESSAGE_STD_HASH(game::PositionMessage)
+#define DECLMESSAGE_STD_HASH(msgName) \
+	namespace std { template<> struct hash<msgName> : messaging::MessageHash {}; }
@@ -1,17 +1,42 @@
 #pragma once
 #include <array>
 #include <vector>
+#include <string>
+#include <memory>
+#include <new>
+#include <cstring>
+#include <utility>
 #include <type_traits>
 #include "../utils/ConstexprStringUtils.h"
 #include "../utils/ConstexprStringView.h"
+#include "MessageInlineFields.h"
+#if defined(__has_include)
+	#if __has_include(<memory_resource>) && (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+		#include <memory_resource>
+		#define MESSAGING_HAS_PMR 1
+	#endif
+#endif
+#ifndef MESSAGING_HAS_PMR
+	#define MESSAGING_HAS_PMR 0
+#endif
 
 namespace messaging {
 	template<typename, typename...> class BasicMessage;
 	class IMessage;
 
 	template<typename T, std::size_t N> using StaticMessageArray = std::array<T, N>;
-	template<typename T> using DnymaicMessageArray = std::vector<T>;
-	using DynamicMessageString = std::string;
+	template<typename T, typename AllocatorType = std::allocator<T>> using DnymaicMessageArray = std::vector<T, AllocatorType>;
+	template<typename AllocatorType = std::allocator<char>>
+	using BasicDynamicMessageString = std::basic_string<char, std::char_traits<char>, AllocatorType>;
+	using DynamicMessageString = BasicDynamicMessageString<>;
+
+#if MESSAGING_HAS_PMR
+	//fields allocating from a std::pmr::memory_resource, see MessageMemoryResource.h
+	namespace pmr {
+		template<typename T> using DnymaicMessageArray = std::pmr::vector<T>;
+		using DynamicMessageString = std::pmr::string;
+	}
+#endif
 
 namespace INTERNAL {
 	class EnumTag;
@@ -24,6 +49,19 @@ namespace INTERNAL {
 	template<typename T>
 	using AddConstLVReference = std::add_lvalue_reference_t<std::add_const_t<T>>;
 
+	class StaticMessageBase;
+
+	//DECLMESSAGE and DECLSTATICMESSAGE types
+	template<typename T>
+	constexpr bool IsMessageField = std::is_base_of<IMessage, RemoveCVREF<T>>::value || std::is_base_of<StaticMessageBase, RemoveCVREF<T>>::value;
+
+	//fields written as raw bytes, nested messages are always written field by field so their padding is never serialized
+	template<typename T, typename = void>
+	struct IsRawField : std::integral_constant<bool, std::is_trivially_copyable<T>::value && !IsMessageField<T>> {};
+
+	template<typename T, std::size_t N>
+	struct IsRawField<std::array<T, N>, void> : IsRawField<T> {};
+
 	template<typename T, typename = void>
 	struct EnumConverter {
 		using Type = INTERNAL::RemoveCVREF<T>;
@@ -49,16 +87,55 @@ namespace INTERNAL {
 		static constexpr bool Value = false;
 	};
 
-	template<typename T>
-	struct IsStdVector<std::vector<T>> {
+	template<typename T, typename AllocatorType>
+	struct IsStdVector<std::vector<T, AllocatorType>> {
+		static constexpr bool Value = true;
+	};
+
+	template<typename>
+	struct IsStdString {
+		static constexpr bool Value = false;
+	};
+
+	template<typename TraitsType, typename AllocatorType>
+	struct IsStdString<std::basic_string<char, TraitsType, AllocatorType>> {
 		static constexpr bool Value = true;
 	};
 
+	//types whose bytes are equal exactly when the values compare equal (no floats, no padding),
+	//these can be compared with memcmp and hashed as one block
+	template<typename T>
+	struct IsBytewiseComparable {
+		static constexpr bool Value = std::is_integral<T>::value || std::is_enum<T>::value;
+	};
+
+	template<typename T, std::size_t N>
+	struct IsBytewiseComparable<std::array<T, N>> {
+		static constexpr bool Value = IsBytewiseComparable<T>::Value && sizeof(std::array<T, N>) == sizeof(T) * N;
+	};
+
+	template<typename T, std::size_t N>
+	inline bool AreArrayFieldsEqual(const std::array<T, N>& left, const std::array<T, N>& right, std::true_type isBytewise) noexcept {
+		(void)isBytewise;
+		return std::memcmp(left.data(), right.data(), sizeof(left)) == 0;
+	}
+
+	template<typename T, std::size_t N>
+	inline bool AreArrayFieldsEqual(const std::array<T, N>& left, const std::array<T, N>& right, std::false_type isBytewise) {
+		(void)isBytewise;
+		return left == right;
+	}
+
+	template<typename T, std::size_t N>
+	inline bool AreArrayFieldsEqual(const std::array<T, N>& left, const std::array<T, N>& right) {
+		return AreArrayFieldsEqual(left, right, std::integral_constant<bool, IsBytewiseComparable<std::array<T, N>>::Value>{});
+	}
+
 	template<typename T, typename DecayedT = INTERNAL::RemoveCVREF<T>> 
 	constexpr bool IsDynamicOrStaticArray = IsStdVector<DecayedT>::Value || IsStdArray<DecayedT>::Value;
 
 	template<typename T, typename DecayedT = INTERNAL::RemoveCVREF<T>>
-	constexpr bool IsDynamicString = std::is_same<DecayedT, std::string>::value;
+	constexpr bool IsDynamicString = IsStdString<DecayedT>::Value;
 
 	template<typename>
 	struct IsStaticTuple;
@@ -76,8 +153,8 @@ namespace INTERNAL {
 	template<typename FirstFieldType, typename... RestFieldTypes>
 	struct IsStaticTuple<std::tuple<FirstFieldType, RestFieldTypes...>> {
 		using FirstFieldDecayed = RemoveCVREF<FirstFieldType>;
-		static constexpr bool Value = (std::is_trivially_copyable<FirstFieldDecayed>::value ||
-			IsStaticNestedMsg<FirstFieldDecayed>(std::is_base_of<IMessage, FirstFieldDecayed>{}))
+		static constexpr bool Value = (IsRawField<FirstFieldDecayed>::value ||
+			IsStaticNestedMsg<FirstFieldDecayed>(std::integral_constant<bool, IsMessageField<FirstFieldDecayed>>{}))
 			&& IsStaticTuple<std::tuple<RestFieldTypes...>>::Value;
 	};
 
@@ -107,21 +184,21 @@ namespace INTERNAL {
 
 		template<typename T, std::size_t N, typename SFINAEDummy>
 		struct SizeOfMessageField<std::array<T, N>, SFINAEDummy > {
-			static constexpr std::size_t Size = sizeof(RemoveCVREF<T>) * N;
+			static constexpr std::size_t Size = SizeOfMessageField<T, void>::Size * N;
 		};
 
 		template<typename MessageType>
-		struct SizeOfMessageField<MessageType, std::enable_if_t<std::is_base_of<IMessage, RemoveCVREF<MessageType>>::value>> {
+		struct SizeOfMessageField<MessageType, std::enable_if_t<IsMessageField<MessageType>>> {
 			static constexpr std::size_t Size = MessageType::GetStaticMessageSize();
 		};
 
 
 		template<typename T, bool SecondCond = true>
-		using EnableBoolIfTrivial= std::enable_if_t<std::is_trivially_copyable<RemoveCVREF<T>>::value
+		using EnableBoolIfTrivial= std::enable_if_t<IsRawField<RemoveCVREF<T>>::value
 			&& SecondCond, bool>;
 
 		template<typename T, bool SecondCond = true>
-		using EnableBoolIfNotTrivial = std::enable_if_t<(!std::is_trivially_copyable<RemoveCVREF<T>>::value)
+		using EnableBoolIfNotTrivial = std::enable_if_t<(!IsRawField<RemoveCVREF<T>>::value)
 			&& SecondCond, bool>;
 
 
@@ -130,17 +207,18 @@ namespace INTERNAL {
 			return sizeof(RemoveCVREF<T>);
 		}
 
-		template<typename T, EnableBoolIfNotTrivial<T, std::is_base_of<IMessage, RemoveCVREF<T>>::value> Dummy = false>
+		template<typename T, EnableBoolIfNotTrivial<T, IsMessageField<T>> Dummy = false>
 		constexpr std::size_t DynamicSizeOfMessageField(const T& val) noexcept {
 			return val.GetMessageSize();
 		}
 		
-		inline std::size_t DynamicSizeOfMessageField(const std::string& val) noexcept {
-			return (val.size() * sizeof(std::string::value_type)) + sizeof(SerializedSizeDataType);
+		template<typename TraitsType, typename AllocatorType>
+		inline std::size_t DynamicSizeOfMessageField(const std::basic_string<char, TraitsType, AllocatorType>& val) noexcept {
+			return (val.size() * sizeof(char)) + sizeof(SerializedSizeDataType);
 		}
 
-		template<typename T, EnableBoolIfNotTrivial<T> Dummy = false>
-		constexpr std::size_t DynamicSizeOfMessageField(const std::vector<T>& val) noexcept {
+		template<typename T, typename AllocatorType, EnableBoolIfNotTrivial<T> Dummy = false>
+		constexpr std::size_t DynamicSizeOfMessageField(const std::vector<T, AllocatorType>& val) noexcept {
 			std::size_t res = sizeof(SerializedSizeDataType);
 			for (const auto& entry : val) {
 				res += DynamicSizeOfMessageField(entry);
@@ -148,9 +226,28 @@ namespace INTERNAL {
 			return res;
 		}
 
-		template<typename T, EnableBoolIfTrivial<T> Dummy = false>
-		constexpr std::size_t DynamicSizeOfMessageField(const std::vector<T>& val) noexcept {
-			return (val.size() * sizeof(typename std::vector<T>::value_type)) + sizeof(SerializedSizeDataType);
+		template<typename T, typename AllocatorType, EnableBoolIfTrivial<T> Dummy = false>
+		constexpr std::size_t DynamicSizeOfMessageField(const std::vector<T, AllocatorType>& val) noexcept {
+			return (val.size() * sizeof(T)) + sizeof(SerializedSizeDataType);
+		}
+
+		template<std::size_t N>
+		inline std::size_t DynamicSizeOfMessageField(const InlineString<N>& val) noexcept {
+			return (val.size() * sizeof(char)) + sizeof(SerializedSizeDataType);
+		}
+
+		template<typename T, std::size_t N, EnableBoolIfTrivial<T> Dummy = false>
+		inline std::size_t DynamicSizeOfMessageField(const SmallVector<T, N>& val) noexcept {
+			return (val.size() * sizeof(T)) + sizeof(SerializedSizeDataType);
+		}
+
+		template<typename T, std::size_t N, EnableBoolIfNotTrivial<T> Dummy = false>
+		inline std::size_t DynamicSizeOfMessageField(const SmallVector<T, N>& val) noexcept {
+			std::size_t res = sizeof(SerializedSizeDataType);
+			for (const auto& entry : val) {
+				res += DynamicSizeOfMessageField(entry);
+			}
+			return res;
 		}
 
 		template<typename T, std::size_t N, EnableBoolIfNotTrivial<T> Dummy = false>
@@ -164,7 +261,7 @@ namespace INTERNAL {
 
 		template<typename T> constexpr bool IsMessageContainer(std::false_type) { return false; }
 		template<typename T> constexpr bool IsMessageContainer(std::true_type) {
-			return std::is_base_of<IMessage, typename RemoveCVREF<T>::value_type>::value;
+			return IsMessageField<typename RemoveCVREF<T>::value_type>;
 		}
 
 		template<typename ContainerType>
@@ -199,6 +296,10 @@ namespace INTERNAL {
 
 	enum class Byte : std::uint8_t {};
 
+	//stable id of a DECLMESSAGE type derived from its MessageStringName
+	template<typename MessageType>
+	constexpr std::uint32_t MessageTypeId = utils::StrHash32(MessageType::MessageStringName, sizeof(MessageType::MessageStringName) - 1);
+
 
 
 	template<typename T>
@@ -221,17 +322,31 @@ namespace INTERNAL {
 	}
 
 
+namespace INTERNAL {
+	//true if the arguments are a single object of ArrayType, these have to go to the copy/move constructor
+	template<typename ArrayType, typename... ValTypes>
+	struct IsArrayCopySource : std::false_type {};
+
+	template<typename ArrayType, typename ValType>
+	struct IsArrayCopySource<ArrayType, ValType> : std::is_same<RemoveCVREF<ValType>, ArrayType> {};
+}//namespace INTERNAL
+
+
 	//Note prior to C++17 std::arrays non const functions were not constexpr
 	template<typename T, std::size_t LEN>
 	struct ConstexprArray {
 		constexpr ConstexprArray() = default;
+		constexpr ConstexprArray(const ConstexprArray&) = default;
+		constexpr ConstexprArray(ConstexprArray&&) = default;
+		constexpr ConstexprArray& operator=(const ConstexprArray&) = default;
+		constexpr ConstexprArray& operator=(ConstexprArray&&) = default;
 		constexpr ConstexprArray(const T(&otherArray)[LEN]) {
 			for (auto i = 0; i < LEN; ++i) {
 				m_data[i] = otherArray[i];
 			}
 		}
 
-		template<typename... ValTypes>
+		template<typename... ValTypes, std::enable_if_t<!INTERNAL::IsArrayCopySource<ConstexprArray, ValTypes...>::value, bool> Dummy = false>
 		constexpr ConstexprArray(ValTypes&&... values) : m_data{ values... } {}
 
 		constexpr T& operator[](const std::size_t Idx) {
@@ -357,5 +472,27 @@ namespace INTERNAL {
 		return parsedEnums;
 	}
 
+	//the new value is built aside and moved in, the arguments may refer to the field itself
+	//and a throwing constructor leaves the field untouched
+	template<typename FieldType, typename... ArgTypes>
+	inline void EmplaceField(FieldType& field, ArgTypes&&... args) {
+		FieldType value(std::forward<ArgTypes>(args)...);
+		field = std::move(value);
+	}
+
+	template<typename T>
+	inline void AppendPod(std::vector<Byte>& buffer, const T& value) {
+		const std::size_t Offset = buffer.size();
+		buffer.resize(Offset + sizeof(T));
+		std::memcpy(buffer.data() + Offset, &value, sizeof(T));
+	}
+
+	template<typename T>
+	inline T ReadPod(const void* pSource) noexcept {
+		T value;
+		std::memcpy(&value, pSource, sizeof(T));
+		return value;
+	}
+
 } // namespace INTERNAL
 }
\ No newline at end of file
@@ -21,8 +21,8 @@ namespace INTERNAL {
 		template<std::size_t... Offsets>
 		constexpr decltype(auto) CreateIndiceContainerZeroOffset(IndiceContainer<Offsets...> dummyContainer) noexcept {
 			(void)dummyContainer;
-			static constexpr std::size_t OffsetArr[] = { Offsets... };
-			static constexpr auto HighestOffset = Max(OffsetArr) + 1;
+			constexpr std::size_t OffsetArr[] = { Offsets... };
+			constexpr auto HighestOffset = Max(OffsetArr) + 1;
 			ConstexprArray<std::size_t, HighestOffset> result = {};
 			std::size_t i = 0;
 			(void)std::initializer_list<std::size_t>{(result[Offsets] = i++)...};
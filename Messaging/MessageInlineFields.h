@@ -0,0 +1,523 @@
+#pragma once
+#include <new>
+#include <string>
+#include <memory>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <ostream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+
+namespace messaging {
+
+	//string field which keeps up to N chars inside the message and only allocates for longer strings.
+	//Serialized exactly like std::string
+	template<std::size_t N>
+	class InlineString final {
+	public:
+		using value_type = char;
+		using size_type = std::size_t;
+		using iterator = char*;
+		using const_iterator = const char*;
+
+		static constexpr std::size_t InlineCapacity = N;
+
+		InlineString() noexcept { m_inline[0] = '\0'; }
+		InlineString(const char* str) : InlineString() { assign(str, std::strlen(str)); }
+		InlineString(const char* str, const std::size_t len) : InlineString() { assign(str, len); }
+		InlineString(const std::string& str) : InlineString() { assign(str.data(), str.size()); }
+		InlineString(const InlineString& other) : InlineString() { assign(other.data(), other.size()); }
+		InlineString(InlineString&& other) noexcept : InlineString() { MoveFrom(other); }
+		~InlineString() { FreeHeap(); }
+
+		InlineString& operator=(const InlineString& other) {
+			if (this != &other) {
+				assign(other.data(), other.size());
+			}
+			return *this;
+		}
+		InlineString& operator=(InlineString&& other) noexcept {
+			if (this != &other) {
+				FreeHeap();
+				MoveFrom(other);
+			}
+			return *this;
+		}
+		InlineString& operator=(const char* str) { return assign(str, std::strlen(str)); }
+		InlineString& operator=(const std::string& str) { return assign(str.data(), str.size()); }
+
+		InlineString& assign(const char* str, const std::size_t len) {
+			reserve(len);
+			std::memmove(m_pData, str, len);
+			m_size = len;
+			m_pData[m_size] = '\0';
+			return *this;
+		}
+
+		InlineString& append(const char* str, const std::size_t len) {
+			//str may point into this string, reserve releases the old buffer
+			if (str >= m_pData && str < m_pData + m_size) {
+				const std::size_t Offset = static_cast<std::size_t>(str - m_pData);
+				reserve(m_size + len);
+				str = m_pData + Offset;
+			} else {
+				reserve(m_size + len);
+			}
+			std::memmove(m_pData + m_size, str, len);
+			m_size += len;
+			m_pData[m_size] = '\0';
+			return *this;
+		}
+		InlineString& operator+=(const char* str) { return append(str, std::strlen(str)); }
+		InlineString& operator+=(const std::string& str) { return append(str.data(), str.size()); }
+		InlineString& operator+=(const char ch) { push_back(ch); return *this; }
+
+		void push_back(const char ch) { append(&ch, 1); }
+
+		void reserve(const std::size_t capacity) {
+			if (capacity > m_capacity) {
+				const std::size_t NewCapacity = (std::max)(capacity, m_capacity * 2);
+				std::unique_ptr<char[]> pNewData{ new char[NewCapacity + 1] };
+				std::memcpy(pNewData.get(), m_pData, m_size + 1);
+				FreeHeap();
+				m_pData = pNewData.release();
+				m_capacity = NewCapacity;
+			}
+		}
+
+		void resize(const std::size_t size, const char ch = '\0') {
+			reserve(size);
+			if (size > m_size) {
+				std::memset(m_pData + m_size, ch, size - m_size);
+			}
+			m_size = size;
+			m_pData[m_size] = '\0';
+		}
+
+		void clear() noexcept {
+			m_size = 0;
+			m_pData[0] = '\0';
+		}
+
+		inline std::size_t size() const noexcept { return m_size; }
+		inline std::size_t length() const noexcept { return m_size; }
+		inline std::size_t capacity() const noexcept { return m_capacity; }
+		inline bool empty() const noexcept { return m_size == 0; }
+		inline bool IsInline() const noexcept { return m_pData == m_inline; }
+		inline const char* data() const noexcept { return m_pData; }
+		inline char* data() noexcept { return m_pData; }
+		inline const char* c_str() const noexcept { return m_pData; }
+		inline char* begin() noexcept { return m_pData; }
+		inline char* end() noexcept { return m_pData + m_size; }
+		inline const char* begin() const noexcept { return m_pData; }
+		inline const char* end() const noexcept { return m_pData + m_size; }
+		inline char& operator[](const std::size_t Idx) noexcept { return m_pData[Idx]; }
+		inline const char& operator[](const std::size_t Idx) const noexcept { return m_pData[Idx]; }
+
+		std::string ToString() const { return std::string{ m_pData, m_size }; }
+		explicit operator std::string() const { return ToString(); }
+
+		int compare(const char* str, const std::size_t len) const noexcept {
+			const int Result = std::memcmp(m_pData, str, (std::min)(m_size, len));
+			if (Result != 0) {
+				return Result;
+			}
+			return m_size < len ? -1 : (m_size > len ? 1 : 0);
+		}
+
+		bool operator==(const InlineString& other) const noexcept { return compare(other.data(), other.size()) == 0; }
+		bool operator!=(const InlineString& other) const noexcept { return !(*this == other); }
+		bool operator<(const InlineString& other) const noexcept { return compare(other.data(), other.size()) < 0; }
+		bool operator==(const char* str) const noexcept { return compare(str, std::strlen(str)) == 0; }
+		bool operator!=(const char* str) const noexcept { return !(*this == str); }
+		bool operator==(const std::string& str) const noexcept { return compare(str.data(), str.size()) == 0; }
+		bool operator!=(const std::string& str) const noexcept { return !(*this == str); }
+
+	private:
+		void FreeHeap() noexcept {
+			if (m_pData != m_inline) {
+				delete[] m_pData;
+			}
+			m_pData = m_inline;
+			m_capacity = N;
+		}
+
+		//other is left empty
+		void MoveFrom(InlineString& other) noexcept {
+			if (other.IsInline()) {
+				std::memcpy(m_inline, other.m_inline, other.m_size + 1);
+				m_pData = m_inline;
+				m_capacity = N;
+			} else {
+				m_pData = other.m_pData;
+				m_capacity = other.m_capacity;
+				other.m_pData = other.m_inline;
+				other.m_capacity = N;
+			}
+			m_size = other.m_size;
+			other.m_size = 0;
+			other.m_inline[0] = '\0';
+		}
+
+		char* m_pData = m_inline;
+		std::size_t m_size = 0;
+		std::size_t m_capacity = N;
+		char m_inline[N + 1];
+	};
+
+
+	template<std::size_t N>
+	inline std::ostream& operator<<(std::ostream& os, const InlineString<N>& str) {
+		return os.write(str.data(), static_cast<std::streamsize>(str.size()));
+	}
+
+
+	//string field with a fixed capacity of N chars : one length byte followed by the chars.
+	//It is trivially copyable, so messages built only from FixedString and arithmetic fields have a
+	//compile time size and are serialized with plain memcpy. The unused chars are always zero
+	template<std::size_t N>
+	class FixedString final {
+	public:
+		static_assert(N > 0 && N <= 255, "FixedString length has to fit into its length byte!!!");
+
+		using value_type = char;
+		using size_type = std::size_t;
+		using iterator = char*;
+		using const_iterator = const char*;
+
+		static constexpr std::size_t MaxSize = N;
+
+		constexpr FixedString() noexcept = default;
+		FixedString(const char* str) { assign(str, std::strlen(str)); }
+		FixedString(const char* str, const std::size_t len) { assign(str, len); }
+		FixedString(const std::string& str) { assign(str.data(), str.size()); }
+
+		FixedString& operator=(const char* str) { return assign(str, std::strlen(str)); }
+		FixedString& operator=(const std::string& str) { return assign(str.data(), str.size()); }
+
+		FixedString& assign(const char* str, const std::size_t len) {
+			if (len > N) {
+				throw std::length_error{ "string is too long for the FixedString!!!" };
+			}
+			std::memmove(m_data, str, len);
+			std::memset(m_data + len, 0, N - len);
+			m_size = static_cast<std::uint8_t>(len);
+			return *this;
+		}
+
+		FixedString& append(const char* str, const std::size_t len) {
+			const std::size_t Size = size();
+			if (Size + len > N) {
+				throw std::length_error{ "string is too long for the FixedString!!!" };
+			}
+			std::memmove(m_data + Size, str, len);
+			m_size = static_cast<std::uint8_t>(Size + len);
+			return *this;
+		}
+		FixedString& operator+=(const char* str) { return append(str, std::strlen(str)); }
+		FixedString& operator+=(const std::string& str) { return append(str.data(), str.size()); }
+
+		void clear() noexcept {
+			std::memset(m_data, 0, N);
+			m_size = 0;
+		}
+
+		//the length byte comes straight from the wire, so it is clamped to N
+		inline constexpr std::size_t size() const noexcept { return m_size < N ? m_size : N; }
+		inline constexpr std::size_t length() const noexcept { return size(); }
+		static constexpr std::size_t capacity() noexcept { return N; }
+		inline constexpr bool empty() const noexcept { return m_size == 0; }
+		inline const char* data() const noexcept { return m_data; }
+		inline char* data() noexcept { return m_data; }
+		inline char* begin() noexcept { return m_data; }
+		inline char* end() noexcept { return m_data + size(); }
+		inline const char* begin() const noexcept { return m_data; }
+		inline const char* end() const noexcept { return m_data + size(); }
+		inline char& operator[](const std::size_t Idx) noexcept { return m_data[Idx]; }
+		inline const char& operator[](const std::size_t Idx) const noexcept { return m_data[Idx]; }
+
+		std::string ToString() const { return std::string{ m_data, size() }; }
+		explicit operator std::string() const { return ToString(); }
+
+		int compare(const char* str, const std::size_t len) const noexcept {
+			const int Result = std::memcmp(m_data, str, (std::min)(size(), len));
+			if (Result != 0) {
+				return Result;
+			}
+			return size() < len ? -1 : (size() > len ? 1 : 0);
+		}
+
+		bool operator==(const FixedString& other) const noexcept { return compare(other.data(), other.size()) == 0; }
+		bool operator!=(const FixedString& other) const noexcept { return !(*this == other); }
+		bool operator<(const FixedString& other) const noexcept { return compare(other.data(), other.size()) < 0; }
+		bool operator==(const char* str) const noexcept { return compare(str, std::strlen(str)) == 0; }
+		bool operator!=(const char* str) const noexcept { return !(*this == str); }
+		bool operator==(const std::string& str) const noexcept { return compare(str.data(), str.size()) == 0; }
+		bool operator!=(const std::string& str) const noexcept { return !(*this == str); }
+
+	private:
+		std::uint8_t m_size = 0;
+		char m_data[N] = {};
+	};
+
+
+	template<std::size_t N>
+	inline std::ostream& operator<<(std::ostream& os, const FixedString<N>& str) {
+		return os.write(str.data(), static_cast<std::streamsize>(str.size()));
+	}
+
+
+	//vector field which keeps up to N elements inside the message and only allocates when it grows beyond.
+	//Serialized exactly like std::vector
+	template<typename T, std::size_t N>
+	class SmallVector final {
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+		using iterator = T*;
+		using const_iterator = const T*;
+
+		static constexpr std::size_t InlineCapacity = N;
+
+		SmallVector() noexcept = default;
+		SmallVector(std::initializer_list<T> values) { assign(values.begin(), values.end()); }
+		explicit SmallVector(const std::size_t size) { resize(size); }
+		SmallVector(const SmallVector& other) { assign(other.begin(), other.end()); }
+		SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) { MoveFrom(other); }
+		~SmallVector() {
+			clear();
+			FreeHeap();
+		}
+
+		SmallVector& operator=(const SmallVector& other) {
+			if (this != &other) {
+				assign(other.begin(), other.end());
+			}
+			return *this;
+		}
+		SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+			if (this != &other) {
+				clear();
+				FreeHeap();
+				MoveFrom(other);
+			}
+			return *this;
+		}
+		SmallVector& operator=(std::initializer_list<T> values) {
+			assign(values.begin(), values.end());
+			return *this;
+		}
+
+		template<typename IteratorType>
+		void assign(IteratorType first, IteratorType last) {
+			clear();
+			reserve(static_cast<std::size_t>(std::distance(first, last)));
+			for (; first != last; ++first) {
+				::new(static_cast<void*>(m_pData + m_size)) T(*first);
+				++m_size;
+			}
+		}
+
+		template<typename... ArgTypes>
+		T& emplace_back(ArgTypes&&... args) {
+			if (m_size == m_capacity) {
+				return GrowAndEmplaceBack(std::forward<ArgTypes>(args)...);
+			}
+			T* pValue = ::new(static_cast<void*>(m_pData + m_size)) T(std::forward<ArgTypes>(args)...);
+			++m_size;
+			return *pValue;
+		}
+		void push_back(const T& value) { emplace_back(value); }
+		void push_back(T&& value) { emplace_back(std::move(value)); }
+
+		void pop_back() noexcept {
+			--m_size;
+			m_pData[m_size].~T();
+		}
+
+		void reserve(const std::size_t capacity);
+
+		void resize(const std::size_t size) {
+			reserve(size);
+			while (m_size > size) {
+				pop_back();
+			}
+			while (m_size < size) {
+				::new(static_cast<void*>(m_pData + m_size)) T();
+				++m_size;
+			}
+		}
+
+		void clear() noexcept {
+			while (m_size != 0) {
+				pop_back();
+			}
+		}
+
+		inline std::size_t size() const noexcept { return m_size; }
+		inline std::size_t capacity() const noexcept { return m_capacity; }
+		inline bool empty() const noexcept { return m_size == 0; }
+		inline bool IsInline() const noexcept { return m_pData == InlineData(); }
+		inline T* data() noexcept { return m_pData; }
+		inline const T* data() const noexcept { return m_pData; }
+		inline T* begin() noexcept { return m_pData; }
+		inline T* end() noexcept { return m_pData + m_size; }
+		inline const T* begin() const noexcept { return m_pData; }
+		inline const T* end() const noexcept { return m_pData + m_size; }
+		inline T& front() noexcept { return m_pData[0]; }
+		inline const T& front() const noexcept { return m_pData[0]; }
+		inline T& back() noexcept { return m_pData[m_size - 1]; }
+		inline const T& back() const noexcept { return m_pData[m_size - 1]; }
+		inline T& operator[](const std::size_t Idx) noexcept { return m_pData[Idx]; }
+		inline const T& operator[](const std::size_t Idx) const noexcept { return m_pData[Idx]; }
+
+		bool operator==(const SmallVector& other) const {
+			return m_size == other.m_size && std::equal(begin(), end(), other.begin());
+		}
+		bool operator!=(const SmallVector& other) const { return !(*this == other); }
+
+	private:
+		T* InlineData() noexcept { return reinterpret_cast<T*>(&m_inline); }
+		const T* InlineData() const noexcept { return reinterpret_cast<const T*>(&m_inline); }
+
+		void FreeHeap() noexcept {
+			if (!IsInline()) {
+				::operator delete(m_pData);
+			}
+			m_pData = InlineData();
+			m_capacity = N;
+		}
+
+		//the new element is built before the old buffer is released, args may refer into this vector
+		template<typename... ArgTypes>
+		T& GrowAndEmplaceBack(ArgTypes&&... args) {
+			const std::size_t Capacity = (std::max)(m_capacity * 2, std::size_t{ 4 });
+			T* pNewData = static_cast<T*>(::operator new(sizeof(T) * Capacity));
+			T* pValue = nullptr;
+			try {
+				pValue = ::new(static_cast<void*>(pNewData + m_size)) T(std::forward<ArgTypes>(args)...);
+				MoveElementsTo(pNewData);
+			} catch (...) {
+				if (pValue != nullptr) {
+					pValue->~T();
+				}
+				::operator delete(pNewData);
+				throw;
+			}
+			AdoptBuffer(pNewData, Capacity);
+			++m_size;
+			return *pValue;
+		}
+
+		//on an exception the already moved elements are destroyed again, pNewData stays allocated
+		void MoveElementsTo(T* pNewData) {
+			std::size_t moved = 0;
+			try {
+				for (; moved < m_size; ++moved) {
+					::new(static_cast<void*>(pNewData + moved)) T(std::move_if_noexcept(m_pData[moved]));
+				}
+			} catch (...) {
+				for (std::size_t i = 0; i < moved; ++i) {
+					pNewData[i].~T();
+				}
+				throw;
+			}
+		}
+
+		//pNewData already holds the moved elements
+		void AdoptBuffer(T* pNewData, const std::size_t capacity) noexcept {
+			const std::size_t Size = m_size;
+			clear();
+			FreeHeap();
+			m_pData = pNewData;
+			m_capacity = capacity;
+			m_size = Size;
+		}
+
+		//other is left empty
+		void MoveFrom(SmallVector& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+			if (other.IsInline()) {
+				for (std::size_t i = 0; i < other.m_size; ++i) {
+					::new(static_cast<void*>(m_pData + i)) T(std::move(other.m_pData[i]));
+				}
+				m_size = other.m_size;
+				other.clear();
+			} else {
+				m_pData = other.m_pData;
+				m_capacity = other.m_capacity;
+				m_size = other.m_size;
+				other.m_pData = other.InlineData();
+				other.m_capacity = N;
+				other.m_size = 0;
+			}
+		}
+
+		std::aligned_storage_t<sizeof(T) * (N == 0 ? 1 : N), alignof(T)> m_inline;
+		T* m_pData = InlineData();
+		std::size_t m_size = 0;
+		std::size_t m_capacity = N;
+	};
+
+
+	template<typename T, std::size_t N>
+	inline void SmallVector<T, N>::reserve(std::size_t capacity) {
+		if (capacity <= m_capacity) {
+			return;
+		}
+		capacity = (std::max)(capacity, std::size_t{ 4 });
+		T* pNewData = static_cast<T*>(::operator new(sizeof(T) * capacity));
+		try {
+			MoveElementsTo(pNewData);
+		} catch (...) {
+			::operator delete(pNewData);
+			throw;
+		}
+		AdoptBuffer(pNewData, capacity);
+	}
+
+
+	//found by nlohmann::json through ADL, generic so this header does not depend on the json lib
+	template<typename BasicJsonType, std::size_t N>
+	inline void to_json(BasicJsonType& jObj, const InlineString<N>& str) {
+		jObj = str.ToString();
+	}
+
+	template<typename BasicJsonType, std::size_t N>
+	inline void from_json(const BasicJsonType& jObj, InlineString<N>& str) {
+		const auto& JsonStr = jObj.template get_ref<const typename BasicJsonType::string_t&>();
+		str.assign(JsonStr.data(), JsonStr.size());
+	}
+
+	template<typename BasicJsonType, std::size_t N>
+	inline void to_json(BasicJsonType& jObj, const FixedString<N>& str) {
+		jObj = str.ToString();
+	}
+
+	template<typename BasicJsonType, std::size_t N>
+	inline void from_json(const BasicJsonType& jObj, FixedString<N>& str) {
+		const auto& JsonStr = jObj.template get_ref<const typename BasicJsonType::string_t&>();
+		str.assign(JsonStr.data(), JsonStr.size());
+	}
+
+	template<typename BasicJsonType, typename T, std::size_t N>
+	inline void to_json(BasicJsonType& jObj, const SmallVector<T, N>& vec) {
+		jObj = BasicJsonType::array();
+		for (const auto& entry : vec) {
+			jObj.push_back(entry);
+		}
+	}
+
+	template<typename BasicJsonType, typename T, std::size_t N>
+	inline void from_json(const BasicJsonType& jObj, SmallVector<T, N>& vec) {
+		vec.clear();
+		vec.reserve(jObj.size());
+		for (const auto& entry : jObj) {
+			vec.emplace_back(entry.template get<T>());
+		}
+	}
+}
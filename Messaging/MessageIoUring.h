@@ -0,0 +1,236 @@
+#pragma once
+#if defined(__linux__)
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "MessageHelpers.h"
+
+//io_uring on the raw syscalls, so neither liburing nor a recent libc is needed.
+//Only what the TCP transport uses : one submission and completion queue and registered buffers
+namespace messaging {
+namespace INTERNAL {
+
+	class IoUring final {
+	public:
+		explicit IoUring(const unsigned entries) {
+			io_uring_params params{};
+			m_fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+			if (m_fd < 0) {
+				ThrowErrno("io_uring_setup");
+			}
+			try {
+				MapRings(params);
+			} catch (const std::runtime_error&) {
+				Release();
+				throw;
+			}
+		}
+
+		~IoUring() noexcept { Release(); }
+
+		IoUring(const IoUring&) = delete;
+		IoUring& operator=(const IoUring&) = delete;
+
+		//io_uring can be compiled out or blocked by seccomp, the opcodes used here exist since linux 5.6.
+		//Without IORING_FEAT_FAST_POLL (5.7) operations on non blocking sockets fail with EAGAIN instead of waiting
+		static bool IsSupported() noexcept {
+			io_uring_params params{};
+			const int Fd = static_cast<int>(::syscall(__NR_io_uring_setup, 1, &params));
+			if (Fd < 0) {
+				return false;
+			}
+			const std::size_t ProbeSize = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+			std::vector<std::uint64_t> probeStorage(ProbeSize / sizeof(std::uint64_t) + 1);
+			auto* pProbe = reinterpret_cast<io_uring_probe*>(probeStorage.data());
+			const bool IsProbed = ::syscall(__NR_io_uring_register, Fd, IORING_REGISTER_PROBE, pProbe, 256) == 0;
+			::close(Fd);
+			const auto IsOpSupported = [pProbe](const unsigned op) {
+				return op <= pProbe->last_op && (pProbe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+			};
+			const bool IsFastPoll = (params.features & IORING_FEAT_FAST_POLL) != 0;
+			return IsProbed && IsFastPoll && IsOpSupported(IORING_OP_READ_FIXED) && IsOpSupported(IORING_OP_SENDMSG) && IsOpSupported(IORING_OP_RECV);
+		}
+
+		int GetFd() const noexcept { return m_fd; }
+
+		void RegisterBuffers(const iovec* pIovecs, const unsigned count) {
+			if (::syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_BUFFERS, pIovecs, count) != 0) {
+				ThrowErrno("io_uring_register");
+			}
+		}
+
+		//zeroed sqe in the submission queue, nullptr if the queue is full (Submit and ask again)
+		io_uring_sqe* GetSqe() noexcept {
+			if (m_sqTail - __atomic_load_n(m_pSqHead, __ATOMIC_ACQUIRE) >= m_sqEntries) {
+				return nullptr;
+			}
+			io_uring_sqe* pSqe = &m_pSqes[m_sqTail & m_sqMask];
+			std::memset(pSqe, 0, sizeof(io_uring_sqe));
+			++m_sqTail;
+			return pSqe;
+		}
+
+		//hands all queued sqes to the kernel with one syscall and waits for waitCount completions
+		void Submit(const unsigned waitCount = 0) {
+			__atomic_store_n(m_pSqTail, m_sqTail, __ATOMIC_RELEASE);
+			const unsigned ToSubmit = m_sqTail - __atomic_load_n(m_pSqHead, __ATOMIC_ACQUIRE);
+			if (ToSubmit == 0 && waitCount == 0) {
+				return;
+			}
+			const unsigned Flags = waitCount != 0 ? IORING_ENTER_GETEVENTS : 0;
+			while (::syscall(__NR_io_uring_enter, m_fd, ToSubmit, waitCount, Flags, nullptr, 0) < 0) {
+				//EBUSY/EAGAIN : the completion queue is full, the caller reaps and submits again
+				if (errno == EBUSY || errno == EAGAIN) {
+					return;
+				}
+				if (errno != EINTR) {
+					ThrowErrno("io_uring_enter");
+				}
+			}
+		}
+
+		//calls func(const io_uring_cqe&) for every completion, returns their number
+		template<typename FuncType>
+		unsigned ForEachCompletion(FuncType&& func) {
+			unsigned head = *m_pCqHead;
+			const unsigned Tail = __atomic_load_n(m_pCqTail, __ATOMIC_ACQUIRE);
+			const unsigned Count = Tail - head;
+			for (; head != Tail; ++head) {
+				const io_uring_cqe Cqe = m_pCqes[head & m_cqMask];
+				//the slot is handed back before func runs, func may submit again
+				__atomic_store_n(m_pCqHead, head + 1, __ATOMIC_RELEASE);
+				func(Cqe);
+			}
+			return Count;
+		}
+
+	private:
+		void MapRings(const io_uring_params& params) {
+			m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			const bool IsSingleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+			if (IsSingleMmap) {
+				m_sqRingSize = m_cqRingSize = (std::max)(m_sqRingSize, m_cqRingSize);
+			}
+			m_pSqRing = Map(m_sqRingSize, IORING_OFF_SQ_RING);
+			m_pCqRing = IsSingleMmap ? m_pSqRing : Map(m_cqRingSize, IORING_OFF_CQ_RING);
+			m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+			m_pSqes = static_cast<io_uring_sqe*>(Map(m_sqesSize, IORING_OFF_SQES));
+
+			Byte* pSq = static_cast<Byte*>(m_pSqRing);
+			m_pSqHead = reinterpret_cast<unsigned*>(pSq + params.sq_off.head);
+			m_pSqTail = reinterpret_cast<unsigned*>(pSq + params.sq_off.tail);
+			m_sqMask = *reinterpret_cast<unsigned*>(pSq + params.sq_off.ring_mask);
+			m_sqEntries = params.sq_entries;
+			Byte* pCq = static_cast<Byte*>(m_pCqRing);
+			m_pCqHead = reinterpret_cast<unsigned*>(pCq + params.cq_off.head);
+			m_pCqTail = reinterpret_cast<unsigned*>(pCq + params.cq_off.tail);
+			m_cqMask = *reinterpret_cast<unsigned*>(pCq + params.cq_off.ring_mask);
+			m_pCqes = reinterpret_cast<io_uring_cqe*>(pCq + params.cq_off.cqes);
+
+			//sqe i always sits in slot i, so the index array is filled once
+			unsigned* pArray = reinterpret_cast<unsigned*>(pSq + params.sq_off.array);
+			for (unsigned i = 0; i < m_sqEntries; ++i) {
+				pArray[i] = i;
+			}
+			m_sqTail = *m_pSqTail;
+		}
+
+		void Release() noexcept {
+			if (m_pSqes != nullptr) {
+				::munmap(m_pSqes, m_sqesSize);
+			}
+			if (m_pCqRing != nullptr && m_pCqRing != m_pSqRing) {
+				::munmap(m_pCqRing, m_cqRingSize);
+			}
+			if (m_pSqRing != nullptr) {
+				::munmap(m_pSqRing, m_sqRingSize);
+			}
+			::close(m_fd);
+		}
+
+		void* Map(const std::size_t size, const off_t offset) {
+			void* pMem = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, offset);
+			if (pMem == MAP_FAILED) {
+				ThrowErrno("io_uring mmap");
+			}
+			return pMem;
+		}
+
+		static void ThrowErrno(const char* pWhat) {
+			throw std::runtime_error(std::string(pWhat) + " failed : " + std::strerror(errno) + "!!!");
+		}
+
+		int m_fd = -1;
+		void* m_pSqRing = nullptr;
+		void* m_pCqRing = nullptr;
+		io_uring_sqe* m_pSqes = nullptr;
+		std::size_t m_sqRingSize = 0;
+		std::size_t m_cqRingSize = 0;
+		std::size_t m_sqesSize = 0;
+		unsigned* m_pSqHead = nullptr;
+		unsigned* m_pSqTail = nullptr;
+		unsigned m_sqMask = 0;
+		unsigned m_sqEntries = 0;
+		unsigned m_sqTail = 0;
+		unsigned* m_pCqHead = nullptr;
+		unsigned* m_pCqTail = nullptr;
+		unsigned m_cqMask = 0;
+		io_uring_cqe* m_pCqes = nullptr;
+	};
+
+
+	//count buffers of size bytes in one page aligned mapping, can be registered with the ring as a single fixed buffer
+	class FixedBufferPool final {
+	public:
+		FixedBufferPool(const std::size_t count, const std::size_t size) : m_bufferSize(size), m_size(count * size) {
+			m_pMemory = static_cast<Byte*>(::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+			if (m_pMemory == MAP_FAILED) {
+				throw std::runtime_error("mmap of the fixed buffers failed!!!");
+			}
+			m_free.reserve(count);
+			for (std::size_t i = count; i != 0; --i) {
+				m_free.push_back(static_cast<int>(i - 1));
+			}
+		}
+
+		~FixedBufferPool() noexcept { ::munmap(m_pMemory, m_size); }
+
+		FixedBufferPool(const FixedBufferPool&) = delete;
+		FixedBufferPool& operator=(const FixedBufferPool&) = delete;
+
+		iovec GetIovec() const noexcept { return iovec{ m_pMemory, m_size }; }
+		std::size_t GetBufferSize() const noexcept { return m_bufferSize; }
+		Byte* Get(const int index) const noexcept { return m_pMemory + static_cast<std::size_t>(index) * m_bufferSize; }
+
+		//-1 if all buffers are in use
+		int Acquire() noexcept {
+			if (m_free.empty()) {
+				return -1;
+			}
+			const int Index = m_free.back();
+			m_free.pop_back();
+			return Index;
+		}
+
+		void Release(const int index) noexcept { m_free.push_back(index); }
+
+	private:
+		Byte* m_pMemory;
+		std::size_t m_bufferSize;
+		std::size_t m_size;
+		std::vector<int> m_free;
+	};
+}//namespace INTERNAL
+}//namespace messaging
+#endif
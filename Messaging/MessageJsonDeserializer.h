@@ -16,18 +16,21 @@ public:
 	template<typename DerivedType, typename... FieldTypes>
 	void Deserialize(BasicMessage<DerivedType, FieldTypes...>& msg, const nlohmann::json& jObj) {
 		m_curJson = &jObj;
-		msg.ForEachField([this](auto& field, auto Idx) {
-			if (IsValidField(Idx)) {
-				DeserializeOne(DerivedType::FieldNameStrings[Idx].data(), field);
-			}
-		});
+		DeserializePart(msg, 0);
+	}
+
+	template<typename... MessageTypes>
+	void Deserialize(CombinedMessage<MessageTypes...>& msg, const nlohmann::json& jObj) {
+		m_curJson = &jObj;
+		std::size_t fieldOffset = 0;
+		(void)std::initializer_list<int>{(fieldOffset += DeserializePart(static_cast<MessageTypes&>(msg), fieldOffset), 0)...};
 	}
 
 	template<typename T,
-		std::enable_if_t<std::is_base_of<IMessage, RemoveCVREF<T>>::value, bool> Dummy = false, 
+		std::enable_if_t<IsMessageField<T>, bool> Dummy = false, 
 	typename FieldStr, std::size_t N>
 	void DeserializeOne(const FieldStr& str, std::array<T, N>& msgContainer) {
-		auto nestJsonObj = (*m_curJson)[str].get<std::array<nlohmann::json, N>>();
+		auto nestJsonObj = (*m_curJson)[str].template get<std::array<nlohmann::json, N>>();
 		std::size_t nestObjIdx = 0;
 		for (auto& msg : msgContainer) {
 			JsonDeserializer ser;
@@ -36,10 +39,10 @@ public:
 	}
 
 	template<typename T,
-		std::enable_if_t<std::is_base_of<IMessage, RemoveCVREF<T>>::value, bool> Dummy = false, 
-	typename FieldStr>
-	void DeserializeOne(const FieldStr& str, std::vector<T>& msgContainer) {
-		auto nestJsonObj = (*m_curJson)[str].get<std::vector<nlohmann::json>>();
+		std::enable_if_t<IsMessageField<T>, bool> Dummy = false, 
+	typename FieldStr, typename AllocatorType>
+	void DeserializeOne(const FieldStr& str, std::vector<T, AllocatorType>& msgContainer) {
+		auto nestJsonObj = (*m_curJson)[str].template get<std::vector<nlohmann::json>>();
 		msgContainer.resize(nestJsonObj.size());
 		std::size_t nestObjIdx = 0;
 		for (auto& msg : msgContainer) {
@@ -57,13 +60,23 @@ public:
 	
 
 	template<typename T, 
-		std::enable_if_t<(!std::is_base_of<IMessage, INTERNAL::RemoveCVREF<T>>::value) && (!IsContainerWithMessages<T>), bool> Dummy = false, typename FieldStr>
+		std::enable_if_t<(!INTERNAL::IsMessageField<T>) && (!IsContainerWithMessages<T>), bool> Dummy = false, typename FieldStr>
 	void DeserializeOne(const FieldStr& str, T& field) {
-		field = (*m_curJson)[str].get<INTERNAL::RemoveCVREF<T>>();
+		field = (*m_curJson)[str].template get<INTERNAL::RemoveCVREF<T>>();
 	}
 
 
 private:
+	template<typename DerivedType, typename... FieldTypes>
+	std::size_t DeserializePart(BasicMessage<DerivedType, FieldTypes...>& msg, const std::size_t FieldOffset) {
+		msg.ForEachField([this, FieldOffset](auto& field, auto Idx) {
+			if (IsValidField(FieldOffset + Idx)) {
+				DeserializeOne(DerivedType::FieldNameStrings[Idx].data(), field);
+			}
+		});
+		return sizeof...(FieldTypes);
+	}
+
 	const nlohmann::json* m_curJson;
 
 };
@@ -0,0 +1,144 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <thread>
+#include <exception>
+#include <algorithm>
+#include <iterator>
+#include "FileUtils.h"
+#include "MessageJsonSerializer.h"
+#include "MessageJsonDeserializer.h"
+
+namespace messaging {
+namespace INTERNAL {
+
+	struct JsonLinesChunk {
+		const char* pBegin = nullptr;
+		const char* pEnd = nullptr;
+	};
+
+	//splits the buffer into roughly equal chunks, every chunk ends directly behind a '\n'
+	inline std::vector<JsonLinesChunk> SplitJsonLines(const char* pData, const std::size_t len, std::size_t chunkCount) {
+		std::vector<JsonLinesChunk> chunks;
+		if (pData == nullptr || len == 0) {
+			return chunks;
+		}
+		chunkCount = (std::max)(chunkCount, std::size_t{ 1 });
+		chunks.reserve(chunkCount);
+		const char* const pEnd = pData + len;
+		const std::size_t ChunkSize = (len + chunkCount - 1) / chunkCount;
+		const char* pCur = pData;
+		while (pCur < pEnd) {
+			const char* pSplit = pCur + (std::min)(ChunkSize, static_cast<std::size_t>(pEnd - pCur));
+			pSplit = std::find(pSplit, pEnd, '\n');
+			if (pSplit != pEnd) {
+				++pSplit;
+			}
+			chunks.push_back(JsonLinesChunk{ pCur, pSplit });
+			pCur = pSplit;
+		}
+		return chunks;
+	}
+
+	template<typename MessageType>
+	void DeserializeJsonLinesChunk(const JsonLinesChunk& chunk, std::vector<MessageType>& outMessages,
+		const std::vector<std::size_t>& NonSerializeableFields) {
+		const char* pLine = chunk.pBegin;
+		while (pLine < chunk.pEnd) {
+			const char* pLineEnd = std::find(pLine, chunk.pEnd, '\n');
+			const char* pNext = (pLineEnd == chunk.pEnd) ? pLineEnd : pLineEnd + 1;
+			if (pLineEnd != pLine && *(pLineEnd - 1) == '\r') {
+				--pLineEnd;
+			}
+			if (pLineEnd != pLine) {
+				try {
+					const nlohmann::json jObj = nlohmann::json::parse(pLine, pLineEnd);
+					JsonDeserializer ser;
+					ser.SetNonSerializeableFields(NonSerializeableFields);
+					outMessages.emplace_back();
+					ser.Deserialize(outMessages.back(), jObj);
+				} catch (const nlohmann::json::parse_error& ex) {
+					throw json_serilization::JsonSerilizationException(ex.what());
+				}
+			}
+			pLine = pNext;
+		}
+	}
+}//namespace INTERNAL
+
+namespace json_serilization {
+	//JSON Lines : one compact json object per line, see http://jsonlines.org
+	template<typename MessageType>
+	inline std::string SerializeLines(const std::vector<MessageType>& messages,
+		const std::vector<std::size_t>& NonSerializeableFields = std::vector<std::size_t>{}) {
+		std::string result;
+		for (const auto& msg : messages) {
+			INTERNAL::JsonSerializer ser;
+			ser.SetNonSerializeableFields(NonSerializeableFields);
+			result += ser.Serialize(msg).dump();
+			result += '\n';
+		}
+		return result;
+	}
+
+	//parses the lines on up to threadCount worker threads (0 = hardware concurrency),
+	//every worker fills its own vector which are concatenated in file order afterwards
+	template<typename MessageType>
+	inline void DeserializeLines(std::vector<MessageType>& outMessages, const char* pData, const std::size_t len,
+		std::size_t threadCount = 0,
+		const std::vector<std::size_t>& NonSerializeableFields = std::vector<std::size_t>{}) {
+		if (threadCount == 0) {
+			threadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+		}
+		const auto chunks = INTERNAL::SplitJsonLines(pData, len, threadCount);
+		std::vector<std::vector<MessageType>> chunkMessages(chunks.size());
+		std::vector<std::exception_ptr> chunkErrors(chunks.size());
+		std::vector<std::thread> workers;
+		workers.reserve(chunks.size());
+		for (std::size_t i = 0; i < chunks.size(); ++i) {
+			workers.emplace_back([&, i]() {
+				try {
+					INTERNAL::DeserializeJsonLinesChunk(chunks[i], chunkMessages[i], NonSerializeableFields);
+				} catch (...) {
+					chunkErrors[i] = std::current_exception();
+				}
+			});
+		}
+		for (auto& worker : workers) {
+			worker.join();
+		}
+		for (const auto& error : chunkErrors) {
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+		std::size_t totalCount = outMessages.size();
+		for (const auto& messages : chunkMessages) {
+			totalCount += messages.size();
+		}
+		outMessages.reserve(totalCount);
+		for (auto& messages : chunkMessages) {
+			std::move(messages.begin(), messages.end(), std::back_inserter(outMessages));
+		}
+	}
+
+	template<typename MessageType>
+	inline void DeserializeLines(std::vector<MessageType>& outMessages, const std::string& jsonLines,
+		std::size_t threadCount = 0,
+		const std::vector<std::size_t>& NonSerializeableFields = std::vector<std::size_t>{}) {
+		DeserializeLines(outMessages, jsonLines.data(), jsonLines.size(), threadCount, NonSerializeableFields);
+	}
+
+	template<typename MessageType>
+	inline bool DeserializeLinesFromFile(std::vector<MessageType>& outMessages, const char* fileName,
+		std::size_t threadCount = 0,
+		const std::vector<std::size_t>& NonSerializeableFields = std::vector<std::size_t>{}) {
+		const file_utils::MappedFile file(fileName, file_utils::MapAccessHint::eSEQUENTIAL);
+		if (!file.IsOpen()) {
+			return false;
+		}
+		DeserializeLines(outMessages, file.Data(), file.Size(), threadCount, NonSerializeableFields);
+		return true;
+	}
+}//namespace json_serilization
+}//namespace messaging
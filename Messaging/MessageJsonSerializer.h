@@ -15,11 +15,16 @@ public:
 
 	template<typename DerivedType, typename... FieldTypes>
 	nlohmann::json& Serialize(const BasicMessage<DerivedType, FieldTypes...>& msg) {
-		msg.ForEachField([this](const auto& field, auto Idx) {
-			if (IsValidField(Idx)) {
-				SerializeOne(DerivedType::FieldNameStrings[Idx].data(), field);
-			}
-		});
+		SerializePart(msg, 0);
+		return m_curJson;
+	}
+
+	//the fields of all base messages end up in one json object,
+	//NonSerializeableFields are counted like the CombinedMessage field indices
+	template<typename... MessageTypes>
+	nlohmann::json& Serialize(const CombinedMessage<MessageTypes...>& msg) {
+		std::size_t fieldOffset = 0;
+		(void)std::initializer_list<int>{(fieldOffset += SerializePart(static_cast<const MessageTypes&>(msg), fieldOffset), 0)...};
 		return m_curJson;
 	}
 
@@ -44,7 +49,7 @@ public:
 	
 
 	template<typename T, 
-		std::enable_if_t<(!std::is_base_of<IMessage, INTERNAL::RemoveCVREF<T>>::value) 
+		std::enable_if_t<(!INTERNAL::IsMessageField<T>) 
 		&& (!IsContainerWithMessages<T>), bool> Dummy = false, typename FieldStr>
 	void SerializeOne(const FieldStr& str, const T& field) {
 		m_curJson[str] = field;
@@ -52,6 +57,16 @@ public:
 
 
 private:
+	template<typename DerivedType, typename... FieldTypes>
+	std::size_t SerializePart(const BasicMessage<DerivedType, FieldTypes...>& msg, const std::size_t FieldOffset) {
+		msg.ForEachField([this, FieldOffset](const auto& field, auto Idx) {
+			if (IsValidField(FieldOffset + Idx)) {
+				SerializeOne(DerivedType::FieldNameStrings[Idx].data(), field);
+			}
+		});
+		return sizeof...(FieldTypes);
+	}
+
 	nlohmann::json m_curJson;
 };
 }
@@ -1,12 +1,17 @@
 #pragma once
 #include <vector>
 #include <algorithm>
+#include <exception>
+#include <string>
 
 namespace messaging {
 	namespace json_serilization {
 		class JsonSerilizationException final : public std::exception {
 		public:
-			explicit JsonSerilizationException(const char* const str) : std::exception(str) {}
+			explicit JsonSerilizationException(const char* const str) : m_message(str) {}
+			virtual const char* what() const noexcept override { return m_message.c_str(); }
+		private:
+			std::string m_message;
 		};
 	}
 namespace INTERNAL {
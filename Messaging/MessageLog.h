@@ -0,0 +1,510 @@
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "FileUtils.h"
+#include "MessageBinarySerializer.h"
+#include "MessageBinaryDeserializer.h"
+#include "../utils/Crc32.h"
+
+//Segmented append only log of binary serialized messages.
+//
+//<basePath>.000000.log, <basePath>.000001.log, ... hold the records:
+//	segment header : uint32 magic, uint32 version, uint64 index of the first record in this segment
+//	record         : uint32 payload size, uint32 message type id, uint32 crc32 over type id + payload, payload
+//<basePath>.000000.idx, ... hold a sparse index, one entry every IndexInterval records:
+//	entry          : uint64 record index, uint64 file offset of the record inside the .log segment
+//A writer continues the last segment while it is below MaxSegmentSize, a torn tail is cut off first.
+namespace messaging {
+
+	struct MessageLogOptions {
+		std::size_t MaxSegmentSize = 64 * 1024 * 1024;
+		std::uint32_t IndexInterval = 64;
+		//group commit : pending records are written and synced together once one of the limits is reached
+		std::size_t GroupCommitBytes = 1024 * 1024;
+		std::size_t GroupCommitRecords = 256;
+		bool SyncOnFlush = true;
+	};
+
+
+	struct MessageLogRecord {
+		std::uint64_t Index = 0;
+		std::uint32_t TypeId = 0;
+		const Byte* pPayload = nullptr;
+		std::uint32_t PayloadSize = 0;
+
+		template<typename MessageType>
+		bool Is() const noexcept { return TypeId == MessageTypeId<MessageType>; }
+
+		template<typename MessageType>
+		bool DeserializeTo(MessageType& msg) const {
+			if (!Is<MessageType>()) {
+				return false;
+			}
+			binary_serilization::Deserialize(msg, pPayload, static_cast<std::int32_t>(PayloadSize));
+			return true;
+		}
+	};
+
+namespace INTERNAL {
+	static constexpr std::uint32_t MessageLogMagic = 0x474C4D52; // "RMLG"
+	static constexpr std::uint32_t MessageLogVersion = 1;
+	static constexpr std::size_t MessageLogSegmentHeaderSize = sizeof(std::uint32_t) * 2 + sizeof(std::uint64_t);
+	static constexpr std::size_t MessageLogRecordHeaderSize = sizeof(std::uint32_t) * 3;
+	static constexpr std::size_t MessageLogIndexEntrySize = sizeof(std::uint64_t) * 2;
+
+	inline std::string MessageLogSegmentName(const std::string& basePath, const std::uint32_t segment, const char* extension) {
+		char suffix[32] = {};
+		::snprintf(suffix, sizeof(suffix), ".%06u.%s", segment, extension);
+		return basePath + suffix;
+	}
+
+	inline bool MessageLogSegmentExists(const std::string& basePath, const std::uint32_t segment) {
+		FILE* file = ::fopen(MessageLogSegmentName(basePath, segment, "log").c_str(), "rb");
+		if (file == nullptr) {
+			return false;
+		}
+		::fclose(file);
+		return true;
+	}
+
+	inline std::uint32_t MessageLogChecksum(const std::uint32_t typeId, const void* pPayload, const std::size_t len) noexcept {
+		return utils::Crc32(pPayload, len, utils::Crc32(&typeId, sizeof(typeId)));
+	}
+
+	//returns the offset behind the record or 0 if there is no complete and valid record at offset
+	inline std::size_t ReadMessageLogRecord(const char* pData, const std::size_t size, const std::size_t offset,
+		MessageLogRecord& outRecord) noexcept {
+		if (offset + MessageLogRecordHeaderSize > size) {
+			return 0;
+		}
+		const auto PayloadSize = ReadPod<std::uint32_t>(pData + offset);
+		const auto TypeId = ReadPod<std::uint32_t>(pData + offset + sizeof(std::uint32_t));
+		const auto Crc = ReadPod<std::uint32_t>(pData + offset + sizeof(std::uint32_t) * 2);
+		const std::size_t PayloadOffset = offset + MessageLogRecordHeaderSize;
+		if (PayloadSize > size - PayloadOffset) {
+			return 0;
+		}
+		if (MessageLogChecksum(TypeId, pData + PayloadOffset, PayloadSize) != Crc) {
+			return 0;
+		}
+		outRecord.TypeId = TypeId;
+		outRecord.PayloadSize = PayloadSize;
+		outRecord.pPayload = reinterpret_cast<const Byte*>(pData + PayloadOffset);
+		return PayloadOffset + PayloadSize;
+	}
+}//namespace INTERNAL
+
+
+	//snapshot of the log at the time Open was called, segments are replayed straight from the page cache
+	class MessageLogReader final {
+	public:
+		MessageLogReader() = default;
+		explicit MessageLogReader(const std::string& basePath) { Open(basePath); }
+
+		MessageLogReader(const MessageLogReader&) = delete;
+		MessageLogReader& operator=(const MessageLogReader&) = delete;
+		MessageLogReader(MessageLogReader&&) = default;
+		MessageLogReader& operator=(MessageLogReader&&) = default;
+
+		bool Open(const std::string& basePath);
+
+		inline std::uint64_t GetRecordCount() const noexcept {
+			return m_segments.empty() ? 0 : m_segments.back().FirstIndex + m_segments.back().RecordCount;
+		}
+		inline std::uint32_t GetSegmentCount() const noexcept { return static_cast<std::uint32_t>(m_segments.size()); }
+
+		//O(log n) : binary search over the segments and their sparse index, then at most IndexInterval records are skipped
+		bool ReadRecord(const std::uint64_t index, MessageLogRecord& outRecord) const;
+
+		template<typename MessageType>
+		bool ReadMessage(const std::uint64_t index, MessageType& outMsg) const {
+			MessageLogRecord record;
+			return ReadRecord(index, record) && record.DeserializeTo(outMsg);
+		}
+
+		//calls pred(const MessageLogRecord&) for every record starting at fromIndex in log order
+		template<typename PredType>
+		void Replay(PredType&& pred, const std::uint64_t fromIndex = 0) const;
+
+	private:
+		friend class MessageLogWriter;
+
+		struct Segment {
+			file_utils::MappedFile Log;
+			file_utils::MappedFile Index;
+			std::uint64_t FirstIndex = 0;
+			std::uint64_t RecordCount = 0;
+			//end of the last valid record and the index entries in front of the first invalid one
+			std::size_t ValidLogSize = 0;
+			std::size_t ValidIndexEntries = 0;
+		};
+
+		//returns the offset of the record with the given index inside the segment
+		std::size_t FindRecordOffset(const Segment& segment, const std::uint64_t index) const;
+		void CountRecords(Segment& segment) const;
+
+		std::vector<Segment> m_segments;
+	};
+
+
+	class MessageLogWriter final {
+	public:
+		explicit MessageLogWriter(const std::string& basePath, const MessageLogOptions& options = MessageLogOptions{});
+		~MessageLogWriter() noexcept;
+
+		MessageLogWriter(const MessageLogWriter&) = delete;
+		MessageLogWriter& operator=(const MessageLogWriter&) = delete;
+
+		//returns the index of the appended record, the record is durable after the next Flush
+		template<typename DerivedType, typename... MessageTypes>
+		std::uint64_t Append(const BasicMessage<DerivedType, MessageTypes...>& message);
+
+		void Flush();
+
+		inline std::uint64_t GetRecordCount() const noexcept { return m_nextIndex; }
+
+	private:
+		void OpenSegment();
+		//reopens the last segment of an existing log, everything behind the valid records is cut off
+		void ContinueSegment(const std::size_t validLogSize, const std::size_t validIndexEntries);
+		void CloseSegment();
+		void SyncFile(FILE* pFile, const char* pWhat);
+		//cuts both files back to the state before a failed Flush
+		void RollBackFlush(const long indexSize) noexcept;
+
+		std::string m_basePath;
+		MessageLogOptions m_options;
+		FILE* m_pLogFile = nullptr;
+		FILE* m_pIndexFile = nullptr;
+		std::uint32_t m_segmentNumber = 0;
+		std::uint64_t m_nextIndex = 0;
+		std::uint64_t m_segmentRecordCount = 0;
+		std::size_t m_segmentSize = 0;
+		std::size_t m_pendingRecords = 0;
+		std::vector<Byte> m_pendingLog;
+		std::vector<Byte> m_pendingIndex;
+	};
+}
+
+
+inline bool messaging::MessageLogReader::Open(const std::string& basePath) {
+	m_segments.clear();
+	for (std::uint32_t segmentNumber = 0; ; ++segmentNumber) {
+		Segment segment;
+		const std::string LogName = INTERNAL::MessageLogSegmentName(basePath, segmentNumber, "log");
+		if (!segment.Log.Open(LogName.c_str(), file_utils::MapAccessHint::eSEQUENTIAL)) {
+			break;
+		}
+		//a crash right after the last segment was created can leave it without a complete header, it holds no records
+		if (segment.Log.Size() < INTERNAL::MessageLogSegmentHeaderSize && !INTERNAL::MessageLogSegmentExists(basePath, segmentNumber + 1)) {
+			break;
+		}
+		if (segment.Log.Size() < INTERNAL::MessageLogSegmentHeaderSize ||
+			INTERNAL::ReadPod<std::uint32_t>(segment.Log.Data()) != INTERNAL::MessageLogMagic ||
+			INTERNAL::ReadPod<std::uint32_t>(segment.Log.Data() + sizeof(std::uint32_t)) != INTERNAL::MessageLogVersion) {
+			throw std::runtime_error{ "invalid message log segment " + LogName + "!!!" };
+		}
+		segment.FirstIndex = INTERNAL::ReadPod<std::uint64_t>(segment.Log.Data() + sizeof(std::uint32_t) * 2);
+		if (segment.FirstIndex != GetRecordCount()) {
+			throw std::runtime_error{ "message log segment " + LogName + " does not continue the previous segment!!!" };
+		}
+		const std::string IndexName = INTERNAL::MessageLogSegmentName(basePath, segmentNumber, "idx");
+		segment.Index.Open(IndexName.c_str(), file_utils::MapAccessHint::eRANDOM);
+		CountRecords(segment);
+		m_segments.emplace_back(std::move(segment));
+	}
+	return !m_segments.empty();
+}
+
+
+inline bool messaging::MessageLogReader::ReadRecord(const std::uint64_t index, MessageLogRecord& outRecord) const {
+	if (index >= GetRecordCount()) {
+		return false;
+	}
+	const auto it = std::upper_bound(m_segments.cbegin(), m_segments.cend(), index,
+		[](const std::uint64_t idx, const Segment& segment) { return idx < segment.FirstIndex; }) - 1;
+	const std::size_t Offset = FindRecordOffset(*it, index);
+	if (INTERNAL::ReadMessageLogRecord(it->Log.Data(), it->Log.Size(), Offset, outRecord) == 0) {
+		return false;
+	}
+	outRecord.Index = index;
+	return true;
+}
+
+
+template<typename PredType>
+inline void messaging::MessageLogReader::Replay(PredType&& pred, const std::uint64_t fromIndex) const {
+	MessageLogRecord record;
+	for (const auto& segment : m_segments) {
+		const std::uint64_t SegmentEnd = segment.FirstIndex + segment.RecordCount;
+		if (SegmentEnd <= fromIndex) {
+			continue;
+		}
+		std::uint64_t index = (std::max)(fromIndex, segment.FirstIndex);
+		std::size_t offset = FindRecordOffset(segment, index);
+		for (; index < SegmentEnd; ++index) {
+			offset = INTERNAL::ReadMessageLogRecord(segment.Log.Data(), segment.Log.Size(), offset, record);
+			record.Index = index;
+			pred(static_cast<const MessageLogRecord&>(record));
+		}
+	}
+}
+
+
+inline std::size_t messaging::MessageLogReader::FindRecordOffset(const Segment& segment, const std::uint64_t index) const {
+	std::uint64_t currentIndex = segment.FirstIndex;
+	std::size_t offset = INTERNAL::MessageLogSegmentHeaderSize;
+	const std::size_t EntryCount = segment.Index.Size() / INTERNAL::MessageLogIndexEntrySize;
+	std::size_t low = 0;
+	std::size_t high = EntryCount;
+	while (low < high) {
+		const std::size_t Mid = low + (high - low) / 2;
+		const char* pEntry = segment.Index.Data() + Mid * INTERNAL::MessageLogIndexEntrySize;
+		const auto EntryIndex = INTERNAL::ReadPod<std::uint64_t>(pEntry);
+		if (EntryIndex <= index) {
+			const auto EntryOffset = INTERNAL::ReadPod<std::uint64_t>(pEntry + sizeof(std::uint64_t));
+			//entries that point behind the valid records (torn write) are ignored
+			if (EntryIndex < segment.FirstIndex + segment.RecordCount && EntryOffset < segment.Log.Size()) {
+				currentIndex = EntryIndex;
+				offset = static_cast<std::size_t>(EntryOffset);
+			}
+			low = Mid + 1;
+		} else {
+			high = Mid;
+		}
+	}
+	MessageLogRecord record;
+	for (; currentIndex < index; ++currentIndex) {
+		offset = INTERNAL::ReadMessageLogRecord(segment.Log.Data(), segment.Log.Size(), offset, record);
+	}
+	return offset;
+}
+
+
+inline void messaging::MessageLogReader::CountRecords(Segment& segment) const {
+	std::size_t offset = INTERNAL::MessageLogSegmentHeaderSize;
+	std::uint64_t count = 0;
+	//start at the last index entry that still points at a valid record, then scan the tail
+	const std::size_t EntryCount = segment.Index.Size() / INTERNAL::MessageLogIndexEntrySize;
+	MessageLogRecord record;
+	for (std::size_t i = EntryCount; i-- > 0;) {
+		const char* pEntry = segment.Index.Data() + i * INTERNAL::MessageLogIndexEntrySize;
+		const auto EntryIndex = INTERNAL::ReadPod<std::uint64_t>(pEntry);
+		const auto EntryOffset = INTERNAL::ReadPod<std::uint64_t>(pEntry + sizeof(std::uint64_t));
+		if (EntryIndex >= segment.FirstIndex && EntryOffset < segment.Log.Size() &&
+			INTERNAL::ReadMessageLogRecord(segment.Log.Data(), segment.Log.Size(), static_cast<std::size_t>(EntryOffset), record) != 0) {
+			offset = static_cast<std::size_t>(EntryOffset);
+			count = EntryIndex - segment.FirstIndex;
+			break;
+		}
+	}
+	while (std::size_t next = INTERNAL::ReadMessageLogRecord(segment.Log.Data(), segment.Log.Size(), offset, record)) {
+		offset = next;
+		++count;
+	}
+	segment.RecordCount = count;
+	segment.ValidLogSize = offset;
+	std::size_t validEntries = 0;
+	for (; validEntries < EntryCount; ++validEntries) {
+		const char* pEntry = segment.Index.Data() + validEntries * INTERNAL::MessageLogIndexEntrySize;
+		const auto EntryIndex = INTERNAL::ReadPod<std::uint64_t>(pEntry);
+		const auto EntryOffset = INTERNAL::ReadPod<std::uint64_t>(pEntry + sizeof(std::uint64_t));
+		if (EntryIndex < segment.FirstIndex || EntryIndex >= segment.FirstIndex + count || EntryOffset >= offset) {
+			break;
+		}
+	}
+	segment.ValidIndexEntries = validEntries;
+}
+
+
+inline messaging::MessageLogWriter::MessageLogWriter(const std::string& basePath, const MessageLogOptions& options)
+	: m_basePath(basePath)
+	, m_options(options) {
+	if (m_options.IndexInterval == 0) {
+		m_options.IndexInterval = 1;
+	}
+	bool isContinued = false;
+	std::size_t validLogSize = 0;
+	std::size_t validIndexEntries = 0;
+	{
+		//the reader has to be closed before the segment is truncated, mapped files can't be truncated on windows
+		const MessageLogReader Existing(basePath);
+		m_segmentNumber = Existing.GetSegmentCount();
+		m_nextIndex = Existing.GetRecordCount();
+		if (!Existing.m_segments.empty() && Existing.m_segments.back().ValidLogSize < m_options.MaxSegmentSize) {
+			const auto& Last = Existing.m_segments.back();
+			isContinued = true;
+			--m_segmentNumber;
+			m_segmentRecordCount = Last.RecordCount;
+			validLogSize = Last.ValidLogSize;
+			validIndexEntries = Last.ValidIndexEntries;
+		}
+	}
+	if (isContinued) {
+		ContinueSegment(validLogSize, validIndexEntries);
+	} else {
+		OpenSegment();
+	}
+}
+
+
+inline messaging::MessageLogWriter::~MessageLogWriter() noexcept {
+	try {
+		CloseSegment();
+	} catch (...) {
+	}
+}
+
+
+template<typename DerivedType, typename... MessageTypes>
+inline std::uint64_t messaging::MessageLogWriter::Append(const BasicMessage<DerivedType, MessageTypes...>& message) {
+	const std::size_t PayloadSize = message.GetMessageSize();
+	const std::size_t RecordSize = INTERNAL::MessageLogRecordHeaderSize + PayloadSize;
+	if (m_segmentRecordCount != 0 && m_segmentSize + m_pendingLog.size() + RecordSize > m_options.MaxSegmentSize) {
+		CloseSegment();
+		++m_segmentNumber;
+		OpenSegment();
+	}
+	if (m_segmentRecordCount % m_options.IndexInterval == 0) {
+		INTERNAL::AppendPod(m_pendingIndex, m_nextIndex);
+		INTERNAL::AppendPod(m_pendingIndex, static_cast<std::uint64_t>(m_segmentSize + m_pendingLog.size()));
+	}
+	const std::size_t RecordOffset = m_pendingLog.size();
+	m_pendingLog.resize(RecordOffset + RecordSize);
+	Byte* pPayload = m_pendingLog.data() + RecordOffset + INTERNAL::MessageLogRecordHeaderSize;
+	if (binary_serilization::Serialize(message, pPayload) > PayloadSize) {
+		throw std::runtime_error("FATAL ERROR !!! ACCESS VIOLATION!!!");
+	}
+	const auto Size32 = static_cast<std::uint32_t>(PayloadSize);
+	const std::uint32_t TypeId = MessageTypeId<DerivedType>;
+	const std::uint32_t Crc = INTERNAL::MessageLogChecksum(TypeId, pPayload, PayloadSize);
+	Byte* pHeader = m_pendingLog.data() + RecordOffset;
+	std::memcpy(pHeader, &Size32, sizeof(Size32));
+	std::memcpy(pHeader + sizeof(std::uint32_t), &TypeId, sizeof(TypeId));
+	std::memcpy(pHeader + sizeof(std::uint32_t) * 2, &Crc, sizeof(Crc));
+
+	++m_segmentRecordCount;
+	++m_pendingRecords;
+	if (m_pendingRecords >= m_options.GroupCommitRecords || m_pendingLog.size() >= m_options.GroupCommitBytes) {
+		Flush();
+	}
+	return m_nextIndex++;
+}
+
+
+inline void messaging::MessageLogWriter::Flush() {
+	if (m_pendingRecords == 0) {
+		return;
+	}
+	if (m_pLogFile == nullptr || m_pIndexFile == nullptr) {
+		throw std::runtime_error{ "message log segment " + std::to_string(m_segmentNumber) + " was closed after a failed write!!!" };
+	}
+	//all or nothing : on failure the files are cut back and the pending records are written again by the next Flush
+	const long IndexSize = ::ftell(m_pIndexFile);
+	if (IndexSize < 0) {
+		throw std::runtime_error{ "failed to write message log index " + std::to_string(m_segmentNumber) + "!!!" };
+	}
+	try {
+		//the records have to be durable before the index may point at them
+		if (::fwrite(m_pendingLog.data(), m_pendingLog.size(), 1, m_pLogFile) != 1) {
+			throw std::runtime_error{ "failed to write message log segment " + std::to_string(m_segmentNumber) + "!!!" };
+		}
+		SyncFile(m_pLogFile, "failed to sync message log segment ");
+		if (!m_pendingIndex.empty()) {
+			if (::fwrite(m_pendingIndex.data(), m_pendingIndex.size(), 1, m_pIndexFile) != 1) {
+				throw std::runtime_error{ "failed to write message log index " + std::to_string(m_segmentNumber) + "!!!" };
+			}
+			SyncFile(m_pIndexFile, "failed to sync message log index ");
+		}
+	} catch (...) {
+		RollBackFlush(IndexSize);
+		throw;
+	}
+	m_segmentSize += m_pendingLog.size();
+	m_pendingLog.clear();
+	m_pendingIndex.clear();
+	m_pendingRecords = 0;
+}
+
+
+inline void messaging::MessageLogWriter::OpenSegment() {
+	const std::string LogName = INTERNAL::MessageLogSegmentName(m_basePath, m_segmentNumber, "log");
+	const std::string IndexName = INTERNAL::MessageLogSegmentName(m_basePath, m_segmentNumber, "idx");
+	m_pLogFile = ::fopen(LogName.c_str(), "wb");
+	m_pIndexFile = ::fopen(IndexName.c_str(), "wb");
+	if (m_pLogFile == nullptr || m_pIndexFile == nullptr) {
+		CloseSegment();
+		throw std::runtime_error{ "could not create message log segment " + LogName + "!!!" };
+	}
+	std::vector<Byte> header;
+	INTERNAL::AppendPod(header, INTERNAL::MessageLogMagic);
+	INTERNAL::AppendPod(header, INTERNAL::MessageLogVersion);
+	INTERNAL::AppendPod(header, m_nextIndex);
+	//the header is synced right away, readers treat a segment without a complete header as corrupt
+	if (::fwrite(header.data(), header.size(), 1, m_pLogFile) != 1) {
+		CloseSegment();
+		throw std::runtime_error{ "failed to write message log segment " + LogName + "!!!" };
+	}
+	SyncFile(m_pLogFile, "failed to sync message log segment ");
+	m_segmentSize = header.size();
+	m_segmentRecordCount = 0;
+}
+
+
+inline void messaging::MessageLogWriter::ContinueSegment(const std::size_t validLogSize, const std::size_t validIndexEntries) {
+	const std::string LogName = INTERNAL::MessageLogSegmentName(m_basePath, m_segmentNumber, "log");
+	const std::string IndexName = INTERNAL::MessageLogSegmentName(m_basePath, m_segmentNumber, "idx");
+	m_pLogFile = ::fopen(LogName.c_str(), "r+b");
+	m_pIndexFile = ::fopen(IndexName.c_str(), "r+b");
+	if (m_pIndexFile == nullptr) {
+		m_pIndexFile = ::fopen(IndexName.c_str(), "w+b");
+	}
+	if (m_pLogFile == nullptr || m_pIndexFile == nullptr ||
+		!file_utils::FileTruncate(m_pLogFile, validLogSize) ||
+		!file_utils::FileTruncate(m_pIndexFile, validIndexEntries * INTERNAL::MessageLogIndexEntrySize) ||
+		::fseek(m_pLogFile, 0, SEEK_END) != 0 || ::fseek(m_pIndexFile, 0, SEEK_END) != 0) {
+		CloseSegment();
+		throw std::runtime_error{ "could not continue message log segment " + LogName + "!!!" };
+	}
+	m_segmentSize = validLogSize;
+}
+
+
+inline void messaging::MessageLogWriter::RollBackFlush(const long indexSize) noexcept {
+	if (file_utils::FileTruncate(m_pLogFile, m_segmentSize) && ::fseek(m_pLogFile, 0, SEEK_END) == 0 &&
+		file_utils::FileTruncate(m_pIndexFile, static_cast<std::uint64_t>(indexSize)) && ::fseek(m_pIndexFile, 0, SEEK_END) == 0) {
+		return;
+	}
+	//the files are in an unknown state, appending more records could corrupt the log
+	::fclose(m_pLogFile);
+	::fclose(m_pIndexFile);
+	m_pLogFile = nullptr;
+	m_pIndexFile = nullptr;
+}
+
+
+inline void messaging::MessageLogWriter::SyncFile(FILE* pFile, const char* pWhat) {
+	if (m_options.SyncOnFlush ? !file_utils::FileSync(pFile) : ::fflush(pFile) != 0) {
+		throw std::runtime_error{ pWhat + std::to_string(m_segmentNumber) + "!!!" };
+	}
+}
+
+
+inline void messaging::MessageLogWriter::CloseSegment() {
+	if (m_pLogFile != nullptr && m_pIndexFile != nullptr) {
+		Flush();
+	}
+	if (m_pLogFile != nullptr) {
+		::fclose(m_pLogFile);
+		m_pLogFile = nullptr;
+	}
+	if (m_pIndexFile != nullptr) {
+		::fclose(m_pIndexFile);
+		m_pIndexFile = nullptr;
+	}
+}
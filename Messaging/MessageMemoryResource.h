@@ -0,0 +1,54 @@
+#pragma once
+#include <new>
+#include <array>
+#include <type_traits>
+#include "BasicMessage.h"
+#if MESSAGING_HAS_PMR
+#include <memory_resource>
+
+namespace messaging {
+namespace INTERNAL {
+	template<typename T>
+	constexpr bool IsMemoryResourceField = std::uses_allocator<T, std::pmr::polymorphic_allocator<char>>::value;
+
+	template<typename T, std::enable_if_t<IsMemoryResourceField<T>, bool> Dummy = false>
+	void RebindMemoryResource(T& field, std::pmr::memory_resource* pResource) {
+		//pmr containers don't take over the allocator on assignment, so the field is recreated in place
+		field.~T();
+		::new(static_cast<void*>(&field)) T(typename T::allocator_type{ pResource });
+	}
+
+	template<typename T, std::enable_if_t<IsMessageField<T>, bool> Dummy = false>
+	void RebindMemoryResource(T& field, std::pmr::memory_resource* pResource);
+
+	template<typename T, std::size_t N>
+	void RebindMemoryResource(std::array<T, N>& field, std::pmr::memory_resource* pResource) {
+		for (auto& entry : field) {
+			RebindMemoryResource(entry, pResource);
+		}
+	}
+
+	template<typename T, std::enable_if_t<!IsMemoryResourceField<T> && !IsMessageField<T> && !IsStdArray<T>::Value, bool> Dummy = false>
+	void RebindMemoryResource(T& field, std::pmr::memory_resource* pResource) {
+		(void)field;
+		(void)pResource;
+	}
+
+	template<typename T, std::enable_if_t<IsMessageField<T>, bool> Dummy>
+	void RebindMemoryResource(T& field, std::pmr::memory_resource* pResource) {
+		field.ForEachField([pResource](auto& nestedField, const std::size_t Idx) {
+			(void)Idx;
+			RebindMemoryResource(nestedField, pResource);
+		});
+	}
+}//namespace INTERNAL
+
+	//empties every pmr string/vector field of msg (nested messages included) and lets it allocate from pResource.
+	//Deserializing afterwards puts all field content into pResource, e.g. a std::pmr::monotonic_buffer_resource
+	//which frees a whole request in one shot. pResource must outlive the fields
+	template<typename MessageType>
+	inline void SetMessageMemoryResource(MessageType& msg, std::pmr::memory_resource* pResource) {
+		INTERNAL::RebindMemoryResource(msg, pResource);
+	}
+}//namespace messaging
+#endif
@@ -0,0 +1,253 @@
+#pragma once
+#include <new>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+//set to 0 to allocate messages with the global operator new/delete again
+#ifndef DECLMESSAGE_USE_MESSAGE_POOL
+	#define DECLMESSAGE_USE_MESSAGE_POOL 1
+#endif
+
+namespace messaging {
+
+	//per type pool for heap allocated messages (Clone, new msgName).
+	//Every thread keeps its own free list so allocation and deallocation never lock,
+	//a message freed on another thread than the one that allocated it simply lands in that threads list.
+	//Over aligned messages bypass the pool and use the aligned global operator new/delete.
+	template<typename MessageType>
+	class MessagePool final {
+	public:
+		static constexpr std::size_t MaxFreeCount = 1024;
+
+		MessagePool() = delete;
+
+		static void* Allocate(const std::size_t size) {
+			if (IsOverAligned || size != sizeof(MessageType)) {
+				return GlobalAllocate(size, std::integral_constant<bool, IsOverAligned>{});
+			}
+			auto& freeList = GetFreeList();
+			if (freeList.pHead == nullptr) {
+				return ::operator new(BlockSize);
+			}
+			FreeNode* pNode = freeList.pHead;
+			freeList.pHead = pNode->pNext;
+			--freeList.count;
+			return pNode;
+		}
+
+		static void Deallocate(void* pData, const std::size_t size) noexcept {
+			if (pData == nullptr) {
+				return;
+			}
+			if (IsOverAligned || size != sizeof(MessageType)) {
+				GlobalDeallocate(pData, std::integral_constant<bool, IsOverAligned>{});
+				return;
+			}
+			auto& freeList = GetFreeList();
+			if (freeList.count >= MaxFreeCount) {
+				::operator delete(pData);
+				return;
+			}
+			freeList.pHead = ::new(pData) FreeNode{ freeList.pHead };
+			++freeList.count;
+		}
+
+		//fills the free list of the calling thread so the next count allocations don't call operator new
+		static void Reserve(std::size_t count) {
+			if (IsOverAligned) {
+				return;
+			}
+			auto& freeList = GetFreeList();
+			count = (std::min)(count, MaxFreeCount);
+			while (freeList.count < count) {
+				freeList.pHead = ::new(::operator new(BlockSize)) FreeNode{ freeList.pHead };
+				++freeList.count;
+			}
+		}
+
+		//returns all free blocks of the calling thread to the system
+		static void Release() noexcept { GetFreeList().Release(); }
+
+		static std::size_t GetFreeCount() noexcept { return GetFreeList().count; }
+
+	private:
+		struct FreeNode {
+			FreeNode* pNext;
+		};
+
+		struct FreeList {
+			FreeNode* pHead = nullptr;
+			std::size_t count = 0;
+
+			void Release() noexcept {
+				while (pHead != nullptr) {
+					FreeNode* pNext = pHead->pNext;
+					::operator delete(pHead);
+					pHead = pNext;
+				}
+				count = 0;
+			}
+
+			~FreeList() {
+				Release();
+				//messages destroyed after this point during thread exit go straight to operator delete
+				count = MaxFreeCount;
+			}
+		};
+
+		static void* GlobalAllocate(const std::size_t size, std::false_type) { return ::operator new(size); }
+		static void* GlobalAllocate(const std::size_t size, std::true_type) {
+			return ::operator new(size, std::align_val_t{ alignof(MessageType) });
+		}
+
+		static void GlobalDeallocate(void* pData, std::false_type) noexcept { ::operator delete(pData); }
+		static void GlobalDeallocate(void* pData, std::true_type) noexcept {
+			::operator delete(pData, std::align_val_t{ alignof(MessageType) });
+		}
+
+		static FreeList& GetFreeList() noexcept {
+			thread_local FreeList freeList;
+			return freeList;
+		}
+
+		//sizes of derived classes differ from sizeof(MessageType), those bypass the pool
+		static constexpr std::size_t BlockSize = (std::max)(sizeof(MessageType), sizeof(FreeNode));
+		static constexpr bool IsOverAligned = alignof(MessageType) > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+	};
+
+
+	//monotonic allocator : messages are placed one after another into big blocks,
+	//destroying a message only runs its destructor and the memory is given back with Reset or the arena destructor.
+	//Not thread safe, use one arena per thread or per request
+	class MessageArena final {
+	public:
+		struct Deleter {
+			template<typename MessageType>
+			void operator()(MessageType* pMessage) const noexcept {
+				if (pMessage != nullptr) {
+					pMessage->~MessageType();
+				}
+			}
+		};
+
+		template<typename MessageType>
+		using Ptr = std::unique_ptr<MessageType, Deleter>;
+
+		static constexpr std::size_t DefaultBlockSize = 64 * 1024;
+
+		explicit MessageArena(const std::size_t blockSize = DefaultBlockSize) noexcept : m_blockSize(blockSize) {}
+		~MessageArena() { FreeBlocks(); }
+
+		MessageArena(const MessageArena&) = delete;
+		MessageArena& operator=(const MessageArena&) = delete;
+
+		void* Allocate(const std::size_t size, const std::size_t alignment = alignof(std::max_align_t));
+
+		template<typename MessageType, typename... ArgTypes>
+		Ptr<MessageType> Create(ArgTypes&&... args) {
+			void* pData = Allocate(sizeof(MessageType), alignof(MessageType));
+			return Ptr<MessageType>{ ::new(pData) MessageType(std::forward<ArgTypes>(args)...) };
+		}
+
+		//copy of msg inside the arena, the arena counterpart to IMessage::Clone
+		template<typename MessageType>
+		Ptr<MessageType> Clone(const MessageType& msg) { return Create<MessageType>(msg); }
+
+		//all messages created by this arena must be destroyed before
+		void Reset() noexcept;
+
+		std::size_t GetUsedBytes() const noexcept { return m_usedBytes; }
+
+	private:
+		struct BlockHeader {
+			BlockHeader* pPrev;
+			std::size_t size;
+		};
+
+		void FreeBlocks() noexcept;
+
+		BlockHeader* m_pBlock = nullptr;
+		char* m_pCur = nullptr;
+		char* m_pEnd = nullptr;
+		std::size_t m_blockSize;
+		std::size_t m_usedBytes = 0;
+	};
+
+
+	inline void* MessageArena::Allocate(const std::size_t size, const std::size_t alignment) {
+		const auto Align = [alignment](char* ptr) {
+			const auto Address = reinterpret_cast<std::uintptr_t>(ptr);
+			return reinterpret_cast<char*>((Address + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1));
+		};
+		char* pAligned = Align(m_pCur);
+		if (m_pCur == nullptr || pAligned + size > m_pEnd) {
+			const std::size_t BlockSize = (std::max)(m_blockSize, sizeof(BlockHeader) + size + alignment);
+			auto* pBlock = static_cast<BlockHeader*>(::operator new(BlockSize));
+			pBlock->pPrev = m_pBlock;
+			pBlock->size = BlockSize;
+			m_pBlock = pBlock;
+			m_pCur = reinterpret_cast<char*>(pBlock + 1);
+			m_pEnd = reinterpret_cast<char*>(pBlock) + BlockSize;
+			pAligned = Align(m_pCur);
+		}
+		m_pCur = pAligned + size;
+		m_usedBytes += size;
+		return pAligned;
+	}
+
+
+	inline void MessageArena::Reset() noexcept {
+		//keeps the newest block for reuse
+		if (m_pBlock != nullptr) {
+			BlockHeader* pKeep = m_pBlock;
+			m_pBlock = pKeep->pPrev;
+			FreeBlocks();
+			pKeep->pPrev = nullptr;
+			m_pBlock = pKeep;
+			m_pCur = reinterpret_cast<char*>(pKeep + 1);
+			m_pEnd = reinterpret_cast<char*>(pKeep) + pKeep->size;
+		}
+		m_usedBytes = 0;
+	}
+
+
+	inline void MessageArena::FreeBlocks() noexcept {
+		while (m_pBlock != nullptr) {
+			BlockHeader* pPrev = m_pBlock->pPrev;
+			::operator delete(m_pBlock);
+			m_pBlock = pPrev;
+		}
+		m_pCur = nullptr;
+		m_pEnd = nullptr;
+	}
+}
+
+#if DECLMESSAGE_USE_MESSAGE_POOL
+	//class specific operator new/delete routing all heap allocations of a message type through its MessagePool.
+	//The nothrow, aligned and placement forms are declared too, class scope operators hide all global ones
+	#define DECLMESSAGE_POOL_OPERATORS(msgType) \
+		static void* operator new(std::size_t size) { return messaging::MessagePool<msgType>::Allocate(size); } \
+		static void operator delete(void* pData, std::size_t size) noexcept { messaging::MessagePool<msgType>::Deallocate(pData, size); } \
+		static void* operator new(std::size_t size, const std::nothrow_t&) noexcept { \
+			try { return messaging::MessagePool<msgType>::Allocate(size); } catch (...) { return nullptr; } \
+		} \
+		static void operator delete(void* pData, const std::nothrow_t&) noexcept { messaging::MessagePool<msgType>::Deallocate(pData, 0); } \
+		static void* operator new(std::size_t size, std::align_val_t alignment) { return ::operator new(size, alignment); } \
+		static void operator delete(void* pData, std::size_t size, std::align_val_t alignment) noexcept { \
+			::operator delete(pData, size, alignment); \
+		} \
+		static void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { \
+			return ::operator new(size, alignment, std::nothrow); \
+		} \
+		static void operator delete(void* pData, std::align_val_t alignment, const std::nothrow_t&) noexcept { \
+			::operator delete(pData, alignment, std::nothrow); \
+		} \
+		static void* operator new(std::size_t size, void* pPlace) noexcept { (void)size; return pPlace; } \
+		static void operator delete(void* pData, void* pPlace) noexcept { (void)pData; (void)pPlace; }
+#else
+	#define DECLMESSAGE_POOL_OPERATORS(msgType)
+#endif
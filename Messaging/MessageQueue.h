@@ -0,0 +1,283 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+#include <algorithm>
+#include "MessageBinarySerializer.h"
+#include "MessageBinaryDeserializer.h"
+
+//bounded lock free queues to pass messages between threads by value.
+//The slots are constructed once, a push assigns into a slot and a pop moves out of it,
+//so the strings and vectors of messages keep their capacity while they go around the ring.
+//MessageType has to be default constructible and move assignable.
+namespace messaging {
+namespace INTERNAL {
+	constexpr std::size_t CacheLineSize = 64;
+
+	inline std::size_t RoundUpToPowerOfTwo(const std::size_t value) noexcept {
+		std::size_t res = 2;
+		while (res < value) {
+			res <<= 1;
+		}
+		return res;
+	}
+}//namespace INTERNAL
+
+	//one producer thread, one consumer thread
+	template<typename MessageType>
+	class SpscMessageQueue final {
+	public:
+		using ValueType = MessageType;
+
+		//the capacity is rounded up to a power of two
+		explicit SpscMessageQueue(const std::size_t capacity)
+			: m_slots(INTERNAL::RoundUpToPowerOfTwo(capacity)), m_mask(m_slots.size() - 1) {}
+
+		SpscMessageQueue(const SpscMessageQueue&) = delete;
+		SpscMessageQueue& operator=(const SpscMessageQueue&) = delete;
+
+		//fill(MessageType& slot) writes the message straight into the queue, false if the queue is full
+		template<typename FuncType>
+		bool TryPushInPlace(FuncType&& fill) {
+			const std::size_t Tail = m_tail.load(std::memory_order_relaxed);
+			if (GetFreeCount(Tail, 1) == 0) {
+				return false;
+			}
+			fill(m_slots[Tail & m_mask]);
+			m_tail.store(Tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool TryPush(const MessageType& msg) { return TryPushInPlace([&msg](MessageType& slot) { slot = msg; }); }
+		bool TryPush(MessageType&& msg) { return TryPushInPlace([&msg](MessageType& slot) { slot = std::move(msg); }); }
+
+		//pushes up to count messages with a single publish, returns how many fit.
+		//Pass std::make_move_iterator to move the messages in
+		template<typename InputIterator>
+		std::size_t PushBatch(InputIterator first, const std::size_t count) {
+			const std::size_t Tail = m_tail.load(std::memory_order_relaxed);
+			const std::size_t ToPush = (std::min)(count, GetFreeCount(Tail, count));
+			for (std::size_t i = 0; i < ToPush; ++i, ++first) {
+				m_slots[(Tail + i) & m_mask] = *first;
+			}
+			m_tail.store(Tail + ToPush, std::memory_order_release);
+			return ToPush;
+		}
+
+		//calls consume(MessageType& slot) for up to maxCount messages and frees their slots at once, returns how many
+		template<typename FuncType>
+		std::size_t ConsumeBatch(FuncType&& consume, const std::size_t maxCount = SIZE_MAX) {
+			const std::size_t Head = m_head.load(std::memory_order_relaxed);
+			if (m_cachedTail - Head < maxCount) {
+				m_cachedTail = m_tail.load(std::memory_order_acquire);
+			}
+			const std::size_t ToPop = (std::min)(maxCount, m_cachedTail - Head);
+			for (std::size_t i = 0; i < ToPop; ++i) {
+				consume(m_slots[(Head + i) & m_mask]);
+			}
+			m_head.store(Head + ToPop, std::memory_order_release);
+			return ToPop;
+		}
+
+		template<typename FuncType>
+		bool TryPopInPlace(FuncType&& consume) { return ConsumeBatch(std::forward<FuncType>(consume), 1) == 1; }
+
+		bool TryPop(MessageType& msg) { return TryPopInPlace([&msg](MessageType& slot) { msg = std::move(slot); }); }
+
+		template<typename OutputIterator>
+		std::size_t PopBatch(OutputIterator out, const std::size_t maxCount) {
+			return ConsumeBatch([&out](MessageType& slot) { *out++ = std::move(slot); }, maxCount);
+		}
+
+		std::size_t GetCapacity() const noexcept { return m_slots.size(); }
+		//exact only when called by the producer or consumer while the other side is idle
+		std::size_t GetSizeApprox() const noexcept {
+			return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+		}
+
+	private:
+		//the copy of the head is only refreshed if it doesn't show enough free slots
+		std::size_t GetFreeCount(const std::size_t tail, const std::size_t wanted) noexcept {
+			if (m_cachedHead + m_slots.size() - tail < wanted) {
+				m_cachedHead = m_head.load(std::memory_order_acquire);
+			}
+			return m_cachedHead + m_slots.size() - tail;
+		}
+
+		std::vector<MessageType> m_slots;
+		std::size_t m_mask;
+		//consumer side, the copy of the tail saves loading the producers cache line for every pop
+		alignas(INTERNAL::CacheLineSize) std::atomic<std::size_t> m_head{ 0 };
+		std::size_t m_cachedTail = 0;
+		//producer side
+		alignas(INTERNAL::CacheLineSize) std::atomic<std::size_t> m_tail{ 0 };
+		std::size_t m_cachedHead = 0;
+	};
+
+
+	//any number of producer threads, one consumer thread.
+	//Producers reserve slots with one compare exchange (a batch reserves all its slots at once)
+	//and publish every slot on its own, the consumer stops at the first slot that isn't published yet.
+	//A reserved slot is published even if filling it throws, it is marked empty and skipped by the consumer
+	template<typename MessageType>
+	class MpscMessageQueue final {
+	public:
+		using ValueType = MessageType;
+
+		//the capacity is rounded up to a power of two
+		explicit MpscMessageQueue(const std::size_t capacity)
+			: m_capacity(INTERNAL::RoundUpToPowerOfTwo(capacity)), m_mask(m_capacity - 1), m_pSlots(new Slot[m_capacity]) {}
+
+		MpscMessageQueue(const MpscMessageQueue&) = delete;
+		MpscMessageQueue& operator=(const MpscMessageQueue&) = delete;
+
+		template<typename FuncType>
+		bool TryPushInPlace(FuncType&& fill) {
+			std::size_t pos = 0;
+			if (Reserve(1, pos) == 0) {
+				return false;
+			}
+			Publish(pos, fill);
+			return true;
+		}
+
+		bool TryPush(const MessageType& msg) { return TryPushInPlace([&msg](MessageType& slot) { slot = msg; }); }
+		bool TryPush(MessageType&& msg) { return TryPushInPlace([&msg](MessageType& slot) { slot = std::move(msg); }); }
+
+		template<typename InputIterator>
+		std::size_t PushBatch(InputIterator first, const std::size_t count) {
+			std::size_t pos = 0;
+			const std::size_t Reserved = Reserve(count, pos);
+			std::size_t i = 0;
+			try {
+				for (; i < Reserved; ++i) {
+					Publish(pos + i, [&first](MessageType& slot) { slot = *first; });
+					++first;
+				}
+			} catch (...) {
+				//slot i is already published by Publish or by the loop, the rest of the batch would block the consumer
+				for (++i; i < Reserved; ++i) {
+					PublishEmpty(pos + i);
+				}
+				throw;
+			}
+			return Reserved;
+		}
+
+		template<typename FuncType>
+		std::size_t ConsumeBatch(FuncType&& consume, const std::size_t maxCount = SIZE_MAX) {
+			std::size_t pos = m_head.load(std::memory_order_relaxed);
+			std::size_t count = 0;
+			while (count < maxCount) {
+				Slot& slot = m_pSlots[pos & m_mask];
+				if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+					break;
+				}
+				++pos;
+				if (!slot.isEmpty) {
+					consume(slot.value);
+					++count;
+				}
+			}
+			m_head.store(pos, std::memory_order_release);
+			return count;
+		}
+
+		template<typename FuncType>
+		bool TryPopInPlace(FuncType&& consume) { return ConsumeBatch(std::forward<FuncType>(consume), 1) == 1; }
+
+		bool TryPop(MessageType& msg) { return TryPopInPlace([&msg](MessageType& slot) { msg = std::move(slot); }); }
+
+		template<typename OutputIterator>
+		std::size_t PopBatch(OutputIterator out, const std::size_t maxCount) {
+			return ConsumeBatch([&out](MessageType& slot) { *out++ = std::move(slot); }, maxCount);
+		}
+
+		std::size_t GetCapacity() const noexcept { return m_capacity; }
+		std::size_t GetSizeApprox() const noexcept {
+			return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+		}
+
+	private:
+		struct Slot {
+			//position + 1 once the message for position is written
+			std::atomic<std::size_t> sequence{ 0 };
+			//set if the fill of the producer threw, value holds no message then
+			bool isEmpty = false;
+			MessageType value;
+		};
+
+		//reserves up to count slots starting at pos, returns how many
+		std::size_t Reserve(const std::size_t count, std::size_t& pos) noexcept {
+			pos = m_tail.load(std::memory_order_relaxed);
+			for (;;) {
+				//the consumer frees slots in order, everything below head + capacity is free
+				const std::size_t Free = m_head.load(std::memory_order_acquire) + m_capacity - pos;
+				const std::size_t ToReserve = (std::min)(count, Free);
+				if (ToReserve == 0) {
+					return 0;
+				}
+				if (m_tail.compare_exchange_weak(pos, pos + ToReserve, std::memory_order_relaxed)) {
+					return ToReserve;
+				}
+			}
+		}
+
+		template<typename FuncType>
+		void Publish(const std::size_t pos, FuncType&& fill) {
+			Slot& slot = m_pSlots[pos & m_mask];
+			try {
+				fill(slot.value);
+			} catch (...) {
+				PublishEmpty(pos);
+				throw;
+			}
+			slot.isEmpty = false;
+			slot.sequence.store(pos + 1, std::memory_order_release);
+		}
+
+		void PublishEmpty(const std::size_t pos) noexcept {
+			Slot& slot = m_pSlots[pos & m_mask];
+			slot.isEmpty = true;
+			slot.sequence.store(pos + 1, std::memory_order_release);
+		}
+
+		std::size_t m_capacity;
+		std::size_t m_mask;
+		std::unique_ptr<Slot[]> m_pSlots;
+		alignas(INTERNAL::CacheLineSize) std::atomic<std::size_t> m_head{ 0 };
+		alignas(INTERNAL::CacheLineSize) std::atomic<std::size_t> m_tail{ 0 };
+	};
+
+
+	//slot for messages with dynamic fields (strings, vectors) : the message is serialized straight into the queue
+	//so the consumer gets it without any allocation of the producer crossing threads
+	template<std::size_t SlotSize>
+	struct SerializedMessageSlot {
+		INTERNAL::SerializedSizeDataType size = 0;
+		std::array<Byte, SlotSize> data;
+	};
+
+	template<template<typename> class QueueTemplate, std::size_t SlotSize, typename MessageType>
+	inline bool TryPushSerialized(QueueTemplate<SerializedMessageSlot<SlotSize>>& queue, const MessageType& msg) {
+		if (msg.GetMessageSize() > SlotSize) {
+			throw std::runtime_error("message is bigger than the serialized queue slot!!!");
+		}
+		return queue.TryPushInPlace([&msg](SerializedMessageSlot<SlotSize>& slot) {
+			slot.size = static_cast<INTERNAL::SerializedSizeDataType>(binary_serilization::Serialize(msg, slot.data.data()));
+		});
+	}
+
+	template<template<typename> class QueueTemplate, std::size_t SlotSize, typename MessageType>
+	inline bool TryPopDeserialized(QueueTemplate<SerializedMessageSlot<SlotSize>>& queue, MessageType& msg) {
+		return queue.TryPopInPlace([&msg](SerializedMessageSlot<SlotSize>& slot) {
+			binary_serilization::Deserialize(msg, slot.data.data(), static_cast<std::int32_t>(slot.size));
+		});
+	}
+}//namespace messaging
@@ -0,0 +1,45 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include "MessageBinarySerializer.h"
+
+namespace messaging {
+namespace INTERNAL {
+	//serializes msg behind the bytes already in buffer, if it throws buffer is left as it was
+	template<typename MessageType>
+	inline void AppendSerialized(std::vector<Byte>& buffer, const MessageType& msg) {
+		const std::size_t Offset = buffer.size();
+		buffer.resize(Offset + msg.GetMessageSize());
+		std::size_t written = 0;
+		try {
+			written = binary_serilization::Serialize(msg, buffer.data() + Offset);
+		} catch (...) {
+			buffer.resize(Offset);
+			throw;
+		}
+		if (buffer.size() - Offset < written) {
+			buffer.resize(Offset);
+			throw std::runtime_error("FATAL ERROR !!! ACCESS VIOLATION!!!");
+		}
+	}
+}//namespace INTERNAL
+
+	//a message serialized once and shared by all its recipients,
+	//a recipient may keep it (e.g. in a send queue) after the send call returned
+	using SharedMessageBuffer = std::shared_ptr<const std::vector<Byte>>;
+
+	template<typename MessageType>
+	inline SharedMessageBuffer SerializeShared(const MessageType& msg) {
+		return std::make_shared<const std::vector<Byte>>(binary_serilization::Serialize(msg));
+	}
+
+	//the set of connections a message is fanned out to, MessageSender serializes
+	//the message once and hands the same buffer to SendToAll
+	class IMessageRecipients {
+	public:
+		virtual ~IMessageRecipients() noexcept = default;
+		//returns the number of recipients the buffer was handed to
+		virtual std::size_t SendToAll(const SharedMessageBuffer& buffer) = 0;
+	};
+}//namespace messaging
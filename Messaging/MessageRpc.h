@@ -0,0 +1,369 @@
+#pragma once
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <exception>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include "MessageTransport.h"
+
+//request/response calls on top of messages over any ITransport which keeps the frames apart (TcpConnection, LoopbackTransport).
+//Every frame starts with an RpcHeader holding the correlation id, so any number of calls can be in flight
+//on one transport and the responses may arrive in any order.
+//Outgoing frames are collected and written with one SendBatch by Flush, or as soon as maxBatchCount frames are queued.
+//Neither class is thread safe, use them on the thread that polls the transport
+namespace messaging {
+
+	enum class RpcFrameKind : std::uint8_t {
+		Request,
+		Response,
+		Error
+	};
+
+	struct RpcHeader {
+		std::uint32_t correlationId;
+		//MessageTypeId of the message behind the header, for errors the one of the expected response
+		std::uint32_t typeId;
+		RpcFrameKind kind;
+	};
+
+namespace INTERNAL {
+	//on the wire : correlation id, type id, kind and zero padding which keeps the message behind the header aligned
+	constexpr std::size_t RpcHeaderSize = sizeof(std::uint32_t) * 3;
+	constexpr std::size_t DefaultRpcBatchCount = 64;
+
+	inline void WriteRpcHeader(Byte* pDestination, const RpcHeader& header) noexcept {
+		std::memcpy(pDestination, &header.correlationId, sizeof(std::uint32_t));
+		std::memcpy(pDestination + sizeof(std::uint32_t), &header.typeId, sizeof(std::uint32_t));
+		const std::uint32_t Kind = static_cast<std::uint32_t>(header.kind);
+		std::memcpy(pDestination + sizeof(std::uint32_t) * 2, &Kind, sizeof(std::uint32_t));
+	}
+
+	inline bool ReadRpcHeader(const ByteSpan frame, RpcHeader& header) noexcept {
+		if (frame.size() < RpcHeaderSize) {
+			return false;
+		}
+		std::memcpy(&header.correlationId, frame.data(), sizeof(std::uint32_t));
+		std::memcpy(&header.typeId, frame.data() + sizeof(std::uint32_t), sizeof(std::uint32_t));
+		std::uint32_t kind = 0;
+		std::memcpy(&kind, frame.data() + sizeof(std::uint32_t) * 2, sizeof(std::uint32_t));
+		header.kind = static_cast<RpcFrameKind>(kind);
+		return kind <= static_cast<std::uint32_t>(RpcFrameKind::Error);
+	}
+
+	inline ByteSpan GetRpcPayload(const ByteSpan frame) noexcept {
+		return ByteSpan(frame.data() + RpcHeaderSize, frame.size() - RpcHeaderSize);
+	}
+
+	//frames serialized one after another into one buffer, sent with a single SendBatch
+	class RpcFrameBatch final {
+	public:
+		template<typename MessageType>
+		void Append(const RpcHeader& header, const MessageType& msg) {
+			const std::size_t Offset = AppendHeader(header);
+			try {
+				AppendSerialized(m_bytes, msg);
+			} catch (const std::runtime_error&) {
+				m_bytes.resize(Offset);
+				throw;
+			}
+			m_frameEnds.push_back(m_bytes.size());
+		}
+
+		void AppendError(const RpcHeader& header, const std::string& error) {
+			AppendHeader(header);
+			const Byte* pError = reinterpret_cast<const Byte*>(error.data());
+			m_bytes.insert(m_bytes.end(), pError, pError + error.size());
+			m_frameEnds.push_back(m_bytes.size());
+		}
+
+		std::size_t GetFrameCount() const noexcept { return m_frameEnds.size(); }
+
+		void Flush(ITransport& transport) {
+			if (m_frameEnds.empty()) {
+				return;
+			}
+			m_spans.clear();
+			std::size_t begin = 0;
+			for (const std::size_t End : m_frameEnds) {
+				m_spans.emplace_back(m_bytes.data() + begin, End - begin);
+				begin = End;
+			}
+			//the frames are dropped even if the transport throws, they would be sent twice otherwise
+			try {
+				transport.SendBatch(m_spans.data(), m_spans.size());
+			} catch (...) {
+				Clear();
+				throw;
+			}
+			Clear();
+		}
+
+		void Clear() noexcept {
+			m_bytes.clear();
+			m_frameEnds.clear();
+		}
+
+	private:
+		std::size_t AppendHeader(const RpcHeader& header) {
+			const std::size_t Offset = m_bytes.size();
+			m_bytes.resize(Offset + RpcHeaderSize);
+			WriteRpcHeader(m_bytes.data() + Offset, header);
+			return Offset;
+		}
+
+		std::vector<Byte> m_bytes;
+		std::vector<std::size_t> m_frameEnds;
+		std::vector<ByteSpan> m_spans;
+	};
+}//namespace INTERNAL
+
+	class RpcClient final {
+	public:
+		explicit RpcClient(ITransport& transport, const std::size_t maxBatchCount = INTERNAL::DefaultRpcBatchCount)
+			: m_transport(transport), m_maxBatchCount(maxBatchCount) {}
+
+		RpcClient(const RpcClient&) = delete;
+		RpcClient& operator=(const RpcClient&) = delete;
+
+		//onDone(ResponseType* pResponse, const char* pError) is called from OnFrame or FailAll, exactly one of both is nullptr.
+		//Returns the correlation id of the call
+		template<typename RequestType, typename ResponseType, typename FuncType>
+		std::uint32_t Call(const RequestType& request, FuncType&& onDone) {
+			const std::uint32_t CorrelationId = m_nextCorrelationId++;
+			m_batch.Append(RpcHeader{ CorrelationId, MessageTypeId<RequestType>, RpcFrameKind::Request }, request);
+			m_pendingCalls.emplace(CorrelationId, PendingCall{ MessageTypeId<ResponseType>, MakeCompletion<ResponseType>(std::forward<FuncType>(onDone)) });
+			m_queuedIds.push_back(CorrelationId);
+			if (m_batch.GetFrameCount() >= m_maxBatchCount) {
+				//a failed send is reported to onDone of every queued call, this call included
+				try {
+					Flush();
+				} catch (...) {
+				}
+			}
+			return CorrelationId;
+		}
+
+		//the future is ready once the response went through OnFrame, errors are thrown as std::runtime_error by get.
+		//Don't wait for it on the thread that has to call OnFrame
+		template<typename RequestType, typename ResponseType>
+		std::future<ResponseType> Call(const RequestType& request) {
+			auto pPromise = std::make_shared<std::promise<ResponseType>>();
+			std::future<ResponseType> future = pPromise->get_future();
+			Call<RequestType, ResponseType>(request, [pPromise](ResponseType* pResponse, const char* pError) {
+				if (pResponse != nullptr) {
+					pPromise->set_value(std::move(*pResponse));
+				} else {
+					pPromise->set_exception(std::make_exception_ptr(std::runtime_error(std::string("rpc call failed : ") + pError + "!!!")));
+				}
+			});
+			return future;
+		}
+
+		//sends all queued requests with one SendBatch.
+		//If the transport throws the queued requests are dropped, their calls fail with the error and the exception is rethrown
+		void Flush() {
+			try {
+				m_batch.Flush(m_transport);
+			} catch (const std::exception& e) {
+				FailQueued(e.what());
+				throw;
+			} catch (...) {
+				FailQueued("the requests could not be sent");
+				throw;
+			}
+			m_queuedIds.clear();
+		}
+
+		//completes the call the frame answers, false if the frame is no response to a call in flight
+		bool OnFrame(const ByteSpan frame) {
+			RpcHeader header;
+			if (!INTERNAL::ReadRpcHeader(frame, header) || header.kind == RpcFrameKind::Request) {
+				return false;
+			}
+			const auto It = m_pendingCalls.find(header.correlationId);
+			if (It == m_pendingCalls.end()) {
+				return false;
+			}
+			const PendingCall Completed = std::move(It->second);
+			m_pendingCalls.erase(It);
+			const ByteSpan Payload = INTERNAL::GetRpcPayload(frame);
+			if (header.kind == RpcFrameKind::Error) {
+				const std::string Error(reinterpret_cast<const char*>(Payload.data()), Payload.size());
+				Completed.complete(ByteSpan(), Error.c_str());
+			} else if (header.typeId != Completed.responseTypeId) {
+				Completed.complete(ByteSpan(), "the response has an unexpected type");
+			} else {
+				Completed.complete(Payload, nullptr);
+			}
+			return true;
+		}
+
+		//fails every call in flight and drops the queued requests, e.g. after the connection closed
+		void FailAll(const char* pReason) {
+			m_batch.Clear();
+			m_queuedIds.clear();
+			auto pendingCalls = std::move(m_pendingCalls);
+			m_pendingCalls.clear();
+			for (auto& pendingCall : pendingCalls) {
+				pendingCall.second.complete(ByteSpan(), pReason);
+			}
+		}
+
+		//calls waiting for their response, queued requests included
+		std::size_t GetInFlightCount() const noexcept { return m_pendingCalls.size(); }
+		std::size_t GetQueuedCount() const noexcept { return m_batch.GetFrameCount(); }
+
+	private:
+		using CompletionType = std::function<void(const ByteSpan payload, const char* pError)>;
+
+		struct PendingCall {
+			std::uint32_t responseTypeId;
+			CompletionType complete;
+		};
+
+		void FailQueued(const char* pReason) {
+			//a completion may queue new calls
+			const std::vector<std::uint32_t> QueuedIds = std::move(m_queuedIds);
+			m_queuedIds.clear();
+			for (const std::uint32_t CorrelationId : QueuedIds) {
+				const auto It = m_pendingCalls.find(CorrelationId);
+				if (It != m_pendingCalls.end()) {
+					const PendingCall Failed = std::move(It->second);
+					m_pendingCalls.erase(It);
+					Failed.complete(ByteSpan(), pReason);
+				}
+			}
+		}
+
+		template<typename ResponseType, typename FuncType>
+		static CompletionType MakeCompletion(FuncType&& onDone) {
+			return [onDone = std::forward<FuncType>(onDone)](const ByteSpan payload, const char* pError) mutable {
+				if (pError != nullptr) {
+					onDone(static_cast<ResponseType*>(nullptr), pError);
+					return;
+				}
+				ResponseType response;
+				if (!DeserializeFrame(response, payload)) {
+					onDone(static_cast<ResponseType*>(nullptr), "the response could not be deserialized");
+					return;
+				}
+				onDone(&response, static_cast<const char*>(nullptr));
+			};
+		}
+
+		ITransport& m_transport;
+		std::size_t m_maxBatchCount;
+		std::uint32_t m_nextCorrelationId = 1;
+		INTERNAL::RpcFrameBatch m_batch;
+		std::unordered_map<std::uint32_t, PendingCall> m_pendingCalls;
+		//correlation ids of the requests in m_batch
+		std::vector<std::uint32_t> m_queuedIds;
+	};
+
+
+	class RpcServer final {
+	public:
+		explicit RpcServer(const std::size_t maxBatchCount = INTERNAL::DefaultRpcBatchCount) : m_maxBatchCount(maxBatchCount) {}
+
+		RpcServer(const RpcServer&) = delete;
+		RpcServer& operator=(const RpcServer&) = delete;
+
+		//func(const RequestType&) returns the ResponseType, an exception thrown by func is sent back as error.
+		//The request message is reused for every call of the method
+		template<typename RequestType, typename ResponseType, typename FuncType>
+		void Handle(FuncType&& func) {
+			m_methods[MessageTypeId<RequestType>] = [func = std::forward<FuncType>(func), request = RequestType()]
+				(RpcServer& server, ITransport& replyTransport, const std::uint32_t correlationId, const ByteSpan payload) mutable {
+				RpcHeader header{ correlationId, MessageTypeId<ResponseType>, RpcFrameKind::Response };
+				if (!DeserializeFrame(request, payload)) {
+					header.kind = RpcFrameKind::Error;
+					server.QueueError(replyTransport, header, "the request could not be deserialized");
+					return;
+				}
+				std::string error;
+				try {
+					const ResponseType Response = func(static_cast<const RequestType&>(request));
+					server.QueueResponse(replyTransport, header, Response);
+					return;
+				} catch (const std::exception& e) {
+					error = e.what();
+				}
+				header.kind = RpcFrameKind::Error;
+				server.QueueError(replyTransport, header, error);
+			};
+		}
+
+		//runs the method of a request frame and queues the reply for replyTransport, false if the frame is no request
+		bool OnFrame(ITransport& replyTransport, const ByteSpan frame) {
+			RpcHeader header;
+			if (!INTERNAL::ReadRpcHeader(frame, header) || header.kind != RpcFrameKind::Request) {
+				return false;
+			}
+			const auto It = m_methods.find(header.typeId);
+			if (It == m_methods.end()) {
+				QueueError(replyTransport, RpcHeader{ header.correlationId, 0, RpcFrameKind::Error }, "there is no method for the request type");
+				return true;
+			}
+			It->second(*this, replyTransport, header.correlationId, INTERNAL::GetRpcPayload(frame));
+			return true;
+		}
+
+		//sends the queued replies with one SendBatch, call it after the frames of a poll went through OnFrame
+		void Flush() {
+			if (m_pReplyTransport != nullptr) {
+				m_batch.Flush(*m_pReplyTransport);
+			}
+		}
+
+		//drops the queued replies for a transport that is about to be destroyed
+		void DropReplies(const ITransport& transport) noexcept {
+			if (m_pReplyTransport == &transport) {
+				m_batch.Clear();
+				m_pReplyTransport = nullptr;
+			}
+		}
+
+	private:
+		using MethodType = std::function<void(RpcServer& server, ITransport& replyTransport, const std::uint32_t correlationId, const ByteSpan payload)>;
+
+		//replies are batched per transport, a reply for another transport sends the batch first
+		void SelectReplyTransport(ITransport& replyTransport) {
+			if (m_pReplyTransport != &replyTransport) {
+				Flush();
+				m_pReplyTransport = &replyTransport;
+			}
+		}
+
+		template<typename ResponseType>
+		void QueueResponse(ITransport& replyTransport, const RpcHeader& header, const ResponseType& response) {
+			SelectReplyTransport(replyTransport);
+			m_batch.Append(header, response);
+			FlushIfFull();
+		}
+
+		void QueueError(ITransport& replyTransport, const RpcHeader& header, const std::string& error) {
+			SelectReplyTransport(replyTransport);
+			m_batch.AppendError(header, error);
+			FlushIfFull();
+		}
+
+		void FlushIfFull() {
+			if (m_batch.GetFrameCount() >= m_maxBatchCount) {
+				Flush();
+			}
+		}
+
+		std::size_t m_maxBatchCount;
+		ITransport* m_pReplyTransport = nullptr;
+		INTERNAL::RpcFrameBatch m_batch;
+		std::unordered_map<std::uint32_t, MethodType> m_methods;
+	};
+}//namespace messaging
@@ -0,0 +1,149 @@
+#pragma once
+#include <chrono>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <unordered_map>
+#include "MessageRecipients.h"
+
+namespace messaging {
+
+	//collects the serialized messages of one connection and writes them with a single call of the writer.
+	//Writes as soon as MaxBytes are queued, the owner calls FlushIfDue regularly to bound the latency
+	//and Flush at the end of a tick. WriterType is called as writer(const Byte* pData, std::size_t len)
+	template<typename WriterType>
+	class CoalescingSendQueue final {
+	public:
+		using ClockT = std::chrono::steady_clock;
+
+		static constexpr std::size_t DefaultMaxBytes = 16 * 1024;
+		static constexpr std::chrono::milliseconds DefaultMaxDelay{ 5 };
+
+		explicit CoalescingSendQueue(WriterType writer, const std::size_t maxBytes = DefaultMaxBytes,
+			const std::chrono::milliseconds maxDelay = DefaultMaxDelay)
+			: m_writer(std::move(writer)), m_maxBytes(maxBytes), m_maxDelay(maxDelay) {}
+
+		//serializes msg straight behind the already queued messages
+		template<typename MessageType>
+		void Push(const MessageType& msg) {
+			BeginPush();
+			INTERNAL::AppendSerialized(m_buffer, msg);
+			EndPush();
+		}
+
+		void Push(const Byte* pData, const std::size_t len) {
+			BeginPush();
+			m_buffer.insert(m_buffer.end(), pData, pData + len);
+			EndPush();
+		}
+
+		void Push(const SharedMessageBuffer& buffer) { Push(buffer->data(), buffer->size()); }
+
+		//writes the queue if its oldest message waits for MaxDelay or longer
+		bool FlushIfDue(const ClockT::time_point now = ClockT::now()) {
+			if (m_buffer.empty() || now - m_firstPushTime < m_maxDelay) {
+				return false;
+			}
+			Flush();
+			return true;
+		}
+
+		void Flush() {
+			if (m_buffer.empty()) {
+				return;
+			}
+			m_writer(m_buffer.data(), m_buffer.size());
+			++m_writeCount;
+			//keeps the capacity for the next tick
+			m_buffer.clear();
+		}
+
+		std::size_t GetQueuedBytes() const noexcept { return m_buffer.size(); }
+		std::size_t GetWriteCount() const noexcept { return m_writeCount; }
+
+	private:
+		void BeginPush() {
+			if (m_buffer.empty()) {
+				m_firstPushTime = ClockT::now();
+			}
+		}
+
+		void EndPush() {
+			if (m_buffer.size() >= m_maxBytes) {
+				Flush();
+			}
+		}
+
+		WriterType m_writer;
+		std::vector<Byte> m_buffer;
+		ClockT::time_point m_firstPushTime;
+		std::size_t m_maxBytes;
+		std::chrono::milliseconds m_maxDelay;
+		std::size_t m_writeCount = 0;
+	};
+
+	template<typename WriterType>
+	constexpr std::chrono::milliseconds CoalescingSendQueue<WriterType>::DefaultMaxDelay;
+
+
+	//one CoalescingSendQueue per connection, the writer of a new queue is constructed from its key
+	template<typename KeyType, typename WriterType>
+	class SendQueueMap final {
+	public:
+		using QueueType = CoalescingSendQueue<WriterType>;
+
+		explicit SendQueueMap(const std::size_t maxBytes = QueueType::DefaultMaxBytes,
+			const std::chrono::milliseconds maxDelay = QueueType::DefaultMaxDelay) noexcept
+			: m_maxBytes(maxBytes), m_maxDelay(maxDelay) {}
+
+		QueueType& Get(const KeyType& key) {
+			auto it = m_queues.find(key);
+			if (it == m_queues.end()) {
+				it = m_queues.emplace(key, QueueType(WriterType(key), m_maxBytes, m_maxDelay)).first;
+			}
+			return it->second;
+		}
+
+		//writes the queue of key if there is one, e.g. before a message is sent to key without the queue
+		void Flush(const KeyType& key) {
+			const auto it = m_queues.find(key);
+			if (it != m_queues.end()) {
+				it->second.Flush();
+			}
+		}
+
+		void FlushAll() {
+			for (auto& entry : m_queues) {
+				entry.second.Flush();
+			}
+		}
+
+		void FlushDue(const typename QueueType::ClockT::time_point now = QueueType::ClockT::now()) {
+			for (auto& entry : m_queues) {
+				entry.second.FlushIfDue(now);
+			}
+		}
+
+		//drops the queue and everything still queued in it, for connections that are gone
+		void Remove(const KeyType& key) { m_queues.erase(key); }
+
+		//drops the queues of all keys pred returns true for, without writing them
+		template<typename PredType>
+		void RemoveIf(PredType&& pred) {
+			for (auto it = m_queues.begin(); it != m_queues.end();) {
+				if (pred(it->first)) {
+					it = m_queues.erase(it);
+				} else {
+					++it;
+				}
+			}
+		}
+
+		std::size_t GetQueueCount() const noexcept { return m_queues.size(); }
+
+	private:
+		std::unordered_map<KeyType, QueueType> m_queues;
+		std::size_t m_maxBytes;
+		std::chrono::milliseconds m_maxDelay;
+	};
+}//namespace messaging
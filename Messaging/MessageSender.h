@@ -1,12 +1,75 @@
 #pragma once
+//binding of the messaging transports to the game server (CHARACTER, DESC, P2P_MANAGER).
+//Everything else only needs MessageTransport.h and builds without the server sources
 #include "../stdafx.h"
 #include "../char_manager.h"
+#include "../desc_manager.h"
 #include "../p2p.h"
 #include "../char.h"
 #include "../desc.h"
 #include "../Messaging/MessageBinarySerializer.h"
 #include "BasicMessage.h"
+#include "MessageRecipients.h"
+#include "MessageSendQueue.h"
+#include "MessageTransport.h"
+#if defined(__linux__)
+#include "MessageSharedChannel.h"
+#endif
 namespace messaging {
+
+class DescTransport final : public ITransport {
+public:
+	explicit DescTransport(DESC* pDesc) noexcept : m_pDesc(pDesc) {}
+	virtual void Send(const ByteSpan bytes) override { m_pDesc->Packet(bytes.data(), static_cast<int>(bytes.size())); }
+private:
+	DESC* m_pDesc;
+};
+
+
+//every connected player character
+class CharacterRecipients final : public IMessageRecipients {
+public:
+	virtual std::size_t SendToAll(const SharedMessageBuffer& buffer) override {
+		std::size_t count = 0;
+		for (DESC* pDesc : DESC_MANAGER::instance().GetClientSet()) {
+			CHARACTER* pChar = pDesc->GetCharacter();
+			if (pChar == nullptr || !pChar->IsPC()) {
+				continue;
+			}
+			DescTransport(pDesc).Send(ByteSpan(*buffer));
+			++count;
+		}
+		return count;
+	}
+};
+
+
+//every other game process connected over p2p
+class GameProcessRecipients final : public IMessageRecipients {
+public:
+	virtual std::size_t SendToAll(const SharedMessageBuffer& buffer) override {
+		P2P_MANAGER::instance().Send(buffer->data(), static_cast<int>(buffer->size()));
+		return P2P_MANAGER::instance().GetDescCount();
+	}
+};
+
+
+//writes a coalesced send queue to its descriptor. The queues are keyed by the descriptor handle, handles are never reused,
+//the descriptor is looked up on every write so bytes for a descriptor that is gone are dropped
+class DescWriter final {
+public:
+	explicit DescWriter(const DWORD descHandle) noexcept : m_descHandle(descHandle) {}
+	void operator()(const Byte* pData, const std::size_t len) {
+		DESC* pDesc = DESC_MANAGER::instance().FindByHandle(m_descHandle);
+		if (pDesc != nullptr) {
+			DescTransport(pDesc).Send(ByteSpan(pData, len));
+		}
+	}
+private:
+	DWORD m_descHandle;
+};
+
+
 class MessageSender final {
 public:
 	template<typename DerivedType, typename... MessageTypes>
@@ -14,21 +77,71 @@ public:
 		if (pChar == nullptr || pChar->GetDesc() == nullptr || (!pChar->IsPC())) {
 			return false;
 		}
-		const std::vector<Byte>& byteVec = binary_serilization::Serialize(toSendMsg);
-		pChar->GetDesc()->Packet(byteVec.data(), byteVec.size());
+		//messages queued earlier for the descriptor have to arrive first
+		GetSendQueues().Flush(pChar->GetDesc()->GetHandle());
+		DescTransport transport(pChar->GetDesc());
+		TransmitMessage(transport, toSendMsg);
+		return true;
+	}
+
+
+	//like SendMessage but the message is serialized into the send queue of the descriptor,
+	//all messages queued for it in the same tick go out with one DESC::Packet call.
+	//SendMessage and SendMessageToEachCharacter write the queues first, so the order of the messages is kept.
+	//The game loop calls FlushDueMessages every pulse and FlushQueuedMessages at the end of a tick
+	template<typename DerivedType, typename... MessageTypes>
+	static bool QueueMessage(CHARACTER* pChar, const BasicMessage<DerivedType, MessageTypes...>& toSendMsg) {
+		if (pChar == nullptr || pChar->GetDesc() == nullptr || (!pChar->IsPC())) {
+			return false;
+		}
+		GetSendQueues().Get(pChar->GetDesc()->GetHandle()).Push(toSendMsg);
 		return true;
 	}
 
 
+	//the queues of descriptors that are gone are dropped here, RemoveSendQueue only frees them earlier
+	static void FlushQueuedMessages() {
+		GetSendQueues().RemoveIf([](const DWORD descHandle) { return DESC_MANAGER::instance().FindByHandle(descHandle) == nullptr; });
+		GetSendQueues().FlushAll();
+	}
+	static void FlushDueMessages() { GetSendQueues().FlushDue(); }
+	static void RemoveSendQueue(DESC* pDesc) { GetSendQueues().Remove(pDesc->GetHandle()); }
+
+
+	//the message is serialized once, all recipients get the same buffer
 	template<typename DerivedType, typename... MessageTypes>
-	static void SendMessageToEachCharacter(const BasicMessage<DerivedType, MessageTypes...>& toSendMsg) {
+	static std::size_t SendMessageToEach(IMessageRecipients& recipients, const BasicMessage<DerivedType, MessageTypes...>& toSendMsg) {
+		return recipients.SendToAll(SerializeShared(toSendMsg));
+	}
+
 
+	template<typename DerivedType, typename... MessageTypes>
+	static std::size_t SendMessageToEachCharacter(const BasicMessage<DerivedType, MessageTypes...>& toSendMsg) {
+		FlushQueuedMessages();
+		CharacterRecipients recipients;
+		return SendMessageToEach(recipients, toSendMsg);
 	}
 
 
 	template<typename DerivedType, typename... MessageTypes>
-	static void SendMessageToEachGameProcess(const BasicMessage<DerivedType, MessageTypes...>& toSendMsg) {
+	static std::size_t SendMessageToEachGameProcess(const BasicMessage<DerivedType, MessageTypes...>& toSendMsg) {
+		GameProcessRecipients recipients;
+		return SendMessageToEach(recipients, toSendMsg);
+	}
+
+#if defined(__linux__)
+	//the game processes on this host which opened the channel of this process get the message
+	//through shared memory, it is serialized straight into the channel. Returns false if a reader is too far behind
+	template<typename DerivedType, typename... MessageTypes>
+	static bool SendMessageToEachLocalGameProcess(SharedChannelWriter& channel, const BasicMessage<DerivedType, MessageTypes...>& toSendMsg) {
+		return channel.TryWriteMessage(toSendMsg);
+	}
+#endif
 
+private:
+	static SendQueueMap<DWORD, DescWriter>& GetSendQueues() {
+		static SendQueueMap<DWORD, DescWriter> sendQueues;
+		return sendQueues;
 	}
 };
-}
\ No newline at end of file
+}
@@ -0,0 +1,424 @@
+#pragma once
+#if defined(__linux__)
+#include <atomic>
+#include <string>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "MessageTransport.h"
+#include "MessageRecipients.h"
+#include "MessageBinarySerializer.h"
+
+//broadcast channel between processes of one host in shared memory (Linux only).
+//
+//Every sending process creates its own channel (shm_open by name or an anonymous memfd whose fd is handed over),
+//the other processes open it as readers. Each reader registers a read position in the shared header
+//and gets every message written after it joined, the writer never overwrites what a live reader hasn't read.
+//Records are 8 byte aligned : uint32 size, uint32 flags, binary serialized message.
+//Readers block on a futex in the header, the writer only wakes them (one syscall) if any is waiting.
+namespace messaging {
+namespace INTERNAL {
+	struct SharedChannelConsumer {
+		//0 free, 1 joining, 2 reading
+		std::atomic<std::uint32_t> state;
+		std::atomic<std::int32_t> pid;
+		alignas(64) std::atomic<std::uint64_t> readPos;
+	};
+
+	struct SharedChannelHeader {
+		static constexpr std::uint32_t Magic = 0x4D534843; //"CHSM"
+		static constexpr std::size_t MaxConsumers = 32;
+
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::uint64_t capacity;
+		alignas(64) std::atomic<std::uint64_t> writePos;
+		//futex word, incremented with every publish
+		std::atomic<std::uint32_t> sequence;
+		std::atomic<std::uint32_t> waiterCount;
+		alignas(64) SharedChannelConsumer consumers[MaxConsumers];
+	};
+
+	static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free,
+		"the channel needs address free atomics!!!");
+
+	constexpr std::uint32_t SharedRecordPadding = 1;
+	constexpr std::size_t SharedRecordHeaderSize = 8;
+
+	inline std::size_t GetSharedRecordSize(const std::size_t payloadSize) noexcept {
+		return SharedRecordHeaderSize + ((payloadSize + 7) & ~static_cast<std::size_t>(7));
+	}
+
+	//a power of two, at least one page
+	inline std::size_t RoundUpSharedCapacity(const std::size_t capacity) noexcept {
+		std::size_t res = 4096;
+		while (res < capacity) {
+			res <<= 1;
+		}
+		return res;
+	}
+
+	inline void ThrowSharedChannelErrno(const char* pWhat) {
+		throw std::runtime_error(std::string(pWhat) + " failed : " + std::strerror(errno) + "!!!");
+	}
+
+	//the mapping of a channel, owns the fd
+	class SharedChannelMapping final {
+	public:
+		SharedChannelMapping() = default;
+		SharedChannelMapping(const int fd, const std::size_t size) : m_fd(fd), m_size(size) {
+			m_pMemory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if (m_pMemory == MAP_FAILED) {
+				const int Error = errno;
+				::close(fd);
+				errno = Error;
+				ThrowSharedChannelErrno("mmap");
+			}
+		}
+		SharedChannelMapping(SharedChannelMapping&& other) noexcept { Swap(other); }
+		SharedChannelMapping& operator=(SharedChannelMapping&& other) noexcept {
+			Swap(other);
+			return *this;
+		}
+		~SharedChannelMapping() noexcept {
+			if (m_pMemory != nullptr) {
+				::munmap(m_pMemory, m_size);
+			}
+			if (m_fd != -1) {
+				::close(m_fd);
+			}
+		}
+
+		int GetFd() const noexcept { return m_fd; }
+		SharedChannelHeader& GetHeader() const noexcept { return *static_cast<SharedChannelHeader*>(m_pMemory); }
+		Byte* GetData() const noexcept { return static_cast<Byte*>(m_pMemory) + GetDataOffset(); }
+
+		static constexpr std::size_t GetDataOffset() noexcept { return (sizeof(SharedChannelHeader) + 4095) & ~static_cast<std::size_t>(4095); }
+
+	private:
+		void Swap(SharedChannelMapping& other) noexcept {
+			std::swap(m_fd, other.m_fd);
+			std::swap(m_pMemory, other.m_pMemory);
+			std::swap(m_size, other.m_size);
+		}
+
+		int m_fd = -1;
+		void* m_pMemory = nullptr;
+		std::size_t m_size = 0;
+	};
+}//namespace INTERNAL
+
+
+	//the single writer of a channel
+	class SharedChannelWriter final {
+	public:
+		static constexpr std::size_t DefaultCapacity = 1024 * 1024;
+
+		//creates /dev/shm/name, fails if it exists. The name stays until Unlink
+		static SharedChannelWriter Create(const char* name, const std::size_t capacity = DefaultCapacity) {
+			const int Fd = ::shm_open(name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+			if (Fd == -1) {
+				INTERNAL::ThrowSharedChannelErrno("shm_open");
+			}
+			return SharedChannelWriter(Fd, capacity);
+		}
+
+		//a channel without a name, readers get it with SharedChannelReader::FromFd (fork or SCM_RIGHTS)
+		static SharedChannelWriter CreateAnonymous(const std::size_t capacity = DefaultCapacity) {
+			const int Fd = static_cast<int>(::syscall(SYS_memfd_create, "messaging_channel", 0));
+			if (Fd == -1) {
+				INTERNAL::ThrowSharedChannelErrno("memfd_create");
+			}
+			return SharedChannelWriter(Fd, capacity);
+		}
+
+		static void Unlink(const char* name) noexcept { ::shm_unlink(name); }
+
+		SharedChannelWriter(SharedChannelWriter&&) noexcept = default;
+		SharedChannelWriter& operator=(SharedChannelWriter&&) noexcept = default;
+
+		int GetFd() const noexcept { return m_mapping.GetFd(); }
+		std::size_t GetCapacity() const noexcept { return m_capacity; }
+
+		//false if a reader is too far behind, nothing is written then
+		bool TryWrite(const ByteSpan bytes) { return TryWriteBatch(&bytes, 1) == 1; }
+
+		//writes as many spans as fit and publishes them at once, returns how many were written
+		std::size_t TryWriteBatch(const ByteSpan* pSpans, const std::size_t count) {
+			std::size_t written = 0;
+			for (; written < count; ++written) {
+				Byte* pPayload = Reserve(pSpans[written].size());
+				if (pPayload == nullptr) {
+					break;
+				}
+				std::memcpy(pPayload, pSpans[written].data(), pSpans[written].size());
+				Commit(pSpans[written].size());
+			}
+			Publish();
+			return written;
+		}
+
+		//serializes msg straight into the shared memory
+		template<typename MessageType>
+		bool TryWriteMessage(const MessageType& msg) {
+			const std::size_t MaxLen = msg.GetMessageSize();
+			Byte* pPayload = Reserve(MaxLen);
+			if (pPayload == nullptr) {
+				return false;
+			}
+			const std::size_t Len = binary_serilization::Serialize(msg, pPayload);
+			if (Len > MaxLen) {
+				throw std::runtime_error("FATAL ERROR !!! ACCESS VIOLATION!!!");
+			}
+			Commit(Len);
+			Publish();
+			return true;
+		}
+
+		std::size_t GetReaderCount() const noexcept {
+			std::size_t count = 0;
+			for (const auto& consumer : m_mapping.GetHeader().consumers) {
+				count += consumer.state.load(std::memory_order_acquire) == 2 ? 1 : 0;
+			}
+			return count;
+		}
+
+	private:
+		SharedChannelWriter(const int fd, std::size_t capacity) {
+			capacity = INTERNAL::RoundUpSharedCapacity(capacity);
+			const std::size_t Size = INTERNAL::SharedChannelMapping::GetDataOffset() + capacity;
+			if (::ftruncate(fd, static_cast<off_t>(Size)) == -1) {
+				const int Error = errno;
+				::close(fd);
+				errno = Error;
+				INTERNAL::ThrowSharedChannelErrno("ftruncate");
+			}
+			m_mapping = INTERNAL::SharedChannelMapping(fd, Size);
+			m_capacity = capacity;
+			//the fresh mapping is zeroed, which is the initial state of all atomics
+			INTERNAL::SharedChannelHeader& header = m_mapping.GetHeader();
+			header.capacity = capacity;
+			header.version = 1;
+			std::atomic_thread_fence(std::memory_order_release);
+			header.magic = INTERNAL::SharedChannelHeader::Magic;
+		}
+
+		//room for a record with up to maxLen payload bytes, nullptr if the slowest reader is in the way
+		Byte* Reserve(const std::size_t maxLen) {
+			const std::size_t RecordSize = INTERNAL::GetSharedRecordSize(maxLen);
+			const std::size_t Offset = m_writePos & (m_capacity - 1);
+			//a record never wraps, the rest of the ring is skipped with a padding record
+			const std::size_t Padding = m_capacity - Offset < RecordSize ? m_capacity - Offset : 0;
+			if (Padding + RecordSize > m_capacity) {
+				throw std::runtime_error("message is bigger than the shared channel!!!");
+			}
+			if (!HasRoom(Padding + RecordSize)) {
+				return nullptr;
+			}
+			Byte* pData = m_mapping.GetData();
+			if (Padding != 0) {
+				const std::uint32_t Header[2] = { static_cast<std::uint32_t>(Padding), INTERNAL::SharedRecordPadding };
+				std::memcpy(pData + Offset, Header, sizeof(Header));
+				m_writePos += Padding;
+			}
+			return pData + (m_writePos & (m_capacity - 1)) + INTERNAL::SharedRecordHeaderSize;
+		}
+
+		void Commit(const std::size_t len) noexcept {
+			const std::uint32_t Header[2] = { static_cast<std::uint32_t>(len), 0 };
+			std::memcpy(m_mapping.GetData() + (m_writePos & (m_capacity - 1)), Header, sizeof(Header));
+			m_writePos += INTERNAL::GetSharedRecordSize(len);
+		}
+
+		void Publish() noexcept {
+			INTERNAL::SharedChannelHeader& header = m_mapping.GetHeader();
+			if (header.writePos.load(std::memory_order_relaxed) == m_writePos) {
+				return;
+			}
+			header.writePos.store(m_writePos, std::memory_order_release);
+			header.sequence.fetch_add(1, std::memory_order_seq_cst);
+			if (header.waiterCount.load(std::memory_order_seq_cst) != 0) {
+				::syscall(SYS_futex, &header.sequence, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+			}
+		}
+
+		bool HasRoom(const std::size_t len) noexcept {
+			if (m_writePos + len - m_minReadPos <= m_capacity) {
+				return true;
+			}
+			m_minReadPos = GetMinReadPos(false);
+			if (m_writePos + len - m_minReadPos <= m_capacity) {
+				return true;
+			}
+			//a crashed reader must not block the channel forever
+			m_minReadPos = GetMinReadPos(true);
+			return m_writePos + len - m_minReadPos <= m_capacity;
+		}
+
+		std::uint64_t GetMinReadPos(const bool removeDead) noexcept {
+			//not m_writePos : a reader joining now starts at the published position
+			std::uint64_t minPos = m_mapping.GetHeader().writePos.load(std::memory_order_relaxed);
+			for (auto& consumer : m_mapping.GetHeader().consumers) {
+				if (consumer.state.load(std::memory_order_acquire) != 2) {
+					continue;
+				}
+				if (removeDead && ::kill(consumer.pid.load(std::memory_order_relaxed), 0) == -1 && errno == ESRCH) {
+					consumer.state.store(0, std::memory_order_release);
+					continue;
+				}
+				minPos = (std::min)(minPos, static_cast<std::uint64_t>(consumer.readPos.load(std::memory_order_acquire)));
+			}
+			return minPos;
+		}
+
+		INTERNAL::SharedChannelMapping m_mapping;
+		std::size_t m_capacity = 0;
+		std::uint64_t m_writePos = 0;
+		std::uint64_t m_minReadPos = 0;
+	};
+
+
+	//one reading process of a channel, receives everything written after it was opened
+	class SharedChannelReader final {
+	public:
+		static SharedChannelReader Open(const char* name) {
+			const int Fd = ::shm_open(name, O_RDWR | O_CLOEXEC, 0);
+			if (Fd == -1) {
+				INTERNAL::ThrowSharedChannelErrno("shm_open");
+			}
+			return SharedChannelReader(Fd);
+		}
+
+		//the fd is duplicated, the caller keeps its own
+		static SharedChannelReader FromFd(const int fd) {
+			const int Fd = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+			if (Fd == -1) {
+				INTERNAL::ThrowSharedChannelErrno("fcntl");
+			}
+			return SharedChannelReader(Fd);
+		}
+
+		SharedChannelReader(SharedChannelReader&& other) noexcept
+			: m_mapping(std::move(other.m_mapping)), m_pConsumer(other.m_pConsumer), m_capacity(other.m_capacity), m_readPos(other.m_readPos) {
+			other.m_pConsumer = nullptr;
+		}
+		SharedChannelReader& operator=(SharedChannelReader&&) = delete;
+		~SharedChannelReader() noexcept {
+			if (m_pConsumer != nullptr) {
+				m_pConsumer->state.store(0, std::memory_order_release);
+			}
+		}
+
+		//calls handler(ByteSpan) for up to maxCount messages, the bytes point into the shared memory
+		//and stay valid until Read returns. Returns the number of messages
+		template<typename FuncType>
+		std::size_t Read(FuncType&& handler, const std::size_t maxCount = SIZE_MAX) {
+			INTERNAL::SharedChannelHeader& header = m_mapping.GetHeader();
+			const std::uint64_t WritePos = header.writePos.load(std::memory_order_acquire);
+			const Byte* pData = m_mapping.GetData();
+			std::size_t count = 0;
+			while (m_readPos != WritePos && count < maxCount) {
+				std::uint32_t recordHeader[2];
+				std::memcpy(recordHeader, pData + (m_readPos & (m_capacity - 1)), sizeof(recordHeader));
+				if (recordHeader[1] == INTERNAL::SharedRecordPadding) {
+					m_readPos += recordHeader[0];
+					continue;
+				}
+				handler(ByteSpan(pData + (m_readPos & (m_capacity - 1)) + INTERNAL::SharedRecordHeaderSize, recordHeader[0]));
+				m_readPos += INTERNAL::GetSharedRecordSize(recordHeader[0]);
+				++count;
+			}
+			//one release for the whole batch, the writer may reuse the memory from now on
+			m_pConsumer->readPos.store(m_readPos, std::memory_order_release);
+			return count;
+		}
+
+		bool HasMessages() const noexcept { return m_mapping.GetHeader().writePos.load(std::memory_order_acquire) != m_readPos; }
+
+		//blocks until a message is there or timeoutMs passed (-1 forever), true if there is one
+		bool Wait(const int timeoutMs) {
+			INTERNAL::SharedChannelHeader& header = m_mapping.GetHeader();
+			const std::uint32_t Sequence = header.sequence.load(std::memory_order_seq_cst);
+			if (HasMessages()) {
+				return true;
+			}
+			timespec timeout{ timeoutMs / 1000, (timeoutMs % 1000) * 1000000L };
+			header.waiterCount.fetch_add(1, std::memory_order_seq_cst);
+			if (header.sequence.load(std::memory_order_seq_cst) == Sequence) {
+				::syscall(SYS_futex, &header.sequence, FUTEX_WAIT, Sequence, timeoutMs < 0 ? nullptr : &timeout, nullptr, 0);
+			}
+			header.waiterCount.fetch_sub(1, std::memory_order_seq_cst);
+			return HasMessages();
+		}
+
+	private:
+		explicit SharedChannelReader(const int fd) {
+			struct stat info{};
+			if (::fstat(fd, &info) == -1 || static_cast<std::size_t>(info.st_size) <= INTERNAL::SharedChannelMapping::GetDataOffset()) {
+				::close(fd);
+				throw std::runtime_error("not a shared message channel!!!");
+			}
+			const auto Size = static_cast<std::size_t>(info.st_size);
+			m_mapping = INTERNAL::SharedChannelMapping(fd, Size);
+			INTERNAL::SharedChannelHeader& header = m_mapping.GetHeader();
+			if (header.magic != INTERNAL::SharedChannelHeader::Magic) {
+				throw std::runtime_error("not a shared message channel!!!");
+			}
+			//the ring has to lie inside the mapping and be a power of two, every offset is masked with capacity - 1
+			const std::uint64_t Capacity = header.capacity;
+			if (Capacity == 0 || (Capacity & (Capacity - 1)) != 0 || Capacity > Size - INTERNAL::SharedChannelMapping::GetDataOffset()) {
+				throw std::runtime_error("the shared message channel has an invalid capacity!!!");
+			}
+			m_capacity = static_cast<std::size_t>(Capacity);
+			for (auto& consumer : header.consumers) {
+				std::uint32_t expected = 0;
+				if (consumer.state.compare_exchange_strong(expected, 1, std::memory_order_acq_rel)) {
+					m_pConsumer = &consumer;
+					break;
+				}
+			}
+			if (m_pConsumer == nullptr) {
+				throw std::runtime_error("too many readers on the shared channel!!!");
+			}
+			m_pConsumer->pid.store(static_cast<std::int32_t>(::getpid()), std::memory_order_relaxed);
+			m_pConsumer->readPos.store(header.writePos.load(std::memory_order_acquire), std::memory_order_relaxed);
+			m_pConsumer->state.store(2, std::memory_order_seq_cst);
+			//the writer may have passed the position before it saw the reader, start behind its latest write
+			m_readPos = header.writePos.load(std::memory_order_seq_cst);
+			m_pConsumer->readPos.store(m_readPos, std::memory_order_release);
+		}
+
+		INTERNAL::SharedChannelMapping m_mapping;
+		INTERNAL::SharedChannelConsumer* m_pConsumer = nullptr;
+		std::size_t m_capacity = 0;
+		std::uint64_t m_readPos = 0;
+	};
+
+
+	//the readers of a channel as recipients of MessageSender::SendMessageToEach,
+	//every reader process gets the message with one write into the shared memory
+	class SharedChannelRecipients final : public IMessageRecipients {
+	public:
+		explicit SharedChannelRecipients(SharedChannelWriter& writer) noexcept : m_writer(writer) {}
+
+		virtual std::size_t SendToAll(const SharedMessageBuffer& buffer) override {
+			return m_writer.TryWrite(ByteSpan(*buffer)) ? m_writer.GetReaderCount() : 0;
+		}
+
+	private:
+		SharedChannelWriter& m_writer;
+	};
+}//namespace messaging
+#endif
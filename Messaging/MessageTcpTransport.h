@@ -0,0 +1,1056 @@
+#pragma once
+#if defined(__linux__)
+#include <deque>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "MessageTransport.h"
+#include "MessageBinaryDeserializer.h"
+#include "MessageBinarySerializer.h"
+#include "MessageIoUring.h"
+
+//Non blocking TCP transport on top of epoll (Linux only).
+//
+//Every message travels as one frame : uint32 payload size, payload (the binary serialized message).
+//Reads are edge triggered and drain the socket into a ring buffer per connection,
+//sends go out directly with one vectored sendmsg and only what the socket doesn't take is buffered.
+//
+//With the io_uring backend accept and connect stay on epoll, established connections are served by the ring :
+//one receive per connection is always queued into a registered receive slot (READ_FIXED),
+//frames are serialized straight into pooled send buffers and every connection has at most one sendmsg
+//in flight which covers all filled buffers, frames sent meanwhile are packed behind each other and go out with the next one.
+//All sends and receives queued during a Poll are handed to the kernel with a single io_uring_enter.
+//Unlike with epoll a Send doesn't write to the socket right away, the frame goes out with the next Poll
+//and send errors show up there as well. The sockets stay non blocking with both backends.
+namespace messaging {
+
+	//byte ring with a power of two capacity, grows when an append doesn't fit
+	class ByteRingBuffer final {
+	public:
+		explicit ByteRingBuffer(const std::size_t capacity = 4096) : m_data(RoundUpCapacity(capacity)) {}
+
+		std::size_t size() const noexcept { return m_tail - m_head; }
+		bool empty() const noexcept { return m_tail == m_head; }
+		std::size_t capacity() const noexcept { return m_data.size(); }
+
+		void Reserve(const std::size_t freeBytes) {
+			if (capacity() - size() >= freeBytes) {
+				return;
+			}
+			std::vector<Byte> data(RoundUpCapacity(size() + freeBytes));
+			const std::size_t Size = size();
+			Peek(data.data(), 0, Size);
+			m_data.swap(data);
+			m_head = 0;
+			m_tail = Size;
+		}
+
+		//contiguous free space behind the data, Commit how much was written into it
+		Byte* GetWritePtr(std::size_t& len) noexcept {
+			const std::size_t Pos = m_tail & GetMask();
+			len = (std::min)(capacity() - size(), capacity() - Pos);
+			return m_data.data() + Pos;
+		}
+
+		void Commit(const std::size_t len) noexcept { m_tail += len; }
+
+		void Append(const Byte* pData, const std::size_t len) {
+			Reserve(len);
+			const std::size_t Pos = m_tail & GetMask();
+			const std::size_t FirstLen = (std::min)(len, capacity() - Pos);
+			std::memcpy(m_data.data() + Pos, pData, FirstLen);
+			std::memcpy(m_data.data(), pData + FirstLen, len - FirstLen);
+			m_tail += len;
+		}
+
+		//the readable bytes in order, the second segment is empty unless the data wraps around
+		void GetReadSegments(ByteSpan (&segments)[2]) const noexcept {
+			const std::size_t Pos = m_head & GetMask();
+			const std::size_t FirstLen = (std::min)(size(), capacity() - Pos);
+			segments[0] = ByteSpan(m_data.data() + Pos, FirstLen);
+			segments[1] = ByteSpan(m_data.data(), size() - FirstLen);
+		}
+
+		//contiguous pointer to len bytes at offset, nullptr if they wrap around
+		const Byte* GetContiguous(const std::size_t offset, const std::size_t len) const noexcept {
+			const std::size_t Pos = (m_head + offset) & GetMask();
+			return Pos + len <= capacity() ? m_data.data() + Pos : nullptr;
+		}
+
+		void Peek(Byte* pDestination, const std::size_t offset, const std::size_t len) const noexcept {
+			const std::size_t Pos = (m_head + offset) & GetMask();
+			const std::size_t FirstLen = (std::min)(len, capacity() - Pos);
+			std::memcpy(pDestination, m_data.data() + Pos, FirstLen);
+			std::memcpy(pDestination + FirstLen, m_data.data(), len - FirstLen);
+		}
+
+		void Consume(const std::size_t len) noexcept {
+			m_head += len;
+			if (m_head == m_tail) {
+				m_head = 0;
+				m_tail = 0;
+			}
+		}
+
+	private:
+		static std::size_t RoundUpCapacity(const std::size_t capacity) noexcept {
+			std::size_t res = 64;
+			while (res < capacity) {
+				res <<= 1;
+			}
+			return res;
+		}
+
+		std::size_t GetMask() const noexcept { return m_data.size() - 1; }
+
+		std::vector<Byte> m_data;
+		std::size_t m_head = 0;
+		std::size_t m_tail = 0;
+	};
+
+
+	enum class TcpBackend {
+		Epoll,
+		IoUring,
+		//io_uring if the kernel supports it, epoll otherwise. Sends are deferred to the next Poll with io_uring
+		Auto
+	};
+
+
+	class TcpEventLoop;
+
+	//one TCP connection of a TcpEventLoop, every Send is one frame
+	class TcpConnection final : public ITransport {
+	public:
+		using FrameSizeType = INTERNAL::SerializedSizeDataType;
+
+		TcpConnection(const TcpConnection&) = delete;
+		TcpConnection& operator=(const TcpConnection&) = delete;
+		virtual ~TcpConnection() noexcept override {
+			if (m_socket != -1) {
+				::close(m_socket);
+			}
+		}
+
+		virtual void Send(const ByteSpan bytes) override { SendBatch(&bytes, 1); }
+		//all frames with a single sendmsg as long as the socket takes them
+		virtual void SendBatch(const ByteSpan* pSpans, const std::size_t count) override;
+		//serializes msg straight into the send memory of the connection, no copy of the serialized message is made
+		template<typename MessageType>
+		void SendMessage(const MessageType& msg);
+
+		int GetSocket() const noexcept { return m_socket; }
+		bool IsOpen() const noexcept { return m_isOpen; }
+		bool IsConnecting() const noexcept { return m_isConnecting; }
+		//bytes waiting for the socket to become writable
+		std::size_t GetPendingBytes() const noexcept;
+
+	private:
+		friend TcpEventLoop;
+
+		//io_uring send memory, a buffer of the send pool or a heap buffer if the pool is empty
+		struct SendChunk {
+			int poolIndex = -1;
+			std::vector<Byte> heap;
+			Byte* pData = nullptr;
+			std::size_t capacity = 0;
+			std::size_t size = 0;
+			std::size_t offset = 0;
+		};
+
+		TcpConnection(TcpEventLoop& loop, const int socket, const bool isConnecting) noexcept
+			: m_loop(loop), m_socket(socket), m_isConnecting(isConnecting) {}
+
+		//room for a frame of len bytes (size header included), CommitFrame sends it
+		Byte* AcquireFrame(const std::size_t len);
+		void CommitFrame(Byte* pFrame, const std::size_t payloadLen);
+		void WriteOrBuffer(iovec* pIovecs, const std::size_t count, const std::size_t totalLen);
+		//writes iovecs until everything is written or the socket is full, returns the written bytes
+		std::size_t WriteVectored(iovec* pIovecs, std::size_t count);
+		void FlushWriteBuffer();
+
+		TcpEventLoop& m_loop;
+		int m_socket;
+		bool m_isConnecting;
+		bool m_isOpen = true;
+		bool m_isClosing = false;
+		ByteRingBuffer m_readBuffer;
+		ByteRingBuffer m_writeBuffer;
+		std::vector<FrameSizeType> m_headers;
+		//the frames of SendBatch, with io_uring the chunks of the send in flight
+		std::vector<iovec> m_iovecs;
+		//io_uring state
+		int m_receiveSlot = -1;
+		bool m_isReceiveInFlight = false;
+		std::size_t m_sendInFlightChunks = 0;
+		msghdr m_sendHeader{};
+		bool m_isSendPending = false;
+		bool m_isShutdown = false;
+		std::deque<SendChunk> m_sendChunks;
+	};
+
+
+	class TcpEventLoop final {
+	public:
+		using FrameHandler = std::function<void(TcpConnection&, ByteSpan)>;
+		using ConnectionHandler = std::function<void(TcpConnection&)>;
+
+		static constexpr std::size_t DefaultMaxFrameSize = 16 * 1024 * 1024;
+		//io_uring backend, ReceiveSlotCount * ReceiveSlotSize are registered with the ring, SendBufferCount * SendBufferSize are pooled
+		static constexpr unsigned UringQueueDepth = 256;
+		static constexpr std::size_t ReceiveSlotCount = 64;
+		static constexpr std::size_t ReceiveSlotSize = 16 * 1024;
+		static constexpr std::size_t SendBufferCount = 128;
+		static constexpr std::size_t SendBufferSize = 16 * 1024;
+		static constexpr std::size_t MaxSendIovecs = 64;
+		static constexpr unsigned UringRoundsPerPoll = 16;
+
+		//TcpBackend::IoUring throws if io_uring can't be used, Auto falls back to epoll
+		explicit TcpEventLoop(const std::size_t maxFrameSize = DefaultMaxFrameSize, const TcpBackend backend = TcpBackend::Auto);
+		~TcpEventLoop() noexcept;
+
+		TcpEventLoop(const TcpEventLoop&) = delete;
+		TcpEventLoop& operator=(const TcpEventLoop&) = delete;
+
+		//returns the bound port, port 0 picks a free one.
+		//With isSharedPort several loops (e.g. one per thread) listen on the same port and the kernel spreads the connections
+		std::uint16_t Listen(const std::uint16_t port, const char* address = "0.0.0.0", const int backlog = SOMAXCONN, const bool isSharedPort = false);
+		//frames sent before the connection is established are buffered
+		TcpConnection& Connect(const char* address, const std::uint16_t port);
+
+		//called for every received frame, the payload is only valid during the call
+		void SetFrameHandler(FrameHandler handler) { m_frameHandler = std::move(handler); }
+		//accepted connections and outgoing ones once they are established
+		void SetConnectHandler(ConnectionHandler handler) { m_connectHandler = std::move(handler); }
+		void SetDisconnectHandler(ConnectionHandler handler) { m_disconnectHandler = std::move(handler); }
+
+		//waits up to timeoutMs (-1 forever) for events and handles them, returns the number of received frames
+		std::size_t Poll(const int timeoutMs);
+		//lets a waiting Poll return, the only member which may be called from another thread
+		void Wake() noexcept;
+
+		//the connection is destroyed by the next Poll, with io_uring once its queued operations completed
+		void Close(TcpConnection& connection);
+
+		std::size_t GetConnectionCount() const noexcept { return m_connections.size(); }
+		TcpBackend GetBackend() const noexcept { return m_pRing != nullptr ? TcpBackend::IoUring : TcpBackend::Epoll; }
+
+	private:
+		friend TcpConnection;
+
+		enum UringOperation : std::uint64_t {
+			UringReceive = 1,
+			UringSend = 2
+		};
+
+		void Accept();
+		TcpConnection& AddConnection(const int socket, const bool isConnecting);
+		void HandleEvent(TcpConnection& connection, const std::uint32_t events, std::size_t& frameCount);
+		bool ReadAll(TcpConnection& connection);
+		std::size_t DispatchFrames(TcpConnection& connection);
+		//frames in contiguous memory, returns the consumed bytes
+		std::size_t DispatchFrames(TcpConnection& connection, const Byte* pData, const std::size_t len, std::size_t& frameCount);
+		void DestroyClosed();
+
+		void InitUring();
+		io_uring_sqe* GetSqe();
+		void StartReceiving(TcpConnection& connection);
+		void QueueReceive(TcpConnection& connection);
+		void QueueSend(TcpConnection& connection);
+		void MarkSendPending(TcpConnection& connection);
+		void FlushPendingSends();
+		unsigned ReapCompletions(std::size_t& frameCount);
+		std::size_t HandleReceived(TcpConnection& connection, const int result);
+		void HandleSent(TcpConnection& connection, const int result);
+		void ReleaseSendChunks(TcpConnection& connection);
+
+		static void ThrowErrno(const char* pWhat) {
+			throw std::runtime_error(std::string(pWhat) + " failed : " + std::strerror(errno) + "!!!");
+		}
+
+		static sockaddr_in CreateAddress(const char* address, const std::uint16_t port) {
+			sockaddr_in addr{};
+			addr.sin_family = AF_INET;
+			addr.sin_port = htons(port);
+			if (::inet_pton(AF_INET, address, &addr.sin_addr) != 1) {
+				throw std::runtime_error(std::string("invalid IPv4 address ") + address + "!!!");
+			}
+			return addr;
+		}
+
+		int m_epoll = -1;
+		int m_wakeEvent = -1;
+		int m_listenSocket = -1;
+		std::unique_ptr<INTERNAL::IoUring> m_pRing;
+		std::unique_ptr<INTERNAL::FixedBufferPool> m_pReceivePool;
+		std::unique_ptr<INTERNAL::FixedBufferPool> m_pSendPool;
+		std::size_t m_inFlightCount = 0;
+		std::vector<int> m_pendingSends;
+		std::size_t m_maxFrameSize;
+		std::unordered_map<int, std::unique_ptr<TcpConnection>> m_connections;
+		std::vector<int> m_closed;
+		std::vector<Byte> m_frameScratch;
+		FrameHandler m_frameHandler;
+		ConnectionHandler m_connectHandler;
+		ConnectionHandler m_disconnectHandler;
+	};
+
+
+	//picked over the ITransport overload, the message is serialized into the send memory of the connection
+	template<typename MessageType>
+	inline void TransmitMessage(TcpConnection& connection, const MessageType& msg) {
+		connection.SendMessage(msg);
+	}
+}//namespace messaging
+
+
+inline void messaging::TcpConnection::SendBatch(const ByteSpan* pSpans, const std::size_t count) {
+	if (!m_isOpen || count == 0) {
+		return;
+	}
+	if (m_loop.m_pRing != nullptr) {
+		for (std::size_t i = 0; i < count; ++i) {
+			Byte* pFrame = AcquireFrame(sizeof(FrameSizeType) + pSpans[i].size());
+			std::memcpy(pFrame + sizeof(FrameSizeType), pSpans[i].data(), pSpans[i].size());
+			CommitFrame(pFrame, pSpans[i].size());
+		}
+		return;
+	}
+	m_headers.resize(count);
+	m_iovecs.resize(count * 2);
+	std::size_t totalLen = 0;
+	for (std::size_t i = 0; i < count; ++i) {
+		m_headers[i] = static_cast<FrameSizeType>(pSpans[i].size());
+		m_iovecs[i * 2] = iovec{ &m_headers[i], sizeof(FrameSizeType) };
+		m_iovecs[i * 2 + 1] = iovec{ const_cast<Byte*>(pSpans[i].data()), pSpans[i].size() };
+		totalLen += sizeof(FrameSizeType) + pSpans[i].size();
+	}
+	WriteOrBuffer(m_iovecs.data(), m_iovecs.size(), totalLen);
+}
+
+
+template<typename MessageType>
+inline void messaging::TcpConnection::SendMessage(const MessageType& msg) {
+	if (!m_isOpen) {
+		return;
+	}
+	const std::size_t MaxLen = msg.GetMessageSize();
+	Byte* pFrame = AcquireFrame(sizeof(FrameSizeType) + MaxLen);
+	const std::size_t Len = binary_serilization::Serialize(msg, pFrame + sizeof(FrameSizeType));
+	if (Len > MaxLen) {
+		throw std::runtime_error("FATAL ERROR !!! ACCESS VIOLATION!!!");
+	}
+	CommitFrame(pFrame, Len);
+}
+
+
+inline messaging::Byte* messaging::TcpConnection::AcquireFrame(const std::size_t len) {
+	if (m_loop.m_pRing == nullptr) {
+		auto& buffer = INTERNAL::GetTransmitBuffer();
+		buffer.resize(len);
+		return buffer.data();
+	}
+	//the chunks in flight are the front ones and must not change until their send completed
+	const bool IsBackInFlight = m_sendInFlightChunks != 0 && m_sendInFlightChunks == m_sendChunks.size();
+	if (m_sendChunks.empty() || IsBackInFlight || m_sendChunks.back().capacity - m_sendChunks.back().size < len) {
+		INTERNAL::FixedBufferPool& pool = *m_loop.m_pSendPool;
+		m_sendChunks.emplace_back();
+		SendChunk& chunk = m_sendChunks.back();
+		chunk.poolIndex = len <= pool.GetBufferSize() ? pool.Acquire() : -1;
+		if (chunk.poolIndex != -1) {
+			chunk.pData = pool.Get(chunk.poolIndex);
+			chunk.capacity = pool.GetBufferSize();
+		} else {
+			chunk.heap.resize((std::max)(len, pool.GetBufferSize()));
+			chunk.pData = chunk.heap.data();
+			chunk.capacity = chunk.heap.size();
+		}
+	}
+	return m_sendChunks.back().pData + m_sendChunks.back().size;
+}
+
+
+inline void messaging::TcpConnection::CommitFrame(Byte* pFrame, const std::size_t payloadLen) {
+	const auto Header = static_cast<FrameSizeType>(payloadLen);
+	std::memcpy(pFrame, &Header, sizeof(FrameSizeType));
+	if (m_loop.m_pRing == nullptr) {
+		iovec vec{ pFrame, sizeof(FrameSizeType) + payloadLen };
+		WriteOrBuffer(&vec, 1, vec.iov_len);
+		return;
+	}
+	m_sendChunks.back().size += sizeof(FrameSizeType) + payloadLen;
+	m_loop.MarkSendPending(*this);
+}
+
+
+inline void messaging::TcpConnection::WriteOrBuffer(iovec* pIovecs, const std::size_t count, const std::size_t totalLen) {
+	//frames queued earlier have to go out first
+	std::size_t written = 0;
+	if (!m_isConnecting && m_writeBuffer.empty()) {
+		written = WriteVectored(pIovecs, count);
+	}
+	if (written == totalLen || !m_isOpen) {
+		return;
+	}
+	//WriteVectored may have moved the start of an iovec but never its end,
+	//so the unwritten bytes are the tail of the iovecs
+	const std::size_t Remaining = totalLen - written;
+	std::size_t first = count;
+	std::size_t tailLen = 0;
+	while (tailLen < Remaining) {
+		--first;
+		tailLen += pIovecs[first].iov_len;
+	}
+	m_writeBuffer.Reserve(Remaining);
+	std::size_t skip = tailLen - Remaining;
+	for (std::size_t i = first; i < count; ++i) {
+		m_writeBuffer.Append(static_cast<const Byte*>(pIovecs[i].iov_base) + skip, pIovecs[i].iov_len - skip);
+		skip = 0;
+	}
+}
+
+
+inline std::size_t messaging::TcpConnection::GetPendingBytes() const noexcept {
+	std::size_t pending = m_writeBuffer.size();
+	for (const SendChunk& chunk : m_sendChunks) {
+		pending += chunk.size - chunk.offset;
+	}
+	return pending;
+}
+
+
+inline std::size_t messaging::TcpConnection::WriteVectored(iovec* pIovecs, std::size_t count) {
+	std::size_t total = 0;
+	while (count != 0) {
+		msghdr header{};
+		header.msg_iov = pIovecs;
+		header.msg_iovlen = (std::min)(count, static_cast<std::size_t>(IOV_MAX));
+		const ssize_t Result = ::sendmsg(m_socket, &header, MSG_NOSIGNAL);
+		if (Result < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				//e.g. EPIPE or ECONNRESET, the next Poll destroys the connection and calls the disconnect handler
+				m_loop.Close(*this);
+			}
+			return total;
+		}
+		total += static_cast<std::size_t>(Result);
+		std::size_t rest = static_cast<std::size_t>(Result);
+		while (count != 0 && rest >= pIovecs->iov_len) {
+			rest -= pIovecs->iov_len;
+			++pIovecs;
+			--count;
+		}
+		if (count != 0 && rest != 0) {
+			//partially written iovec, the socket is full
+			pIovecs->iov_base = static_cast<Byte*>(pIovecs->iov_base) + rest;
+			pIovecs->iov_len -= rest;
+			return total;
+		}
+	}
+	return total;
+}
+
+
+inline void messaging::TcpConnection::FlushWriteBuffer() {
+	while (m_isOpen && !m_writeBuffer.empty()) {
+		ByteSpan segments[2];
+		m_writeBuffer.GetReadSegments(segments);
+		iovec iovecs[2] = {
+			iovec{ const_cast<Byte*>(segments[0].data()), segments[0].size() },
+			iovec{ const_cast<Byte*>(segments[1].data()), segments[1].size() }
+		};
+		const std::size_t Written = WriteVectored(iovecs, segments[1].empty() ? 1 : 2);
+		m_writeBuffer.Consume(Written);
+		if (Written != segments[0].size() + segments[1].size()) {
+			return;
+		}
+	}
+}
+
+
+inline messaging::TcpEventLoop::TcpEventLoop(const std::size_t maxFrameSize, const TcpBackend backend) : m_maxFrameSize(maxFrameSize) {
+	m_epoll = ::epoll_create1(EPOLL_CLOEXEC);
+	if (m_epoll == -1) {
+		ThrowErrno("epoll_create1");
+	}
+	m_wakeEvent = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.fd = m_wakeEvent;
+	if (m_wakeEvent == -1 || ::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeEvent, &event) == -1) {
+		const int Error = errno;
+		if (m_wakeEvent != -1) {
+			::close(m_wakeEvent);
+		}
+		::close(m_epoll);
+		errno = Error;
+		ThrowErrno("eventfd");
+	}
+	if (backend == TcpBackend::Epoll) {
+		return;
+	}
+	try {
+		InitUring();
+	} catch (const std::runtime_error&) {
+		m_pRing.reset();
+		m_pReceivePool.reset();
+		m_pSendPool.reset();
+		if (backend == TcpBackend::IoUring) {
+			::close(m_wakeEvent);
+			::close(m_epoll);
+			throw;
+		}
+	}
+}
+
+
+inline messaging::TcpEventLoop::~TcpEventLoop() noexcept {
+	if (m_pRing != nullptr) {
+		//the kernel may still write into the buffers of the queued operations, wait for all of them
+		for (const auto& entry : m_connections) {
+			::shutdown(entry.first, SHUT_RDWR);
+		}
+		try {
+			m_pRing->Submit();
+			while (m_inFlightCount != 0) {
+				m_pRing->Submit(1);
+				m_inFlightCount -= m_pRing->ForEachCompletion([](const io_uring_cqe&) {});
+			}
+		} catch (const std::runtime_error&) {
+		}
+	}
+	m_connections.clear();
+	m_pRing.reset();
+	if (m_listenSocket != -1) {
+		::close(m_listenSocket);
+	}
+	::close(m_wakeEvent);
+	::close(m_epoll);
+}
+
+
+inline std::uint16_t messaging::TcpEventLoop::Listen(const std::uint16_t port, const char* address, const int backlog, const bool isSharedPort) {
+	if (m_listenSocket != -1) {
+		throw std::runtime_error("TcpEventLoop is already listening!!!");
+	}
+	const sockaddr_in Addr = CreateAddress(address, port);
+	const int Socket = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (Socket == -1) {
+		ThrowErrno("socket");
+	}
+	const int On = 1;
+	::setsockopt(Socket, SOL_SOCKET, SO_REUSEADDR, &On, sizeof(On));
+	if (isSharedPort) {
+		::setsockopt(Socket, SOL_SOCKET, SO_REUSEPORT, &On, sizeof(On));
+	}
+	sockaddr_in bound{};
+	socklen_t boundLen = sizeof(bound);
+	if (::bind(Socket, reinterpret_cast<const sockaddr*>(&Addr), sizeof(Addr)) == -1
+		|| ::listen(Socket, backlog) == -1
+		|| ::getsockname(Socket, reinterpret_cast<sockaddr*>(&bound), &boundLen) == -1) {
+		const int Error = errno;
+		::close(Socket);
+		errno = Error;
+		ThrowErrno("bind/listen");
+	}
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.fd = Socket;
+	if (::epoll_ctl(m_epoll, EPOLL_CTL_ADD, Socket, &event) == -1) {
+		::close(Socket);
+		ThrowErrno("epoll_ctl");
+	}
+	m_listenSocket = Socket;
+	return ntohs(bound.sin_port);
+}
+
+
+inline messaging::TcpConnection& messaging::TcpEventLoop::Connect(const char* address, const std::uint16_t port) {
+	const sockaddr_in Addr = CreateAddress(address, port);
+	const int Socket = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (Socket == -1) {
+		ThrowErrno("socket");
+	}
+	const int Result = ::connect(Socket, reinterpret_cast<const sockaddr*>(&Addr), sizeof(Addr));
+	if (Result == -1 && errno != EINPROGRESS) {
+		const int Error = errno;
+		::close(Socket);
+		errno = Error;
+		ThrowErrno("connect");
+	}
+	TcpConnection& connection = AddConnection(Socket, Result == -1);
+	if (!connection.IsConnecting() && m_connectHandler) {
+		m_connectHandler(connection);
+	}
+	return connection;
+}
+
+
+inline void messaging::TcpEventLoop::Close(TcpConnection& connection) {
+	connection.m_isOpen = false;
+	if (!connection.m_isClosing) {
+		connection.m_isClosing = true;
+		m_closed.push_back(connection.m_socket);
+	}
+}
+
+
+inline std::size_t messaging::TcpEventLoop::Poll(const int timeoutMs) {
+	if (m_pRing != nullptr) {
+		//frames sent since the last Poll
+		FlushPendingSends();
+		m_pRing->Submit();
+	}
+	epoll_event events[64];
+	int count = ::epoll_wait(m_epoll, events, 64, timeoutMs);
+	if (count == -1) {
+		if (errno != EINTR) {
+			ThrowErrno("epoll_wait");
+		}
+		count = 0;
+	}
+	std::size_t frameCount = 0;
+	for (int i = 0; i < count; ++i) {
+		if (events[i].data.fd == m_listenSocket) {
+			Accept();
+			continue;
+		}
+		if (events[i].data.fd == m_wakeEvent) {
+			std::uint64_t wakeCount = 0;
+			(void)::read(m_wakeEvent, &wakeCount, sizeof(wakeCount));
+			continue;
+		}
+		if (m_pRing != nullptr && events[i].data.fd == m_pRing->GetFd()) {
+			ReapCompletions(frameCount);
+			continue;
+		}
+		const auto It = m_connections.find(events[i].data.fd);
+		if (It != m_connections.end() && It->second->m_isOpen) {
+			HandleEvent(*It->second, events[i].events, frameCount);
+		}
+	}
+	if (m_pRing != nullptr) {
+		//submits the receives queued again and the frames sent by the handlers, what completes right away
+		//(data already in the socket) is handled in the same Poll, bounded so busy connections can't block it
+		for (unsigned round = 0; round < UringRoundsPerPoll; ++round) {
+			FlushPendingSends();
+			m_pRing->Submit();
+			if (ReapCompletions(frameCount) == 0) {
+				break;
+			}
+		}
+	}
+	DestroyClosed();
+	return frameCount;
+}
+
+
+inline void messaging::TcpEventLoop::Wake() noexcept {
+	const std::uint64_t One = 1;
+	(void)::write(m_wakeEvent, &One, sizeof(One));
+}
+
+
+inline void messaging::TcpEventLoop::Accept() {
+	for (;;) {
+		const int Socket = ::accept4(m_listenSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (Socket == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return;
+		}
+		TcpConnection& connection = AddConnection(Socket, false);
+		if (m_connectHandler) {
+			m_connectHandler(connection);
+		}
+	}
+}
+
+
+inline messaging::TcpConnection& messaging::TcpEventLoop::AddConnection(const int socket, const bool isConnecting) {
+	const int On = 1;
+	::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &On, sizeof(On));
+	std::unique_ptr<TcpConnection> connection(new TcpConnection(*this, socket, isConnecting));
+	//with io_uring epoll only waits for the connect
+	if (m_pRing == nullptr || isConnecting) {
+		epoll_event event{};
+		event.events = m_pRing == nullptr ? (EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET) : (EPOLLOUT | EPOLLET);
+		event.data.fd = socket;
+		if (::epoll_ctl(m_epoll, EPOLL_CTL_ADD, socket, &event) == -1) {
+			ThrowErrno("epoll_ctl");
+		}
+	}
+	TcpConnection& result = *connection;
+	m_connections[socket] = std::move(connection);
+	if (m_pRing != nullptr && !isConnecting) {
+		StartReceiving(result);
+	}
+	return result;
+}
+
+
+inline void messaging::TcpEventLoop::HandleEvent(TcpConnection& connection, const std::uint32_t events, std::size_t& frameCount) {
+	if ((events & EPOLLOUT) != 0) {
+		if (connection.m_isConnecting) {
+			int error = 0;
+			socklen_t errorLen = sizeof(error);
+			::getsockopt(connection.m_socket, SOL_SOCKET, SO_ERROR, &error, &errorLen);
+			if (error != 0) {
+				Close(connection);
+				return;
+			}
+			connection.m_isConnecting = false;
+			if (m_pRing != nullptr) {
+				::epoll_ctl(m_epoll, EPOLL_CTL_DEL, connection.m_socket, nullptr);
+				StartReceiving(connection);
+				MarkSendPending(connection);
+			}
+			if (m_connectHandler) {
+				m_connectHandler(connection);
+			}
+		}
+		if (m_pRing != nullptr) {
+			return;
+		}
+		connection.FlushWriteBuffer();
+	}
+	if ((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0) {
+		const bool IsAlive = ReadAll(connection);
+		frameCount += DispatchFrames(connection);
+		if (!IsAlive) {
+			Close(connection);
+		}
+	}
+	if (!connection.m_isOpen) {
+		Close(connection);
+	}
+}
+
+
+inline bool messaging::TcpEventLoop::ReadAll(TcpConnection& connection) {
+	//edge triggered : read until the socket is empty
+	for (;;) {
+		connection.m_readBuffer.Reserve(4096);
+		std::size_t len = 0;
+		Byte* pDest = connection.m_readBuffer.GetWritePtr(len);
+		const ssize_t Result = ::recv(connection.m_socket, pDest, len, 0);
+		if (Result > 0) {
+			connection.m_readBuffer.Commit(static_cast<std::size_t>(Result));
+			continue;
+		}
+		if (Result == 0) {
+			return false;
+		}
+		if (errno == EINTR) {
+			continue;
+		}
+		return errno == EAGAIN || errno == EWOULDBLOCK;
+	}
+}
+
+
+inline std::size_t messaging::TcpEventLoop::DispatchFrames(TcpConnection& connection) {
+	using FrameSizeType = TcpConnection::FrameSizeType;
+	ByteRingBuffer& buffer = connection.m_readBuffer;
+	std::size_t count = 0;
+	while (connection.m_isOpen && buffer.size() >= sizeof(FrameSizeType)) {
+		FrameSizeType frameSize = 0;
+		buffer.Peek(reinterpret_cast<Byte*>(&frameSize), 0, sizeof(frameSize));
+		if (frameSize > m_maxFrameSize) {
+			Close(connection);
+			break;
+		}
+		if (buffer.size() - sizeof(FrameSizeType) < frameSize) {
+			break;
+		}
+		const Byte* pFrame = buffer.GetContiguous(sizeof(FrameSizeType), frameSize);
+		if (pFrame == nullptr) {
+			m_frameScratch.resize(frameSize);
+			buffer.Peek(m_frameScratch.data(), sizeof(FrameSizeType), frameSize);
+			pFrame = m_frameScratch.data();
+		}
+		if (m_frameHandler) {
+			m_frameHandler(connection, ByteSpan(pFrame, frameSize));
+		}
+		buffer.Consume(sizeof(FrameSizeType) + frameSize);
+		++count;
+	}
+	return count;
+}
+
+
+inline std::size_t messaging::TcpEventLoop::DispatchFrames(TcpConnection& connection, const Byte* pData, const std::size_t len, std::size_t& frameCount) {
+	using FrameSizeType = TcpConnection::FrameSizeType;
+	std::size_t offset = 0;
+	while (connection.m_isOpen && len - offset >= sizeof(FrameSizeType)) {
+		FrameSizeType frameSize = 0;
+		std::memcpy(&frameSize, pData + offset, sizeof(frameSize));
+		if (frameSize > m_maxFrameSize) {
+			Close(connection);
+			break;
+		}
+		if (len - offset - sizeof(FrameSizeType) < frameSize) {
+			break;
+		}
+		if (m_frameHandler) {
+			m_frameHandler(connection, ByteSpan(pData + offset + sizeof(FrameSizeType), frameSize));
+		}
+		offset += sizeof(FrameSizeType) + frameSize;
+		++frameCount;
+	}
+	return offset;
+}
+
+
+inline void messaging::TcpEventLoop::DestroyClosed() {
+	std::vector<int> stillInFlight;
+	for (const int Socket : m_closed) {
+		const auto It = m_connections.find(Socket);
+		if (It == m_connections.end()) {
+			continue;
+		}
+		TcpConnection& connection = *It->second;
+		if (connection.m_isReceiveInFlight || connection.m_sendInFlightChunks != 0) {
+			//the queued operations complete once the socket is shut down, the connection goes with the next Poll
+			if (!connection.m_isShutdown) {
+				::shutdown(Socket, SHUT_RDWR);
+				connection.m_isShutdown = true;
+			}
+			stillInFlight.push_back(Socket);
+			continue;
+		}
+		::epoll_ctl(m_epoll, EPOLL_CTL_DEL, Socket, nullptr);
+		if (m_disconnectHandler) {
+			m_disconnectHandler(connection);
+		}
+		if (connection.m_receiveSlot != -1) {
+			m_pReceivePool->Release(connection.m_receiveSlot);
+		}
+		ReleaseSendChunks(connection);
+		m_connections.erase(It);
+	}
+	m_closed.swap(stillInFlight);
+}
+
+
+inline void messaging::TcpEventLoop::InitUring() {
+	if (!INTERNAL::IoUring::IsSupported()) {
+		throw std::runtime_error("io_uring is not supported by the kernel!!!");
+	}
+	m_pRing.reset(new INTERNAL::IoUring(UringQueueDepth));
+	m_pReceivePool.reset(new INTERNAL::FixedBufferPool(ReceiveSlotCount, ReceiveSlotSize));
+	m_pSendPool.reset(new INTERNAL::FixedBufferPool(SendBufferCount, SendBufferSize));
+	//fixed buffer 0 are the receive slots. The send buffers are not registered, sendmsg can't use fixed buffers
+	const iovec ReceiveBuffer = m_pReceivePool->GetIovec();
+	m_pRing->RegisterBuffers(&ReceiveBuffer, 1);
+	//the ring fd is readable while completions wait, so one epoll_wait covers both
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.fd = m_pRing->GetFd();
+	if (::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_pRing->GetFd(), &event) == -1) {
+		ThrowErrno("epoll_ctl");
+	}
+}
+
+
+inline io_uring_sqe* messaging::TcpEventLoop::GetSqe() {
+	io_uring_sqe* pSqe = m_pRing->GetSqe();
+	if (pSqe == nullptr) {
+		m_pRing->Submit();
+		pSqe = m_pRing->GetSqe();
+		if (pSqe == nullptr) {
+			throw std::runtime_error("io_uring submission queue is full!!!");
+		}
+	}
+	return pSqe;
+}
+
+
+inline void messaging::TcpEventLoop::StartReceiving(TcpConnection& connection) {
+	//connections beyond ReceiveSlotCount receive into their ring buffer
+	connection.m_receiveSlot = m_pReceivePool->Acquire();
+	QueueReceive(connection);
+}
+
+
+inline void messaging::TcpEventLoop::QueueReceive(TcpConnection& connection) {
+	io_uring_sqe* pSqe = GetSqe();
+	pSqe->fd = connection.m_socket;
+	if (connection.m_receiveSlot != -1) {
+		pSqe->opcode = IORING_OP_READ_FIXED;
+		pSqe->addr = reinterpret_cast<std::uint64_t>(m_pReceivePool->Get(connection.m_receiveSlot));
+		pSqe->len = static_cast<std::uint32_t>(m_pReceivePool->GetBufferSize());
+		pSqe->buf_index = 0;
+	} else {
+		connection.m_readBuffer.Reserve(ReceiveSlotSize);
+		std::size_t len = 0;
+		pSqe->opcode = IORING_OP_RECV;
+		pSqe->addr = reinterpret_cast<std::uint64_t>(connection.m_readBuffer.GetWritePtr(len));
+		pSqe->len = static_cast<std::uint32_t>(len);
+	}
+	pSqe->user_data = (static_cast<std::uint64_t>(connection.m_socket) << 8) | UringReceive;
+	connection.m_isReceiveInFlight = true;
+	++m_inFlightCount;
+}
+
+
+inline void messaging::TcpEventLoop::QueueSend(TcpConnection& connection) {
+	if (connection.m_sendInFlightChunks != 0 || connection.m_isConnecting || !connection.m_isOpen) {
+		return;
+	}
+	std::vector<iovec>& iovecs = connection.m_iovecs;
+	iovecs.clear();
+	for (const TcpConnection::SendChunk& chunk : connection.m_sendChunks) {
+		if (iovecs.size() == MaxSendIovecs) {
+			break;
+		}
+		iovecs.push_back(iovec{ chunk.pData + chunk.offset, chunk.size - chunk.offset });
+	}
+	if (iovecs.empty()) {
+		return;
+	}
+	//one sendmsg for all chunks, unlike WRITE_FIXED it takes MSG_NOSIGNAL
+	connection.m_sendHeader = msghdr{};
+	connection.m_sendHeader.msg_iov = iovecs.data();
+	connection.m_sendHeader.msg_iovlen = iovecs.size();
+	io_uring_sqe* pSqe = GetSqe();
+	pSqe->opcode = IORING_OP_SENDMSG;
+	pSqe->fd = connection.m_socket;
+	pSqe->addr = reinterpret_cast<std::uint64_t>(&connection.m_sendHeader);
+	pSqe->len = 1;
+	pSqe->msg_flags = MSG_NOSIGNAL;
+	pSqe->user_data = (static_cast<std::uint64_t>(connection.m_socket) << 8) | UringSend;
+	connection.m_sendInFlightChunks = iovecs.size();
+	++m_inFlightCount;
+}
+
+
+inline void messaging::TcpEventLoop::MarkSendPending(TcpConnection& connection) {
+	if (!connection.m_isSendPending) {
+		connection.m_isSendPending = true;
+		m_pendingSends.push_back(connection.m_socket);
+	}
+}
+
+
+inline void messaging::TcpEventLoop::FlushPendingSends() {
+	for (const int Socket : m_pendingSends) {
+		const auto It = m_connections.find(Socket);
+		if (It != m_connections.end()) {
+			It->second->m_isSendPending = false;
+			QueueSend(*It->second);
+		}
+	}
+	m_pendingSends.clear();
+}
+
+
+inline unsigned messaging::TcpEventLoop::ReapCompletions(std::size_t& frameCount) {
+	return m_pRing->ForEachCompletion([this, &frameCount](const io_uring_cqe& cqe) {
+		--m_inFlightCount;
+		const auto It = m_connections.find(static_cast<int>(cqe.user_data >> 8));
+		if (It == m_connections.end()) {
+			return;
+		}
+		if ((cqe.user_data & 0xFF) == UringReceive) {
+			frameCount += HandleReceived(*It->second, cqe.res);
+		} else {
+			HandleSent(*It->second, cqe.res);
+		}
+	});
+}
+
+
+inline std::size_t messaging::TcpEventLoop::HandleReceived(TcpConnection& connection, const int result) {
+	connection.m_isReceiveInFlight = false;
+	if (result <= 0) {
+		if ((result == -EINTR || result == -EAGAIN) && connection.m_isOpen) {
+			QueueReceive(connection);
+		} else {
+			Close(connection);
+		}
+		return 0;
+	}
+	if (!connection.m_isOpen) {
+		return 0;
+	}
+	const std::size_t Len = static_cast<std::size_t>(result);
+	std::size_t frameCount = 0;
+	ByteRingBuffer& buffer = connection.m_readBuffer;
+	if (connection.m_receiveSlot == -1) {
+		buffer.Commit(Len);
+		frameCount = DispatchFrames(connection);
+	} else if (buffer.empty()) {
+		//the complete frames are handed out straight from the registered slot, only a partial one is copied
+		const Byte* pData = m_pReceivePool->Get(connection.m_receiveSlot);
+		const std::size_t Consumed = DispatchFrames(connection, pData, Len, frameCount);
+		buffer.Append(pData + Consumed, Len - Consumed);
+	} else {
+		buffer.Append(m_pReceivePool->Get(connection.m_receiveSlot), Len);
+		frameCount = DispatchFrames(connection);
+	}
+	if (connection.m_isOpen) {
+		QueueReceive(connection);
+	}
+	return frameCount;
+}
+
+
+inline void messaging::TcpEventLoop::HandleSent(TcpConnection& connection, const int result) {
+	const std::size_t ChunkCount = connection.m_sendInFlightChunks;
+	connection.m_sendInFlightChunks = 0;
+	if (result < 0) {
+		if (result != -EINTR && result != -EAGAIN) {
+			Close(connection);
+			return;
+		}
+	}
+	std::size_t sent = result < 0 ? 0 : static_cast<std::size_t>(result);
+	auto& chunks = connection.m_sendChunks;
+	for (std::size_t i = 0; i < ChunkCount; ++i) {
+		TcpConnection::SendChunk& chunk = chunks.front();
+		if (sent < chunk.size - chunk.offset) {
+			chunk.offset += sent;
+			break;
+		}
+		sent -= chunk.size - chunk.offset;
+		if (chunk.poolIndex != -1) {
+			m_pSendPool->Release(chunk.poolIndex);
+		}
+		chunks.pop_front();
+	}
+	QueueSend(connection);
+}
+
+
+inline void messaging::TcpEventLoop::ReleaseSendChunks(TcpConnection& connection) {
+	for (const TcpConnection::SendChunk& chunk : connection.m_sendChunks) {
+		if (chunk.poolIndex != -1) {
+			m_pSendPool->Release(chunk.poolIndex);
+		}
+	}
+	connection.m_sendChunks.clear();
+}
+#endif
@@ -0,0 +1,160 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <stdexcept>
+#include <initializer_list>
+#include "MessageRecipients.h"
+#include "MessageBinaryDeserializer.h"
+
+namespace messaging {
+
+	//non owning view of serialized bytes
+	class ByteSpan final {
+	public:
+		constexpr ByteSpan() noexcept = default;
+		constexpr ByteSpan(const Byte* pData, const std::size_t size) noexcept : m_pData(pData), m_size(size) {}
+		ByteSpan(const std::vector<Byte>& bytes) noexcept : m_pData(bytes.data()), m_size(bytes.size()) {}
+
+		constexpr const Byte* data() const noexcept { return m_pData; }
+		constexpr std::size_t size() const noexcept { return m_size; }
+		constexpr bool empty() const noexcept { return m_size == 0; }
+		constexpr const Byte* begin() const noexcept { return m_pData; }
+		constexpr const Byte* end() const noexcept { return m_pData + m_size; }
+
+	private:
+		const Byte* m_pData = nullptr;
+		std::size_t m_size = 0;
+	};
+
+
+	//a connection serialized messages are written to, e.g. a game descriptor, a socket or LoopbackTransport
+	class ITransport {
+	public:
+		virtual ~ITransport() noexcept = default;
+		virtual void Send(const ByteSpan bytes) = 0;
+		//writes the spans in order, each one like a Send call,
+		//transports that support vectored writes override it
+		virtual void SendBatch(const ByteSpan* pSpans, const std::size_t count) {
+			for (std::size_t i = 0; i < count; ++i) {
+				Send(pSpans[i]);
+			}
+		}
+	};
+
+
+	//in memory transport, everything sent is appended to one buffer which can be read back with GetReceived.
+	//Every span sent is remembered as one frame, like a framing transport would deliver it.
+	//Handy to test or benchmark send paths without a network
+	class LoopbackTransport final : public ITransport {
+	public:
+		virtual void Send(const ByteSpan bytes) override {
+			AppendFrame(bytes);
+			++m_sendCount;
+		}
+
+		virtual void SendBatch(const ByteSpan* pSpans, const std::size_t count) override {
+			for (std::size_t i = 0; i < count; ++i) {
+				AppendFrame(pSpans[i]);
+			}
+			++m_sendCount;
+		}
+
+		const std::vector<Byte>& GetReceived() const noexcept { return m_received; }
+		//number of Send/SendBatch calls, the number of writes a real transport would do
+		std::size_t GetSendCount() const noexcept { return m_sendCount; }
+		std::size_t GetFrameCount() const noexcept { return m_frameEnds.size(); }
+
+		//calls func(ByteSpan frame) for every frame in the order they were sent
+		template<typename FuncType>
+		void ForEachFrame(FuncType&& func) const {
+			std::size_t begin = 0;
+			for (const std::size_t End : m_frameEnds) {
+				func(ByteSpan(m_received.data() + begin, End - begin));
+				begin = End;
+			}
+		}
+
+		void Clear() noexcept {
+			m_received.clear();
+			m_frameEnds.clear();
+			m_sendCount = 0;
+		}
+
+	private:
+		void AppendFrame(const ByteSpan bytes) {
+			m_received.insert(m_received.end(), bytes.begin(), bytes.end());
+			m_frameEnds.push_back(m_received.size());
+		}
+
+		std::vector<Byte> m_received;
+		std::vector<std::size_t> m_frameEnds;
+		std::size_t m_sendCount = 0;
+	};
+
+
+	//fan out to a fixed set of transports which are owned elsewhere
+	class TransportRecipients final : public IMessageRecipients {
+	public:
+		TransportRecipients() = default;
+		explicit TransportRecipients(std::vector<ITransport*> transports) : m_transports(std::move(transports)) {}
+
+		void Add(ITransport* pTransport) { m_transports.push_back(pTransport); }
+
+		virtual std::size_t SendToAll(const SharedMessageBuffer& buffer) override {
+			for (ITransport* pTransport : m_transports) {
+				pTransport->Send(ByteSpan(*buffer));
+			}
+			return m_transports.size();
+		}
+
+	private:
+		std::vector<ITransport*> m_transports;
+	};
+
+
+namespace INTERNAL {
+	//reused by every TransmitMessage call of a thread so sending doesn't allocate
+	inline std::vector<Byte>& GetTransmitBuffer() {
+		thread_local std::vector<Byte> buffer;
+		return buffer;
+	}
+}//namespace INTERNAL
+
+	template<typename MessageType>
+	inline void TransmitMessage(ITransport& transport, const MessageType& msg) {
+		auto& buffer = INTERNAL::GetTransmitBuffer();
+		buffer.clear();
+		INTERNAL::AppendSerialized(buffer, msg);
+		transport.Send(ByteSpan(buffer));
+	}
+
+	//all messages are serialized one after another and written with a single Send
+	template<typename... MessageTypes>
+	inline void TransmitMessages(ITransport& transport, const MessageTypes&... msgs) {
+		auto& buffer = INTERNAL::GetTransmitBuffer();
+		buffer.clear();
+		(void)std::initializer_list<int>{(INTERNAL::AppendSerialized(buffer, msgs), 0)...};
+		transport.Send(ByteSpan(buffer));
+	}
+
+	//deserializes a received frame into msg, false if the frame doesn't hold a complete message
+	template<typename MessageType>
+	inline bool DeserializeFrame(MessageType& msg, const ByteSpan frame) {
+		try {
+			return binary_serilization::Deserialize(msg, frame.data(), static_cast<std::int32_t>(frame.size())) == frame.size();
+		} catch (const std::runtime_error&) {
+			return false;
+		}
+	}
+
+	//already serialized messages (e.g. from SerializeShared) are written with one SendBatch without copying them
+	inline void TransmitBuffers(ITransport& transport, const SharedMessageBuffer* pBuffers, const std::size_t count) {
+		std::vector<ByteSpan> spans;
+		spans.reserve(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			spans.emplace_back(*pBuffers[i]);
+		}
+		transport.SendBatch(spans.data(), spans.size());
+	}
+}//namespace messaging
@@ -33,6 +33,62 @@ namespace INTERNAL {
 		std::tuple<RestTupleTypes...>>::Type;
 	};
 	
+	//replacement for std::tuple which stays an aggregate, trivially copyable and standard layout
+	//as long as all its members are. Used as field storage of DECLSTATICMESSAGE messages
+	template<typename...> struct FlatTuple;
+
+	template<typename LastType>
+	struct FlatTuple<LastType> {
+		LastType first;
+		bool operator==(const FlatTuple& other) const { return first == other.first; }
+	};
+
+	template<typename FirstType, typename... RestTypes>
+	struct FlatTuple<FirstType, RestTypes...> {
+		FirstType first;
+		FlatTuple<RestTypes...> rest;
+		bool operator==(const FlatTuple& other) const { return first == other.first && rest == other.rest; }
+	};
+
+	template<typename, typename> struct FlatTupleGetter;
+
+	template<typename T, typename... RestTypes>
+	struct FlatTupleGetter<T, FlatTuple<T, RestTypes...>> {
+		static constexpr T& Get(FlatTuple<T, RestTypes...>& tuple) noexcept { return tuple.first; }
+		static constexpr const T& Get(const FlatTuple<T, RestTypes...>& tuple) noexcept { return tuple.first; }
+	};
+
+	template<typename T, typename FirstType, typename... RestTypes>
+	struct FlatTupleGetter<T, FlatTuple<FirstType, RestTypes...>> {
+		static constexpr T& Get(FlatTuple<FirstType, RestTypes...>& tuple) noexcept {
+			return FlatTupleGetter<T, FlatTuple<RestTypes...>>::Get(tuple.rest);
+		}
+		static constexpr const T& Get(const FlatTuple<FirstType, RestTypes...>& tuple) noexcept {
+			return FlatTupleGetter<T, FlatTuple<RestTypes...>>::Get(tuple.rest);
+		}
+	};
+
+	//std::get<T> for both kinds of field storage
+	template<typename T, typename... TupleTypes>
+	constexpr T& GetTupleMember(std::tuple<TupleTypes...>& tuple) noexcept { return std::get<T>(tuple); }
+	template<typename T, typename... TupleTypes>
+	constexpr const T& GetTupleMember(const std::tuple<TupleTypes...>& tuple) noexcept { return std::get<T>(tuple); }
+	template<typename T, typename... TupleTypes>
+	constexpr T& GetTupleMember(FlatTuple<TupleTypes...>& tuple) noexcept {
+		return FlatTupleGetter<T, FlatTuple<TupleTypes...>>::Get(tuple);
+	}
+	template<typename T, typename... TupleTypes>
+	constexpr const T& GetTupleMember(const FlatTuple<TupleTypes...>& tuple) noexcept {
+		return FlatTupleGetter<T, FlatTuple<TupleTypes...>>::Get(tuple);
+	}
+
+	template<typename> struct ToFlatTuple;
+
+	template<typename... TupleTypes>
+	struct ToFlatTuple<std::tuple<TupleTypes...>> {
+		using Type = FlatTuple<TupleTypes...>;
+	};
+
 	template<template<typename> class Trait, typename> struct DoTraitOnEachTupleMember;
 
 	template<template<typename> class Trait, typename... TupleTypes> 
@@ -3,3 +3,4 @@
 #include "Messaging/CombinedMessage.h"
 #include "Messaging/MessageBinaryDeserializer.h"
 #include "Messaging/MessageBinarySerializer.h"
+#include "Messaging/MessageMemoryResource.h"
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <typeindex>
+#include <functional>
+#include <unordered_map>
+#include "Reflective_Messages.h"
+#include "Messaging/MessageBus.h"
+
+//dispatch latency of MessageBus against a map of std::function handlers keyed by std::type_index,
+//usage : MessageBusBenchmark [handlers per type] [messages]
+DECLMESSAGE(PositionMessage,
+	DECLMESSAGEFIELD(int, X),
+	DECLMESSAGEFIELD(int, Y)
+);
+
+DECLMESSAGE(HealthMessage,
+	DECLMESSAGEFIELD(int, Health)
+);
+
+
+//the usual hand written bus, the message is passed as void* and cast back inside the std::function
+class TypeIndexBus final {
+public:
+	template<typename MessageType, typename FuncType>
+	void Subscribe(FuncType handler) {
+		m_handlers[std::type_index(typeid(MessageType))].emplace_back([handler](const void* pMsg) {
+			handler(*static_cast<const MessageType*>(pMsg));
+		});
+	}
+
+	template<typename MessageType>
+	std::size_t Publish(const MessageType& msg) {
+		const auto it = m_handlers.find(std::type_index(typeid(MessageType)));
+		if (it == m_handlers.end()) {
+			return 0;
+		}
+		for (const auto& handler : it->second) {
+			handler(&msg);
+		}
+		return it->second.size();
+	}
+
+private:
+	std::unordered_map<std::type_index, std::vector<std::function<void(const void*)>>> m_handlers;
+};
+
+
+template<typename BusType, typename PublishType>
+static double NanosecondsPerMessage(BusType& bus, const int messageCount, PublishType&& publish) {
+	const auto Start = std::chrono::steady_clock::now();
+	for (int i = 0; i < messageCount; ++i) {
+		publish(bus, i);
+	}
+	const std::chrono::duration<double, std::nano> Elapsed = std::chrono::steady_clock::now() - Start;
+	return Elapsed.count() / messageCount;
+}
+
+
+int main(int argc, char** argv) {
+	const int HandlerCount = argc > 1 ? std::atoi(argv[1]) : 1;
+	const int MessageCount = argc > 2 ? std::atoi(argv[2]) : 10000000;
+	std::cout << HandlerCount << " handlers per type, " << MessageCount << " messages\n";
+
+	long long sum = 0;
+	messaging::MessageBus bus;
+	TypeIndexBus typeIndexBus;
+	for (int i = 0; i < HandlerCount; ++i) {
+		bus.Subscribe<PositionMessage>([&sum](const PositionMessage& msg) { sum += msg.GetX(); });
+		bus.Subscribe<HealthMessage>([&sum](const HealthMessage& msg) { sum += msg.GetHealth(); });
+		typeIndexBus.Subscribe<PositionMessage>([&sum](const PositionMessage& msg) { sum += msg.GetX(); });
+		typeIndexBus.Subscribe<HealthMessage>([&sum](const HealthMessage& msg) { sum += msg.GetHealth(); });
+	}
+
+	const auto PublishMixed = [](auto& anyBus, const int i) {
+		if (i & 1) {
+			anyBus.Publish(PositionMessage{ i, i });
+		} else {
+			anyBus.Publish(HealthMessage{ i });
+		}
+	};
+	std::cout << "MessageBus::Publish        : " << NanosecondsPerMessage(bus, MessageCount, PublishMixed) << " ns/message\n";
+	std::cout << "std::type_index + function : " << NanosecondsPerMessage(typeIndexBus, MessageCount, PublishMixed) << " ns/message\n";
+
+	constexpr int BatchSize = 64;
+	std::vector<PositionMessage> batch(BatchSize, PositionMessage{ 1, 2 });
+	const double BatchTime = NanosecondsPerMessage(bus, MessageCount / BatchSize, [&batch](messaging::MessageBus& anyBus, int) {
+		anyBus.PublishBatch(batch.data(), batch.size());
+	});
+	std::cout << "MessageBus::PublishBatch   : " << BatchTime / BatchSize << " ns/message\n";
+	if (sum == 42) {
+		std::cout << "\n";
+	}
+	return 0;
+}
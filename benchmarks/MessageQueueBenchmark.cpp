@@ -0,0 +1,93 @@
+#include <mutex>
+#include <deque>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include "Reflective_Messages.h"
+#include "Messaging/MessageQueue.h"
+
+//MpscMessageQueue against a std::deque behind a std::mutex, usage : MessageQueueBenchmark [producers] [messages per producer]
+DECLMESSAGE(ChatMessage,
+	DECLMESSAGEFIELD(int, Sender),
+	DECLMESSAGEFIELD(std::string, Text)
+);
+
+
+//the consumer swaps the whole deque out under the lock, the usual way such a queue is drained
+class MutexMessageQueue final {
+public:
+	bool TryPush(ChatMessage&& msg) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_messages.emplace_back(std::move(msg));
+		return true;
+	}
+
+	template<typename FuncType>
+	std::size_t ConsumeBatch(FuncType&& consume) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_consumed.swap(m_messages);
+		}
+		const std::size_t Count = m_consumed.size();
+		for (auto& msg : m_consumed) {
+			consume(msg);
+		}
+		m_consumed.clear();
+		return Count;
+	}
+
+private:
+	std::mutex m_mutex;
+	std::deque<ChatMessage> m_messages;
+	std::deque<ChatMessage> m_consumed;
+};
+
+
+template<typename QueueType>
+static double Run(QueueType& queue, const int producerCount, const int perProducer) {
+	const auto Start = std::chrono::steady_clock::now();
+	std::vector<std::thread> producers;
+	for (int p = 0; p < producerCount; ++p) {
+		producers.emplace_back([&queue, p, perProducer] {
+			for (int i = 0; i < perProducer; ++i) {
+				while (!queue.TryPush(ChatMessage(p, "position update"))) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	const long long Total = static_cast<long long>(producerCount) * perProducer;
+	long long received = 0;
+	long long checksum = 0;
+	while (received < Total) {
+		const std::size_t Count = queue.ConsumeBatch([&checksum](ChatMessage& msg) { checksum += msg.GetSender(); });
+		if (Count == 0) {
+			std::this_thread::yield();
+		}
+		received += static_cast<long long>(Count);
+	}
+	for (auto& producer : producers) {
+		producer.join();
+	}
+	const std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+	if (checksum < 0) {
+		std::cout << checksum;
+	}
+	return static_cast<double>(Total) / Elapsed.count();
+}
+
+
+int main(int argc, char** argv) {
+	const int ProducerCount = argc > 1 ? std::atoi(argv[1]) : 4;
+	const int PerProducer = argc > 2 ? std::atoi(argv[2]) : 500000;
+	std::cout << ProducerCount << " producers, " << PerProducer << " messages each\n";
+
+	messaging::MpscMessageQueue<ChatMessage> lockFreeQueue(4096);
+	std::cout << "MpscMessageQueue   : " << Run(lockFreeQueue, ProducerCount, PerProducer) / 1e6 << " M messages/s\n";
+	MutexMessageQueue mutexQueue;
+	std::cout << "mutex + std::deque : " << Run(mutexQueue, ProducerCount, PerProducer) / 1e6 << " M messages/s\n";
+	return 0;
+}
@@ -1,7 +1,7 @@
 #include <iostream>
 #include <vector>
-#include <fstream>
 #include "Reflective_Messages.h"
+#include "Messaging/FileUtils.h"
 
 DECLMESSAGE(TestMessage,
 	DECLMESSAGEFIELD(int, Age),
@@ -17,6 +17,8 @@ DECLMESSAGE(SecondTestMessage,
 
 //combines both messages to one
 using TestMessageWithNumbers = messaging::CombinedMessage<TestMessage, SecondTestMessage>;
+//combines both messages to one without virtual inheritance, all fields are merged into one message
+using FlatTestMessageWithNumbers = messaging::FlatCombinedMessage<TestMessage, SecondTestMessage>;
 
 
 void PrintTestMessage(const TestMessage& msg) {
@@ -38,9 +40,18 @@ int main() {
 
 	//the combined message it inherits all the messages 
 	TestMessageWithNumbers numMsg;
+	//EmplaceXxx constructs the field from the given arguments without a temporary copy
+	numMsg.EmplaceNumbers(std::size_t(3), 7);
 	numMsg.GetNumbers().emplace_back(5);
 	numMsg.SetAge(23);
 
+	//the flat combined message is built from its parts, fields are accessed by part type and field index
+	FlatTestMessageWithNumbers flatMsg = FlatTestMessageWithNumbers::FromParts(msg, SecondTestMessage{});
+	flatMsg.GetPartField<SecondTestMessage, SecondTestMessage::FieldName::Numbers>().emplace_back(5);
+	flatMsg.SetPartField<TestMessage, TestMessage::FieldName::Age>(24);
+	//the GetXxx/SetXxx/EmplaceXxx of the parts work as well
+	flatMsg.SetCountry("Austria");
+
 	//Getting the current size In bytes of the message at runtime
 	//If the message size is known at compile time you can retrive it with GetStaticMessageSize.
 	//Otherwise a static_assert will fail in GetStaticMessageSize
@@ -57,23 +68,13 @@ int main() {
 	msg.SetCountry("Germany");
 	//to binary file
 	std::vector<messaging::Byte> serializedContent = messaging::binary_serilization::Serialize(msg);
-	std::ofstream outFile;
-	outFile.open("testmsg.msg", std::ios::out | std::ios::trunc | std::ios::binary);
-	if (outFile.is_open()) {
-		outFile.write(reinterpret_cast<const char*>(serializedContent.data()), serializedContent.size());
-		outFile.close();
-	}
+	file_utils::FileWriteAllBytesAtomic("testmsg.msg", serializedContent.data(), serializedContent.size());
 
-	//from binary file
-	std::ifstream inFile;
-	inFile.open("testmsg.msg", std::ios::in | std::ios::binary);
-	if (inFile.is_open()) {
-		inFile.seekg(0, std::ios::end);
-		serializedContent.clear();
-		serializedContent.resize(static_cast<std::size_t>(inFile.tellg()));
-		inFile.seekg(0, std::ios::beg);
-		inFile.read(reinterpret_cast<char*>(serializedContent.data()), serializedContent.size());
-		messaging::binary_serilization::Deserialize(msg, serializedContent);
+	//from binary file, the message is deserialized directly from the mapped file without copying it first
+	const file_utils::MappedFile inFile("testmsg.msg");
+	if (inFile.IsOpen()) {
+		messaging::binary_serilization::Deserialize(msg, reinterpret_cast<const messaging::Byte*>(inFile.Data()),
+			static_cast<std::int32_t>(inFile.Size()));
 		PrintTestMessage(msg);
 	}
 
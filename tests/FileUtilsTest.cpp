@@ -0,0 +1,62 @@
+#include <string>
+#include <utility>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "TestUtils.h"
+#include "Messaging/FileUtils.h"
+
+
+static bool FileExists(const char* fileName) {
+	struct stat fileStat = {};
+	return ::stat(fileName, &fileStat) == 0;
+}
+
+
+static void TestAtomicWrite() {
+	const std::string Content(10000, 'x');
+	TEST_CHECK(file_utils::FileWriteAllBytesAtomic("atomic.bin", Content.data(), Content.size()));
+	std::string text;
+	TEST_CHECK(file_utils::FileReadAllText("atomic.bin", text) && text == Content);
+	TEST_CHECK(!FileExists("atomic.bin.tmp"));
+
+	//replaces the old content completely, also by a shorter one
+	TEST_CHECK(file_utils::FileWriteAllTextAtomic("atomic.bin", "short"));
+	TEST_CHECK(file_utils::FileReadAllText("atomic.bin", text) && text == "short");
+	TEST_CHECK(file_utils::FileWriteAllBytesAtomic("atomic.bin", nullptr, 0));
+	TEST_CHECK(file_utils::FileReadAllText("atomic.bin", text) && text.empty());
+
+	//the directory of the file is synced, not the working directory
+	::mkdir("atomic_dir", 0755);
+	TEST_CHECK(file_utils::FileWriteAllTextAtomic("atomic_dir/nested.txt", "nested"));
+	TEST_CHECK(file_utils::FileReadAllText("atomic_dir/nested.txt", text) && text == "nested");
+
+	TEST_CHECK(!file_utils::FileWriteAllTextAtomic("missing_dir/file.txt", "lost"));
+	TEST_CHECK(!FileExists("missing_dir/file.txt.tmp"));
+}
+
+
+static void TestMappedFile() {
+	const std::string Content = "line 1\nline 2\n";
+	TEST_CHECK(file_utils::FileWriteAllText("mapped.txt", Content));
+	file_utils::MappedFile file("mapped.txt", file_utils::MapAccessHint::eRANDOM);
+	TEST_CHECK(file.IsOpen() && file.Size() == Content.size());
+	TEST_CHECK(std::string(file.begin(), file.end()) == Content);
+
+	file_utils::MappedFile moved(std::move(file));
+	TEST_CHECK(!file.IsOpen() && moved.IsOpen() && std::string(moved.Data(), moved.Size()) == Content);
+	moved.Close();
+	TEST_CHECK(!moved.IsOpen() && moved.Data() == nullptr && moved.Size() == 0);
+
+	//an empty file is open but has no data
+	TEST_CHECK(file_utils::FileWriteAllText("empty.txt", ""));
+	TEST_CHECK(moved.Open("empty.txt") && moved.IsOpen() && moved.Size() == 0 && moved.begin() == moved.end());
+
+	TEST_CHECK(!moved.Open("missing.txt") && !moved.IsOpen());
+}
+
+
+int main() {
+	TestAtomicWrite();
+	TestMappedFile();
+	return 0;
+}
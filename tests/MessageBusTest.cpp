@@ -0,0 +1,106 @@
+#include <string>
+#include <vector>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/MessageBus.h"
+
+DECLMESSAGE(ChatMessage,
+	DECLMESSAGEFIELD(int, Channel),
+	DECLMESSAGEFIELD(std::string, Text)
+);
+
+DECLMESSAGE(MoveMessage,
+	DECLMESSAGEFIELD(int, X),
+	DECLMESSAGEFIELD(int, Y)
+);
+
+
+static void TestSubscribeAndPublish() {
+	messaging::MessageBus bus;
+	std::vector<std::string> texts;
+	int moves = 0;
+	const auto ChatId = bus.Subscribe<ChatMessage>([&texts](const ChatMessage& msg) { texts.push_back(msg.GetText()); });
+	bus.Subscribe<ChatMessage>([&texts](const ChatMessage& msg) { texts.push_back(msg.GetText() + "!"); });
+	bus.Subscribe<MoveMessage>([&moves](const MoveMessage& msg) { moves += msg.GetX(); });
+	TEST_CHECK(bus.GetHandlerCount<ChatMessage>() == 2 && bus.GetHandlerCount<MoveMessage>() == 1);
+
+	TEST_CHECK(bus.Publish(ChatMessage(1, std::string("hi"))) == 2);
+	TEST_CHECK((texts == std::vector<std::string>{ "hi", "hi!" }));
+	TEST_CHECK(bus.Publish(MoveMessage(3, 4)) == 1 && moves == 3);
+
+	TEST_CHECK(bus.Unsubscribe(ChatId));
+	TEST_CHECK(!bus.Unsubscribe(ChatId));
+	TEST_CHECK(bus.Publish(ChatMessage(1, std::string("again"))) == 1);
+	TEST_CHECK(texts.back() == "again!" && texts.size() == 3);
+}
+
+
+static void TestSubscribeBatch() {
+	messaging::MessageBus bus;
+	std::vector<std::size_t> batchSizes;
+	int single = 0;
+	bus.SubscribeBatch<MoveMessage>([&batchSizes](const MoveMessage* pMsgs, const std::size_t count) {
+		TEST_CHECK(pMsgs[count - 1].GetX() == static_cast<int>(count));
+		batchSizes.push_back(count);
+	});
+	bus.Subscribe<MoveMessage>([&single](const MoveMessage&) { ++single; });
+	const MoveMessage Moves[] = { MoveMessage(1, 0), MoveMessage(2, 0), MoveMessage(3, 0) };
+	TEST_CHECK(bus.PublishBatch(Moves, 3) == 2);
+	TEST_CHECK((batchSizes == std::vector<std::size_t>{ 3 }) && single == 3);
+	TEST_CHECK(bus.PublishBatch(Moves, 0) == 0);
+}
+
+
+static void TestUnsubscribeInsideHandler() {
+	messaging::MessageBus bus;
+	int onceCalls = 0;
+	int otherCalls = 0;
+	messaging::MessageBus::SubscriptionId onceId = 0;
+	messaging::MessageBus::SubscriptionId otherId = 0;
+	//removes itself and the handler behind it while the bus dispatches
+	onceId = bus.Subscribe<ChatMessage>([&](const ChatMessage&) {
+		++onceCalls;
+		TEST_CHECK(bus.Unsubscribe(onceId));
+		TEST_CHECK(bus.Unsubscribe(otherId));
+	});
+	otherId = bus.Subscribe<ChatMessage>([&otherCalls](const ChatMessage&) { ++otherCalls; });
+	TEST_CHECK(bus.Publish(ChatMessage(1, std::string("first"))) == 1);
+	TEST_CHECK(onceCalls == 1 && otherCalls == 0);
+	TEST_CHECK(bus.GetHandlerCount<ChatMessage>() == 0);
+	TEST_CHECK(bus.Publish(ChatMessage(1, std::string("second"))) == 0);
+	TEST_CHECK(onceCalls == 1);
+}
+
+
+static void TestSubscribeDuringDispatch() {
+	messaging::MessageBus bus;
+	int lateCalls = 0;
+	int moves = 0;
+	bool subscribed = false;
+	bus.Subscribe<ChatMessage>([&](const ChatMessage&) {
+		if (subscribed) {
+			return;
+		}
+		subscribed = true;
+		//enough handlers to make the vector grow while it is dispatched
+		for (int i = 0; i < 32; ++i) {
+			bus.Subscribe<ChatMessage>([&lateCalls](const ChatMessage&) { ++lateCalls; });
+		}
+		bus.Subscribe<MoveMessage>([&moves](const MoveMessage&) { ++moves; });
+	});
+	//handlers subscribed during a Publish get the next message
+	TEST_CHECK(bus.Publish(ChatMessage(1, std::string("first"))) == 1);
+	TEST_CHECK(lateCalls == 0);
+	TEST_CHECK(bus.Publish(ChatMessage(1, std::string("second"))) == 33);
+	TEST_CHECK(lateCalls == 32);
+	TEST_CHECK(bus.Publish(MoveMessage(1, 1)) == 1 && moves == 1);
+}
+
+
+int main() {
+	TestSubscribeAndPublish();
+	TestSubscribeBatch();
+	TestUnsubscribeInsideHandler();
+	TestSubscribeDuringDispatch();
+	return 0;
+}
@@ -0,0 +1,106 @@
+#include <limits>
+#include <string>
+#include <vector>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/MessageColumnFile.h"
+
+DECLMESSAGE(SampleMessage,
+	DECLMESSAGEFIELD(int, Age),
+	DECLMESSAGEFIELD(std::string, Name),
+	DECLMESSAGEFIELD(bool, Active),
+	DECLMESSAGEFIELD(std::int64_t, Time),
+	DECLMESSAGEFIELD(std::vector<int>, Numbers)
+);
+
+DECLMESSAGE(SampleMeasurement,
+	DECLMESSAGEFIELD(double, Value)
+);
+
+//long double does not fit the 8 byte block stats
+static_assert(sizeof(long double) == sizeof(double) ||
+	messaging::INTERNAL::ColumnTypeTraits<long double>::Code == messaging::INTERNAL::ColumnTypeCode::eNONE,
+	"long double must be rejected by column files");
+
+
+static void TestRoundTrip() {
+	messaging::MessageColumnStore<SampleMessage> store;
+	for (int i = 0; i < 10000; ++i) {
+		store.PushBack(SampleMessage(i % 77 - 30, "n" + std::to_string(i), i < 5000,
+			std::int64_t(1700000000000LL + i * 13), std::vector<int>(i % 4, i)));
+	}
+	messaging::ColumnFileOptions options;
+	options.RowsPerBlock = 1000;
+	TEST_CHECK(messaging::column_serilization::Serialize("roundtrip.col", store, options));
+
+	messaging::ColumnFileReader<SampleMessage> reader("roundtrip.col");
+	TEST_CHECK(reader.GetRowCount() == store.Size());
+	TEST_CHECK(reader.GetBlockCount() == 10);
+	messaging::MessageColumnStore<SampleMessage> result;
+	reader.ReadAll(result);
+	TEST_CHECK(result.Size() == store.Size());
+	for (std::size_t i = 0; i < store.Size(); ++i) {
+		TEST_CHECK(result.GetMessage(i) == store.GetMessage(i));
+	}
+
+	std::size_t lateRows = 0;
+	reader.ScanColumn<3>([&lateRows](std::int64_t time, std::uint64_t) { lateRows += time > 1700000100000LL; },
+		[](const auto& stats) { return stats.Max > 1700000100000LL; });
+	TEST_CHECK(lateRows == 10000 - 7693);
+}
+
+
+static void TestEmptyStore() {
+	const messaging::MessageColumnStore<SampleMessage> store;
+	TEST_CHECK(messaging::column_serilization::Serialize("empty.col", store));
+	messaging::ColumnFileReader<SampleMessage> reader("empty.col");
+	TEST_CHECK(reader.GetRowCount() == 0);
+	TEST_CHECK(reader.GetBlockCount() == 0);
+	messaging::MessageColumnStore<SampleMessage> result;
+	result.PushBack(SampleMessage{});
+	reader.ReadAll(result);
+	TEST_CHECK(result.IsEmpty());
+}
+
+
+static void TestNaNBlockStats() {
+	messaging::MessageColumnStore<SampleMeasurement> store;
+	for (int i = 0; i < 20; ++i) {
+		store.PushBack(SampleMeasurement(i % 10 == 0 ? std::numeric_limits<double>::quiet_NaN() : double(i)));
+	}
+	for (int i = 0; i < 10; ++i) {
+		store.PushBack(SampleMeasurement(std::numeric_limits<double>::quiet_NaN()));
+	}
+	messaging::ColumnFileOptions options;
+	options.RowsPerBlock = 10;
+	TEST_CHECK(messaging::column_serilization::Serialize("nan.col", store, options));
+
+	messaging::ColumnFileReader<SampleMeasurement> reader("nan.col");
+	TEST_CHECK(reader.GetBlockCount() == 3);
+	const auto FirstStats = reader.GetBlockStats<0>(0);
+	TEST_CHECK(FirstStats.HasStats && FirstStats.Min == 1.0 && FirstStats.Max == 9.0);
+	TEST_CHECK(!reader.GetBlockStats<0>(2).HasStats);
+
+	std::size_t bigRows = 0;
+	reader.ScanColumn<0>([&bigRows](double value, std::uint64_t) { bigRows += value > 5.0; },
+		[](const auto& stats) { return stats.Max > 5.0; });
+	TEST_CHECK(bigRows == 4 + 9);
+}
+
+
+static void TestTruncatedStringBlock() {
+	//length 5 but only 2 bytes follow
+	const messaging::Byte Block[] = { messaging::Byte{ 5 }, messaging::Byte{ 'a' }, messaging::Byte{ 'b' } };
+	std::string value;
+	TEST_CHECK_THROWS((messaging::INTERNAL::DecodeColumnBlock(messaging::INTERNAL::ColumnEncoding::eRAW,
+		Block, Block + sizeof(Block), &value, 1)), std::runtime_error);
+}
+
+
+int main() {
+	TestRoundTrip();
+	TestEmptyStore();
+	TestNaNBlockStats();
+	TestTruncatedStringBlock();
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include <new>
+#include <string>
+#include <vector>
+#include <memory>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/MessageColumnStore.h"
+
+DECLMESSAGE(ScoreMessage,
+	DECLMESSAGEFIELD(int, Age),
+	DECLMESSAGEFIELD(std::string, Name),
+	DECLMESSAGEFIELD(bool, Active),
+	DECLMESSAGEFIELD(double, Score)
+);
+
+
+static bool g_failAllocations = false;
+
+//fails every allocation while g_failAllocations is set
+template<typename T>
+struct FailingAllocator {
+	using value_type = T;
+	FailingAllocator() = default;
+	template<typename U>
+	FailingAllocator(const FailingAllocator<U>&) noexcept {}
+	T* allocate(const std::size_t count) {
+		if (g_failAllocations) {
+			throw std::bad_alloc{};
+		}
+		return std::allocator<T>{}.allocate(count);
+	}
+	void deallocate(T* pData, const std::size_t count) noexcept { std::allocator<T>{}.deallocate(pData, count); }
+	template<typename U>
+	bool operator==(const FailingAllocator<U>&) const noexcept { return true; }
+	template<typename U>
+	bool operator!=(const FailingAllocator<U>&) const noexcept { return false; }
+};
+
+using SampleVector = std::vector<int, FailingAllocator<int>>;
+
+DECLMESSAGE(SampleMessage,
+	DECLMESSAGEFIELD(int, Id),
+	DECLMESSAGEFIELD(std::string, Name),
+	DECLMESSAGEFIELD(SampleVector, Samples)
+);
+
+
+static void TestColumns() {
+	messaging::MessageColumnStore<ScoreMessage> store;
+	for (int i = 0; i < 100; ++i) {
+		store.PushBack(ScoreMessage(i, "n" + std::to_string(i), i % 2 == 0, i * 0.5));
+	}
+	auto row = store.AddRow();
+	row.SetAge(1000);
+	row.SetName("last");
+	TEST_CHECK(store.Size() == 101);
+	TEST_CHECK(store[100].GetName() == "last");
+	TEST_CHECK((store.Sum<0, long long>()) == 4950 + 1000);
+	TEST_CHECK(store.Max<0>() == 1000);
+	TEST_CHECK(store.CountIf<0>([](int age) { return age < 10; }) == 10);
+	std::vector<std::size_t> selection = store.Filter<2>([](bool active) { return active; });
+	selection = store.Filter<0>([](int age) { return age > 50; }, selection);
+	TEST_CHECK(selection.size() == 24);
+	TEST_CHECK(store.GetMessage(7) == ScoreMessage(7, std::string("n7"), false, 3.5));
+}
+
+
+//rows added by Resize are default rows, also after the columns grew or were assigned
+static void TestResizeValueInitializes() {
+	messaging::MessageColumnStore<ScoreMessage> store;
+	store.Resize(1000);
+	for (std::size_t i = 0; i < store.Size(); ++i) {
+		TEST_CHECK(store.GetMessage(i) == ScoreMessage{});
+	}
+
+	messaging::MessageColumnStore<ScoreMessage> small;
+	small.PushBack(ScoreMessage(1, std::string("a"), true, 1.0));
+	store[5].SetAge(5);
+	store = small;
+	store.Resize(10);
+	TEST_CHECK(store.GetMessage(0) == ScoreMessage(1, std::string("a"), true, 1.0));
+	for (std::size_t i = 1; i < store.Size(); ++i) {
+		TEST_CHECK(store.GetMessage(i) == ScoreMessage{});
+	}
+}
+
+
+static void TestPushBackRollback() {
+	messaging::MessageColumnStore<SampleMessage> store;
+	store.PushBack(SampleMessage(1, std::string("first"), SampleVector{ 1, 2 }));
+	const SampleMessage Failing(2, std::string("second"), SampleVector{ 3 });
+	//the id and name columns get their field before the samples column throws
+	g_failAllocations = true;
+	TEST_CHECK_THROWS(store.PushBack(Failing), std::bad_alloc);
+	g_failAllocations = false;
+	TEST_CHECK(store.Size() == 1);
+	TEST_CHECK(store.GetColumn<0>().size() == 1 && store.GetColumn<1>().size() == 1 && store.GetColumn<2>().size() == 1);
+	store.PushBack(Failing);
+	TEST_CHECK(store.Size() == 2 && store.GetMessage(1) == Failing);
+}
+
+
+int main() {
+	TestColumns();
+	TestResizeValueInitializes();
+	TestPushBackRollback();
+	return 0;
+}
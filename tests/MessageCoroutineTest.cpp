@@ -0,0 +1,101 @@
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/MessageCoroutine.h"
+
+#if MESSAGING_HAS_COROUTINES && defined(__linux__)
+DECLMESSAGE(PingMessage,
+	DECLMESSAGEFIELD(int, Number),
+	DECLMESSAGEFIELD(std::string, Text)
+);
+
+static std::atomic<int> g_serverTasks{ 0 };
+static std::atomic<int> g_clientsDone{ 0 };
+
+
+template<typename PredType>
+static bool WaitFor(PredType&& pred) {
+	const auto Deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while (!pred()) {
+		if (std::chrono::steady_clock::now() > Deadline) {
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+
+static messaging::MessageTask Echo(messaging::MessageChannel& channel) {
+	++g_serverTasks;
+	PingMessage msg;
+	while (co_await channel.Receive(msg)) {
+		co_await channel.Send(msg);
+	}
+}
+
+
+static messaging::MessageTask PingClient(messaging::MessageChannel& channel, const int count) {
+	for (int i = 0; i < count; ++i) {
+		co_await channel.Send(PingMessage(i, std::string("ping")));
+		const std::optional<PingMessage> Reply = co_await channel.Receive<PingMessage>();
+		if (!Reply || Reply->GetNumber() != i) {
+			co_return;
+		}
+	}
+	++g_clientsDone;
+}
+
+
+//the thread which listens also connects, the outgoing connection must keep its own task
+static void TestConnectOnListeningThread() {
+	g_serverTasks = 0;
+	g_clientsDone = 0;
+	messaging::CoroutineExecutor executor(1);
+	const std::uint16_t Port = executor.Listen(0, "127.0.0.1", [](messaging::MessageChannel& channel) { return Echo(channel); });
+	const int Clients = 20;
+	for (int i = 0; i < Clients; ++i) {
+		executor.Connect("127.0.0.1", Port, [](messaging::MessageChannel& channel) { return PingClient(channel, 50); }).get();
+	}
+	TEST_CHECK(WaitFor([] { return g_clientsDone == Clients; }));
+	TEST_CHECK(g_serverTasks == Clients);
+}
+
+
+static messaging::MessageTask ReceiveOne(messaging::MessageChannel& channel) {
+	PingMessage msg;
+	co_await channel.Receive(msg);
+}
+
+
+static messaging::MessageTask ExpectClose(messaging::MessageChannel& channel, std::atomic<bool>& isClosed) {
+	co_await channel.Send(PingMessage(1, std::string("last")));
+	const std::optional<PingMessage> Reply = co_await channel.Receive<PingMessage>();
+	isClosed = !Reply.has_value();
+}
+
+
+//a finished task closes its connection without waiting for further events on its thread
+static void TestFinishedTaskClosesConnection() {
+	messaging::CoroutineExecutor server(1);
+	messaging::CoroutineExecutor client(1);
+	const std::uint16_t Port = server.Listen(0, "127.0.0.1", [](messaging::MessageChannel& channel) { return ReceiveOne(channel); });
+	std::atomic<bool> isClosed{ false };
+	client.Connect("127.0.0.1", Port, [&isClosed](messaging::MessageChannel& channel) { return ExpectClose(channel, isClosed); }).get();
+	TEST_CHECK(WaitFor([&isClosed] { return isClosed.load(); }));
+}
+
+
+int main() {
+	TestConnectOnListeningThread();
+	TestFinishedTaskClosesConnection();
+	return 0;
+}
+#else
+int main() {
+	return 0;
+}
+#endif
@@ -0,0 +1,83 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/MessageBus.h"
+#include "Messaging/MessageLog.h"
+
+DECLMESSAGE(PlayerMessage,
+	DECLMESSAGEFIELD(int, Age),
+	DECLMESSAGEFIELD(std::string, Name)
+);
+
+DECLMESSAGE(ScoreMessage,
+	DECLMESSAGEFIELD(std::vector<int>, Scores)
+);
+
+using PlayerScoreMessage = messaging::FlatCombinedMessage<PlayerMessage, ScoreMessage>;
+
+
+static void TestAccessors() {
+	PlayerScoreMessage msg;
+	msg.SetAge(23);
+	msg.SetName("Gerald");
+	msg.EmplaceScores(std::size_t(2), 7).push_back(5);
+	const PlayerScoreMessage& ConstMsg = msg;
+	TEST_CHECK(ConstMsg.GetAge() == 23 && ConstMsg.GetName() == "Gerald");
+	TEST_CHECK((ConstMsg.GetScores() == std::vector<int>{ 7, 7, 5 }));
+	msg.GetAge() = 24;
+	TEST_CHECK((msg.GetPartField<PlayerMessage, PlayerMessage::FieldName::Age>() == 24));
+	TEST_CHECK(msg.GetPart<ScoreMessage>().GetScores() == msg.GetScores());
+}
+
+
+static void TestName() {
+	TEST_CHECK(std::strcmp(PlayerScoreMessage::MessageStringName, "FlatCombinedMessage<PlayerMessage,ScoreMessage>") == 0);
+	TEST_CHECK(sizeof(PlayerScoreMessage::MessageStringName) == std::strlen(PlayerScoreMessage::MessageStringName) + 1);
+	TEST_CHECK(messaging::MessageTypeId<PlayerScoreMessage> != messaging::MessageTypeId<PlayerMessage>);
+	TEST_CHECK((messaging::MessageTypeId<PlayerScoreMessage> != messaging::MessageTypeId<messaging::FlatCombinedMessage<ScoreMessage, PlayerMessage>>));
+}
+
+
+static void TestBus() {
+	messaging::MessageBus bus;
+	int combined = 0;
+	int players = 0;
+	bus.Subscribe<PlayerScoreMessage>([&combined](const PlayerScoreMessage& msg) { combined += msg.GetAge(); });
+	bus.Subscribe<PlayerMessage>([&players](const PlayerMessage&) { ++players; });
+	PlayerScoreMessage msg;
+	msg.SetAge(3);
+	TEST_CHECK(bus.Publish(msg) == 1);
+	TEST_CHECK(combined == 3 && players == 0);
+}
+
+
+static void TestLog() {
+	const std::string BasePath = "flatcombined";
+	std::remove(messaging::INTERNAL::MessageLogSegmentName(BasePath, 0, "log").c_str());
+	std::remove(messaging::INTERNAL::MessageLogSegmentName(BasePath, 0, "idx").c_str());
+	PlayerScoreMessage msg = PlayerScoreMessage::FromParts(PlayerMessage(30, "Merlin"), ScoreMessage(std::vector<int>{ 1, 2 }));
+	{
+		messaging::MessageLogWriter writer(BasePath);
+		writer.Append(PlayerMessage(1, "other"));
+		writer.Append(msg);
+	}
+	messaging::MessageLogReader reader(BasePath);
+	messaging::MessageLogRecord record;
+	TEST_CHECK(reader.ReadRecord(1, record) && record.Is<PlayerScoreMessage>() && !record.Is<PlayerMessage>());
+	PlayerScoreMessage result;
+	TEST_CHECK(reader.ReadMessage(1, result));
+	TEST_CHECK(result == msg);
+	TEST_CHECK(!reader.ReadMessage(0, result));
+}
+
+
+int main() {
+	TestAccessors();
+	TestName();
+	TestBus();
+	TestLog();
+	return 0;
+}
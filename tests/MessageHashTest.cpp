@@ -0,0 +1,54 @@
+#include <string>
+#include <unordered_set>
+#include "TestUtils.h"
+//g++ only allows explicit instantiations of messaging::BasicMessage in a namespace enclosing messaging
+#define DECLMESSAGE_ALLOW_EXPLICIT_TEMPLATE_INSTANTATION 1
+#include "Reflective_Messages.h"
+#include "Messaging/MessageHash.h"
+
+//messages declared in a namespace must not need anything in the global namespace
+namespace game {
+	DECLMESSAGE(PlayerMessage,
+		DECLMESSAGEFIELD(int, Id),
+		DECLMESSAGEFIELD(std::string, Name)
+	);
+
+	DECLSTATICMESSAGE(PositionMessage,
+		DECLMESSAGEFIELD(int, X),
+		DECLMESSAGEFIELD(int, Y)
+	);
+}//namespace game
+
+DECLMESSAGE_STD_HASH(game::PositionMessage)
+
+
+static void TestMessageHash() {
+	const game::PlayerMessage first(1, std::string("a"));
+	game::PlayerMessage second = first;
+	TEST_CHECK(messaging::HashMessage(first) == messaging::HashMessage(second));
+	second.SetName("b");
+	TEST_CHECK(messaging::HashMessage(first) != messaging::HashMessage(second));
+
+	std::unordered_set<game::PlayerMessage, messaging::MessageHash> players;
+	players.insert(first);
+	players.insert(second);
+	players.insert(first);
+	TEST_CHECK(players.size() == 2);
+}
+
+
+static void TestStdHash() {
+	const game::PositionMessage pos(1, 2);
+	TEST_CHECK(std::hash<game::PositionMessage>{}(pos) == messaging::HashMessage(pos));
+	std::unordered_set<game::PositionMessage> positions;
+	positions.insert(pos);
+	positions.insert(game::PositionMessage(1, 2));
+	TEST_CHECK(positions.size() == 1);
+}
+
+
+int main() {
+	TestMessageHash();
+	TestStdHash();
+	return 0;
+}
@@ -0,0 +1,58 @@
+#include <string>
+#include <vector>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/MessageInlineFields.h"
+
+
+static void TestZeroInlineCapacity() {
+	messaging::SmallVector<int, 0> vec;
+	for (int i = 0; i < 100; ++i) {
+		vec.push_back(i);
+	}
+	TEST_CHECK(vec.size() == 100 && !vec.IsInline());
+	for (int i = 0; i < 100; ++i) {
+		TEST_CHECK(vec[i] == i);
+	}
+	messaging::SmallVector<std::string, 0> strings;
+	strings.emplace_back("first");
+	strings.emplace_back(3, 'x');
+	TEST_CHECK(strings.size() == 2 && strings[0] == "first" && strings[1] == "xxx");
+}
+
+
+static void TestPushBackOwnElement() {
+	messaging::SmallVector<std::string, 2> vec;
+	vec.push_back(std::string(64, 'a'));
+	vec.push_back(std::string(64, 'b'));
+	TEST_CHECK(vec.size() == vec.capacity());
+	//the argument lives in the inline buffer that is given up by the growth
+	vec.push_back(vec[0]);
+	TEST_CHECK(vec.size() == 3 && !vec.IsInline());
+	TEST_CHECK(vec[2] == std::string(64, 'a') && vec[0] == vec[2]);
+	while (vec.size() != vec.capacity()) {
+		vec.push_back(vec.back());
+	}
+	vec.emplace_back(vec[1]);
+	TEST_CHECK(vec.back() == std::string(64, 'b'));
+	vec.push_back(std::move(vec.back()));
+	TEST_CHECK(vec.back() == std::string(64, 'b'));
+}
+
+
+static void TestInlineStringSelfAppend() {
+	messaging::InlineString<8> str("abcdefgh");
+	TEST_CHECK(str.IsInline());
+	str.append(str.data(), str.size());
+	TEST_CHECK(str == "abcdefghabcdefgh" && !str.IsInline());
+	str.append(str.data() + 8, 8);
+	TEST_CHECK(str == "abcdefghabcdefghabcdefgh");
+}
+
+
+int main() {
+	TestZeroInlineCapacity();
+	TestPushBackOwnElement();
+	TestInlineStringSelfAppend();
+	return 0;
+}
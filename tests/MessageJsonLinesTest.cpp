@@ -0,0 +1,87 @@
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/MessageJsonLines.h"
+
+DECLMESSAGE(ChatMessage,
+	DECLMESSAGEFIELD(int, Channel),
+	DECLMESSAGEFIELD(std::string, Text)
+);
+
+
+static std::vector<ChatMessage> MakeMessages(const int count) {
+	std::vector<ChatMessage> messages;
+	for (int i = 0; i < count; ++i) {
+		messages.emplace_back(i, "text " + std::to_string(i));
+	}
+	return messages;
+}
+
+
+static void TestSplit() {
+	const std::string Lines = "{\"a\":1}\n{\"a\":2}\n{\"a\":3}\n{\"a\":4}";
+	const auto Chunks = messaging::INTERNAL::SplitJsonLines(Lines.data(), Lines.size(), 3);
+	TEST_CHECK(!Chunks.empty() && Chunks.front().pBegin == Lines.data() && Chunks.back().pEnd == Lines.data() + Lines.size());
+	for (std::size_t i = 0; i < Chunks.size(); ++i) {
+		//the chunks are back to back and only the last one may end without a '\n'
+		TEST_CHECK(i == 0 || Chunks[i].pBegin == Chunks[i - 1].pEnd);
+		TEST_CHECK(i + 1 == Chunks.size() || *(Chunks[i].pEnd - 1) == '\n');
+	}
+	TEST_CHECK(messaging::INTERNAL::SplitJsonLines(Lines.data(), 0, 4).empty());
+	TEST_CHECK(messaging::INTERNAL::SplitJsonLines(Lines.data(), Lines.size(), 0).size() == 1);
+}
+
+
+static void TestOrderAcrossChunks() {
+	const std::vector<ChatMessage> Messages = MakeMessages(1000);
+	const std::string Lines = messaging::json_serilization::SerializeLines(Messages);
+	for (const std::size_t ThreadCount : { std::size_t{ 1 }, std::size_t{ 3 }, std::size_t{ 8 }, std::size_t{ 64 } }) {
+		//messages already in the vector are kept in front
+		std::vector<ChatMessage> result{ ChatMessage(-1, std::string("kept")) };
+		messaging::json_serilization::DeserializeLines(result, Lines, ThreadCount);
+		TEST_CHECK(result.size() == Messages.size() + 1 && result[0].GetChannel() == -1);
+		TEST_CHECK(std::equal(Messages.begin(), Messages.end(), result.begin() + 1));
+	}
+}
+
+
+static void TestCrlfAndBlankLines() {
+	const std::string Lines = "\r\n{\"Channel\":1,\"Text\":\"a\"}\r\n\n\n{\"Channel\":2,\"Text\":\"b\"}\r\n\r\n{\"Channel\":3,\"Text\":\"c\"}";
+	std::vector<ChatMessage> result;
+	messaging::json_serilization::DeserializeLines(result, Lines, 4);
+	TEST_CHECK(result.size() == 3 && result[0] == ChatMessage(1, std::string("a")) &&
+		result[1] == ChatMessage(2, std::string("b")) && result[2] == ChatMessage(3, std::string("c")));
+}
+
+
+static void TestParseError() {
+	std::string lines = messaging::json_serilization::SerializeLines(MakeMessages(200));
+	lines += "{\"Channel\":5,\"Text\":\n";
+	lines += messaging::json_serilization::SerializeLines(MakeMessages(200));
+	std::vector<ChatMessage> result;
+	TEST_CHECK_THROWS(messaging::json_serilization::DeserializeLines(result, lines, 4), messaging::json_serilization::JsonSerilizationException);
+	//nothing is appended if a line is broken
+	TEST_CHECK(result.empty());
+}
+
+
+static void TestFromFile() {
+	const std::vector<ChatMessage> Messages = MakeMessages(100);
+	TEST_CHECK(file_utils::FileWriteAllText("messages.jsonl", messaging::json_serilization::SerializeLines(Messages)));
+	std::vector<ChatMessage> result;
+	TEST_CHECK(messaging::json_serilization::DeserializeLinesFromFile(result, "messages.jsonl", 2));
+	TEST_CHECK(result == Messages);
+	TEST_CHECK(!messaging::json_serilization::DeserializeLinesFromFile(result, "missing.jsonl"));
+}
+
+
+int main() {
+	TestSplit();
+	TestOrderAcrossChunks();
+	TestCrlfAndBlankLines();
+	TestParseError();
+	TestFromFile();
+	return 0;
+}
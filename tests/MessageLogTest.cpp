@@ -0,0 +1,132 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/MessageLog.h"
+
+DECLMESSAGE(ChatMessage,
+	DECLMESSAGEFIELD(int, Sender),
+	DECLMESSAGEFIELD(std::string, Text)
+);
+
+
+static messaging::MessageLogOptions SmallSegments() {
+	messaging::MessageLogOptions options;
+	options.MaxSegmentSize = 4096;
+	options.IndexInterval = 8;
+	options.GroupCommitRecords = 50;
+	options.SyncOnFlush = false;
+	return options;
+}
+
+
+static void RemoveLog(const std::string& basePath) {
+	for (std::uint32_t i = 0; i < 64; ++i) {
+		std::remove(messaging::INTERNAL::MessageLogSegmentName(basePath, i, "log").c_str());
+		std::remove(messaging::INTERNAL::MessageLogSegmentName(basePath, i, "idx").c_str());
+	}
+}
+
+
+static void AppendChat(messaging::MessageLogWriter& writer, const int first, const int count) {
+	for (int i = first; i < first + count; ++i) {
+		TEST_CHECK(writer.Append(ChatMessage(i, "text " + std::to_string(i))) == static_cast<std::uint64_t>(i));
+	}
+}
+
+
+static void CheckChat(const std::string& basePath, const int count) {
+	messaging::MessageLogReader reader(basePath);
+	TEST_CHECK(reader.GetRecordCount() == static_cast<std::uint64_t>(count));
+	for (int i = 0; i < count; ++i) {
+		ChatMessage msg;
+		TEST_CHECK(reader.ReadMessage(i, msg));
+		TEST_CHECK(msg.GetSender() == i && msg.GetText() == "text " + std::to_string(i));
+	}
+	int replayed = 0;
+	reader.Replay([&replayed](const messaging::MessageLogRecord& record) {
+		TEST_CHECK(record.Is<ChatMessage>() && record.Index == static_cast<std::uint64_t>(replayed));
+		++replayed;
+	});
+	TEST_CHECK(replayed == count);
+}
+
+
+static void TestContinueLastSegment() {
+	const std::string BasePath = "continue";
+	RemoveLog(BasePath);
+	{
+		messaging::MessageLogWriter writer(BasePath, SmallSegments());
+		AppendChat(writer, 0, 10);
+	}
+	{
+		messaging::MessageLogWriter writer(BasePath, SmallSegments());
+		TEST_CHECK(writer.GetRecordCount() == 10);
+		AppendChat(writer, 10, 10);
+	}
+	TEST_CHECK(messaging::MessageLogReader(BasePath).GetSegmentCount() == 1);
+	CheckChat(BasePath, 20);
+
+	{
+		messaging::MessageLogWriter writer(BasePath, SmallSegments());
+		AppendChat(writer, 20, 500);
+	}
+	const std::uint32_t SegmentCount = messaging::MessageLogReader(BasePath).GetSegmentCount();
+	TEST_CHECK(SegmentCount > 1);
+	{
+		messaging::MessageLogWriter writer(BasePath, SmallSegments());
+		AppendChat(writer, 520, 1);
+	}
+	TEST_CHECK(messaging::MessageLogReader(BasePath).GetSegmentCount() == SegmentCount);
+	CheckChat(BasePath, 521);
+}
+
+
+static void TestEmptyTailSegment() {
+	const std::string BasePath = "emptytail";
+	RemoveLog(BasePath);
+	{
+		messaging::MessageLogWriter writer(BasePath, SmallSegments());
+		AppendChat(writer, 0, 300);
+	}
+	//a crash between creating the next segment and writing its header
+	const std::uint32_t SegmentCount = messaging::MessageLogReader(BasePath).GetSegmentCount();
+	std::fclose(std::fopen(messaging::INTERNAL::MessageLogSegmentName(BasePath, SegmentCount, "log").c_str(), "wb"));
+	CheckChat(BasePath, 300);
+	{
+		messaging::MessageLogWriter writer(BasePath, SmallSegments());
+		AppendChat(writer, 300, 100);
+	}
+	CheckChat(BasePath, 400);
+}
+
+
+static void TestTornTail() {
+	const std::string BasePath = "torntail";
+	RemoveLog(BasePath);
+	{
+		messaging::MessageLogWriter writer(BasePath, SmallSegments());
+		AppendChat(writer, 0, 20);
+	}
+	//half of a record written behind the valid ones
+	FILE* pFile = std::fopen(messaging::INTERNAL::MessageLogSegmentName(BasePath, 0, "log").c_str(), "ab");
+	const char Garbage[7] = { 40, 0, 0, 0, 1, 2, 3 };
+	std::fwrite(Garbage, sizeof(Garbage), 1, pFile);
+	std::fclose(pFile);
+	CheckChat(BasePath, 20);
+	{
+		messaging::MessageLogWriter writer(BasePath, SmallSegments());
+		AppendChat(writer, 20, 20);
+	}
+	TEST_CHECK(messaging::MessageLogReader(BasePath).GetSegmentCount() == 1);
+	CheckChat(BasePath, 40);
+}
+
+
+int main() {
+	TestContinueLastSegment();
+	TestEmptyTailSegment();
+	TestTornTail();
+	return 0;
+}
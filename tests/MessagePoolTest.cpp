@@ -0,0 +1,97 @@
+#include <new>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/MessagePool.h"
+
+DECLMESSAGE(ChatMessage,
+	DECLMESSAGEFIELD(int, Sender),
+	DECLMESSAGEFIELD(std::string, Text)
+);
+
+struct alignas(64) Vec4 {
+	float X, Y, Z, W;
+	bool operator==(const Vec4& other) const noexcept { return X == other.X && Y == other.Y && Z == other.Z && W == other.W; }
+	bool operator!=(const Vec4& other) const noexcept { return !(*this == other); }
+};
+
+DECLMESSAGE(TransformMessage,
+	DECLMESSAGEFIELD(int, Id),
+	DECLMESSAGEFIELD(Vec4, Position)
+);
+
+static bool IsAligned(const void* pData, const std::size_t alignment) noexcept {
+	return reinterpret_cast<std::uintptr_t>(pData) % alignment == 0;
+}
+
+
+static void TestPoolReuse() {
+	using Pool = messaging::MessagePool<ChatMessage>;
+	Pool::Release();
+	const ChatMessage Msg(1, "hello");
+	std::unique_ptr<messaging::IMessage> pFirst = Msg.Clone();
+	const void* pFirstAddress = pFirst.get();
+	pFirst.reset();
+	TEST_CHECK(Pool::GetFreeCount() == 1);
+	std::unique_ptr<messaging::IMessage> pSecond = Msg.Clone();
+	TEST_CHECK(pSecond.get() == pFirstAddress);
+	TEST_CHECK(Pool::GetFreeCount() == 0);
+	TEST_CHECK(*static_cast<ChatMessage*>(pSecond.get()) == Msg);
+	pSecond.reset();
+
+	Pool::Reserve(8);
+	TEST_CHECK(Pool::GetFreeCount() == 8);
+	Pool::Release();
+	TEST_CHECK(Pool::GetFreeCount() == 0);
+}
+
+
+static void TestNothrowNew() {
+	ChatMessage* pMsg = new (std::nothrow) ChatMessage(2, "nothrow");
+	TEST_CHECK(pMsg != nullptr && pMsg->GetText() == "nothrow");
+	delete pMsg;
+}
+
+
+static void TestOverAlignedMessage() {
+	const TransformMessage Msg(3, Vec4{ 1.0f, 2.0f, 3.0f, 4.0f });
+	for (int i = 0; i < 4; ++i) {
+		const std::unique_ptr<messaging::IMessage> pClone = Msg.Clone();
+		TEST_CHECK(IsAligned(pClone.get(), alignof(TransformMessage)));
+		TEST_CHECK(*static_cast<const TransformMessage*>(pClone.get()) == Msg);
+	}
+	TEST_CHECK(messaging::MessagePool<TransformMessage>::GetFreeCount() == 0);
+	const std::unique_ptr<TransformMessage> pMsg(new (std::nothrow) TransformMessage(Msg));
+	TEST_CHECK(pMsg != nullptr && IsAligned(pMsg.get(), alignof(TransformMessage)));
+}
+
+
+static void TestArena() {
+	messaging::MessageArena arena(256);
+	{
+		const auto pChat = arena.Create<ChatMessage>(4, "arena");
+		const auto pTransform = arena.Create<TransformMessage>(5, Vec4{ 1.0f, 1.0f, 1.0f, 1.0f });
+		TEST_CHECK(IsAligned(pTransform.get(), alignof(TransformMessage)));
+		const auto pClone = arena.Clone(*pChat);
+		TEST_CHECK(*pClone == *pChat && pClone.get() != pChat.get());
+		//bigger than a block
+		const auto pBig = arena.Allocate(1024, 16);
+		TEST_CHECK(pBig != nullptr && IsAligned(pBig, 16));
+		TEST_CHECK(arena.GetUsedBytes() >= sizeof(ChatMessage) * 2 + sizeof(TransformMessage) + 1024);
+	}
+	arena.Reset();
+	TEST_CHECK(arena.GetUsedBytes() == 0);
+	const auto pChat = arena.Create<ChatMessage>(6, "after reset");
+	TEST_CHECK(pChat->GetSender() == 6 && pChat->GetText() == "after reset");
+}
+
+
+int main() {
+	TestPoolReuse();
+	TestNothrowNew();
+	TestOverAlignedMessage();
+	TestArena();
+	return 0;
+}
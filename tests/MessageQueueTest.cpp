@@ -0,0 +1,109 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/MessageQueue.h"
+
+DECLMESSAGE(ChatMessage,
+	DECLMESSAGEFIELD(int, Sender),
+	DECLMESSAGEFIELD(std::string, Text)
+);
+
+
+static void TestThrowingFill() {
+	messaging::MpscMessageQueue<ChatMessage> queue(8);
+	TEST_CHECK(queue.TryPush(ChatMessage(1, "first")));
+	TEST_CHECK_THROWS(queue.TryPushInPlace([](ChatMessage&) { throw std::runtime_error{ "fill failed" }; }), std::runtime_error);
+	TEST_CHECK(queue.TryPush(ChatMessage(2, "second")));
+
+	std::vector<ChatMessage> popped;
+	TEST_CHECK(queue.PopBatch(std::back_inserter(popped), 8) == 2);
+	TEST_CHECK(popped.size() == 2 && popped[0].GetSender() == 1 && popped[1].GetSender() == 2);
+	TEST_CHECK(queue.GetSizeApprox() == 0);
+}
+
+
+//throws when the element at ThrowAt is read
+struct ThrowingIterator {
+	int Pos;
+	int ThrowAt;
+	ChatMessage operator*() const {
+		if (Pos == ThrowAt) {
+			throw std::runtime_error{ "read failed" };
+		}
+		return ChatMessage(Pos, "batch");
+	}
+	ThrowingIterator& operator++() {
+		++Pos;
+		return *this;
+	}
+};
+
+
+static void TestThrowingBatch() {
+	messaging::MpscMessageQueue<ChatMessage> queue(16);
+	TEST_CHECK_THROWS(queue.PushBatch(ThrowingIterator{ 0, 3 }, 8), std::runtime_error);
+	TEST_CHECK(queue.TryPush(ChatMessage(100, "after")));
+
+	std::vector<int> senders;
+	ChatMessage msg;
+	while (queue.TryPop(msg)) {
+		senders.push_back(msg.GetSender());
+	}
+	TEST_CHECK((senders == std::vector<int>{ 0, 1, 2, 100 }));
+	//the slots of the failed batch are free again
+	TEST_CHECK(queue.PushBatch(ThrowingIterator{ 0, -1 }, 16) == 16);
+}
+
+
+static void TestProducers() {
+	constexpr int ProducerCount = 4;
+	constexpr int PerProducer = 20000;
+	messaging::MpscMessageQueue<ChatMessage> queue(256);
+	std::vector<std::thread> producers;
+	for (int p = 0; p < ProducerCount; ++p) {
+		producers.emplace_back([&queue, p] {
+			for (int i = 0; i < PerProducer; ++i) {
+				//every 100th fill fails and has to be skipped by the consumer
+				if (i % 100 == 99) {
+					while (true) {
+						try {
+							if (queue.TryPushInPlace([](ChatMessage&) { throw std::runtime_error{ "fill failed" }; })) {
+								break;
+							}
+						} catch (const std::runtime_error&) {
+							break;
+						}
+						std::this_thread::yield();
+					}
+				}
+				while (!queue.TryPush(ChatMessage(p * PerProducer + i, "chat"))) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	std::vector<int> next(ProducerCount, 0);
+	int received = 0;
+	while (received < ProducerCount * PerProducer) {
+		received += static_cast<int>(queue.ConsumeBatch([&next](ChatMessage& msg) {
+			const int Producer = msg.GetSender() / PerProducer;
+			TEST_CHECK(msg.GetSender() % PerProducer == next[Producer]);
+			++next[Producer];
+		}));
+	}
+	for (auto& producer : producers) {
+		producer.join();
+	}
+	TEST_CHECK(queue.GetSizeApprox() == 0);
+}
+
+
+int main() {
+	TestThrowingFill();
+	TestThrowingBatch();
+	TestProducers();
+	return 0;
+}
@@ -0,0 +1,204 @@
+#include <string>
+#include <vector>
+#include <future>
+#include <stdexcept>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/MessageRpc.h"
+
+DECLMESSAGE(AddRequest,
+	DECLMESSAGEFIELD(int, A),
+	DECLMESSAGEFIELD(int, B)
+);
+
+DECLMESSAGE(AddResponse,
+	DECLMESSAGEFIELD(int, Sum),
+	DECLMESSAGEFIELD(std::string, Note)
+);
+
+DECLMESSAGE(UnknownRequest,
+	DECLMESSAGEFIELD(int, Value)
+);
+
+
+class ThrowingTransport final : public messaging::ITransport {
+public:
+	virtual void Send(const messaging::ByteSpan bytes) override {
+		(void)bytes;
+		throw std::runtime_error{ "connection lost" };
+	}
+};
+
+
+static void RegisterAdd(messaging::RpcServer& server) {
+	server.Handle<AddRequest, AddResponse>([](const AddRequest& request) {
+		if (request.GetA() < 0) {
+			throw std::runtime_error{ "negative" };
+		}
+		return AddResponse(request.GetA() + request.GetB(), std::string("ok"));
+	});
+}
+
+
+//runs every request frame sent to the server and returns the reply frames
+static std::vector<std::vector<messaging::Byte>> RunServer(messaging::RpcServer& server,
+	messaging::LoopbackTransport& toServer, messaging::LoopbackTransport& toClient) {
+	toServer.ForEachFrame([&](const messaging::ByteSpan frame) { TEST_CHECK(server.OnFrame(toClient, frame)); });
+	toServer.Clear();
+	server.Flush();
+	std::vector<std::vector<messaging::Byte>> replies;
+	toClient.ForEachFrame([&replies](const messaging::ByteSpan frame) { replies.emplace_back(frame.begin(), frame.end()); });
+	toClient.Clear();
+	return replies;
+}
+
+
+static void TestCallAndResponse() {
+	messaging::LoopbackTransport toServer;
+	messaging::LoopbackTransport toClient;
+	messaging::RpcClient client(toServer);
+	messaging::RpcServer server;
+	RegisterAdd(server);
+
+	std::future<AddResponse> sum = client.Call<AddRequest, AddResponse>(AddRequest(2, 3));
+	TEST_CHECK(client.GetQueuedCount() == 1 && client.GetInFlightCount() == 1);
+	TEST_CHECK(toServer.GetSendCount() == 0);
+	client.Flush();
+	TEST_CHECK(toServer.GetSendCount() == 1 && client.GetQueuedCount() == 0);
+
+	const auto Replies = RunServer(server, toServer, toClient);
+	TEST_CHECK(Replies.size() == 1);
+	TEST_CHECK(client.OnFrame(messaging::ByteSpan(Replies[0])));
+	//a second response for the same call is no longer expected
+	TEST_CHECK(!client.OnFrame(messaging::ByteSpan(Replies[0])));
+	const AddResponse Response = sum.get();
+	TEST_CHECK(Response.GetSum() == 5 && Response.GetNote() == "ok");
+	TEST_CHECK(client.GetInFlightCount() == 0);
+}
+
+
+static void TestErrorFrames() {
+	messaging::LoopbackTransport toServer;
+	messaging::LoopbackTransport toClient;
+	messaging::RpcClient client(toServer);
+	messaging::RpcServer server;
+	RegisterAdd(server);
+
+	std::future<AddResponse> thrown = client.Call<AddRequest, AddResponse>(AddRequest(-1, 1));
+	std::future<AddResponse> unknown = client.Call<UnknownRequest, AddResponse>(UnknownRequest(3));
+	std::future<UnknownRequest> wrongType = client.Call<AddRequest, UnknownRequest>(AddRequest(1, 1));
+	client.Flush();
+	for (const auto& reply : RunServer(server, toServer, toClient)) {
+		TEST_CHECK(client.OnFrame(messaging::ByteSpan(reply)));
+	}
+	TEST_CHECK_THROWS(thrown.get(), std::runtime_error);
+	TEST_CHECK_THROWS(unknown.get(), std::runtime_error);
+	TEST_CHECK_THROWS(wrongType.get(), std::runtime_error);
+	TEST_CHECK(client.GetInFlightCount() == 0);
+
+	//the message of the handler exception reaches the caller
+	std::string error;
+	client.Call<AddRequest, AddResponse>(AddRequest(-5, 0), [&error](AddResponse* pResponse, const char* pError) {
+		TEST_CHECK(pResponse == nullptr);
+		error = pError;
+	});
+	client.Flush();
+	for (const auto& reply : RunServer(server, toServer, toClient)) {
+		client.OnFrame(messaging::ByteSpan(reply));
+	}
+	TEST_CHECK(error == "negative");
+}
+
+
+static void TestOutOfOrderResponses() {
+	messaging::LoopbackTransport toServer;
+	messaging::LoopbackTransport toClient;
+	messaging::RpcClient client(toServer);
+	messaging::RpcServer server;
+	RegisterAdd(server);
+
+	std::vector<std::future<AddResponse>> sums;
+	for (int i = 0; i < 50; ++i) {
+		sums.push_back(client.Call<AddRequest, AddResponse>(AddRequest(i, 1)));
+	}
+	client.Flush();
+	const auto Replies = RunServer(server, toServer, toClient);
+	TEST_CHECK(Replies.size() == 50);
+	for (auto it = Replies.rbegin(); it != Replies.rend(); ++it) {
+		TEST_CHECK(client.OnFrame(messaging::ByteSpan(*it)));
+	}
+	for (int i = 0; i < 50; ++i) {
+		TEST_CHECK(sums[i].get().GetSum() == i + 1);
+	}
+}
+
+
+static void TestFailAll() {
+	messaging::LoopbackTransport toServer;
+	messaging::RpcClient client(toServer);
+	int failed = 0;
+	const auto OnDone = [&failed](AddResponse* pResponse, const char* pError) {
+		TEST_CHECK(pResponse == nullptr && std::string(pError) == "closed");
+		++failed;
+	};
+	client.Call<AddRequest, AddResponse>(AddRequest(1, 1), OnDone);
+	client.Flush();
+	client.Call<AddRequest, AddResponse>(AddRequest(2, 2), OnDone);
+	client.FailAll("closed");
+	TEST_CHECK(failed == 2);
+	TEST_CHECK(client.GetInFlightCount() == 0 && client.GetQueuedCount() == 0);
+}
+
+
+static void TestBatchLimit() {
+	messaging::LoopbackTransport toServer;
+	messaging::LoopbackTransport toClient;
+	messaging::RpcClient client(toServer, 4);
+	messaging::RpcServer server(3);
+	RegisterAdd(server);
+
+	for (int i = 0; i < 10; ++i) {
+		client.Call<AddRequest, AddResponse>(AddRequest(i, i), [](AddResponse*, const char*) {});
+	}
+	//two full batches went out on their own
+	TEST_CHECK(toServer.GetSendCount() == 2 && toServer.GetFrameCount() == 8);
+	TEST_CHECK(client.GetQueuedCount() == 2 && client.GetInFlightCount() == 10);
+	client.Flush();
+	TEST_CHECK(toServer.GetSendCount() == 3 && toServer.GetFrameCount() == 10);
+
+	toServer.ForEachFrame([&](const messaging::ByteSpan frame) { server.OnFrame(toClient, frame); });
+	TEST_CHECK(toClient.GetSendCount() == 3 && toClient.GetFrameCount() == 9);
+	server.Flush();
+	TEST_CHECK(toClient.GetSendCount() == 4 && toClient.GetFrameCount() == 10);
+}
+
+
+static void TestFailedFlush() {
+	ThrowingTransport transport;
+	messaging::RpcClient client(transport, 2);
+	std::vector<std::string> errors;
+	const auto OnDone = [&errors](AddResponse* pResponse, const char* pError) {
+		TEST_CHECK(pResponse == nullptr);
+		errors.emplace_back(pError);
+	};
+	client.Call<AddRequest, AddResponse>(AddRequest(1, 1), OnDone);
+	TEST_CHECK_THROWS(client.Flush(), std::runtime_error);
+	TEST_CHECK(errors.size() == 1 && errors[0] == "connection lost");
+
+	//the flush of a full batch inside Call reports the error to the calls
+	client.Call<AddRequest, AddResponse>(AddRequest(2, 2), OnDone);
+	client.Call<AddRequest, AddResponse>(AddRequest(3, 3), OnDone);
+	TEST_CHECK(errors.size() == 3);
+	TEST_CHECK(client.GetInFlightCount() == 0 && client.GetQueuedCount() == 0);
+}
+
+
+int main() {
+	TestCallAndResponse();
+	TestErrorFrames();
+	TestOutOfOrderResponses();
+	TestFailAll();
+	TestBatchLimit();
+	TestFailedFlush();
+	return 0;
+}
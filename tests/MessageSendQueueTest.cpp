@@ -0,0 +1,85 @@
+#include <string>
+#include <vector>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/MessageSendQueue.h"
+
+DECLMESSAGE(ChatMessage,
+	DECLMESSAGEFIELD(int, Channel),
+	DECLMESSAGEFIELD(std::string, Text)
+);
+
+
+//every connection writes into its own list of writes, keyed by the connection number
+static std::vector<std::vector<std::vector<messaging::Byte>>> g_writes(2);
+
+class TestWriter final {
+public:
+	explicit TestWriter(const int connection) noexcept : m_connection(connection) {}
+	void operator()(const messaging::Byte* pData, const std::size_t len) {
+		g_writes[m_connection].emplace_back(pData, pData + len);
+	}
+private:
+	int m_connection;
+};
+
+
+static void TestCoalescing() {
+	messaging::SendQueueMap<int, TestWriter> queues(1024);
+	const ChatMessage First(1, "first");
+	const ChatMessage Second(1, "second");
+	queues.Get(0).Push(First);
+	queues.Get(0).Push(Second);
+	queues.Get(1).Push(First);
+	TEST_CHECK(g_writes[0].empty() && g_writes[1].empty());
+	TEST_CHECK(queues.Get(0).GetQueuedBytes() == First.GetMessageSize() + Second.GetMessageSize());
+
+	//what a sender does before it writes to connection 0 directly
+	queues.Flush(0);
+	TEST_CHECK(g_writes[0].size() == 1 && g_writes[1].empty());
+	std::vector<messaging::Byte> expected = messaging::binary_serilization::Serialize(First);
+	const std::vector<messaging::Byte> SecondBytes = messaging::binary_serilization::Serialize(Second);
+	expected.insert(expected.end(), SecondBytes.begin(), SecondBytes.end());
+	TEST_CHECK(g_writes[0][0] == expected);
+	queues.Flush(0);
+	TEST_CHECK(g_writes[0].size() == 1);
+
+	//flushing a connection without a queue doesn't create one
+	queues.Flush(5);
+	TEST_CHECK(queues.GetQueueCount() == 2);
+	queues.FlushAll();
+	TEST_CHECK(g_writes[1].size() == 1 && queues.Get(1).GetWriteCount() == 1);
+}
+
+
+static void TestMaxBytes() {
+	messaging::CoalescingSendQueue<TestWriter> queue(TestWriter(0), 64);
+	g_writes[0].clear();
+	const ChatMessage Msg(2, std::string(40, 'x'));
+	queue.Push(Msg);
+	TEST_CHECK(g_writes[0].empty());
+	queue.Push(Msg);
+	TEST_CHECK(g_writes[0].size() == 1 && queue.GetQueuedBytes() == 0);
+}
+
+
+static void TestRemoveIf() {
+	messaging::SendQueueMap<int, TestWriter> queues(1024);
+	g_writes[0].clear();
+	g_writes[1].clear();
+	queues.Get(0).Push(ChatMessage(3, "kept"));
+	queues.Get(1).Push(ChatMessage(3, "dropped"));
+	//connection 1 is gone, its queue must not be written anymore
+	queues.RemoveIf([](const int connection) { return connection == 1; });
+	TEST_CHECK(queues.GetQueueCount() == 1);
+	queues.FlushAll();
+	TEST_CHECK(g_writes[0].size() == 1 && g_writes[1].empty());
+}
+
+
+int main() {
+	TestCoalescing();
+	TestMaxBytes();
+	TestRemoveIf();
+	return 0;
+}
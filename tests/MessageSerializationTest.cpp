@@ -0,0 +1,141 @@
+#include <string>
+#include <vector>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/CombinedMessage.h"
+#include "Messaging/MessageJsonSerializer.h"
+#include "Messaging/MessageJsonDeserializer.h"
+
+DECLMESSAGE(PersonMessage,
+	DECLMESSAGEFIELD(int, Age),
+	DECLMESSAGEFIELD(std::string, Name),
+	DECLMESSAGEFIELD(std::vector<int>, Numbers)
+);
+
+DECLMESSAGE(TeamMessage,
+	DECLMESSAGEFIELD(std::string, TeamName),
+	DECLMESSAGEFIELD(PersonMessage, Leader),
+	DECLMESSAGEFIELD(std::vector<bool>, Flags)
+);
+
+DECLSTATICMESSAGE(PositionMessage,
+	DECLMESSAGEFIELD(int, X),
+	DECLMESSAGEFIELD(int, Y)
+);
+
+//trivially copyable but with 3 bytes of padding
+DECLSTATICMESSAGE(CellMessage,
+	DECLMESSAGEFIELD(int, Index),
+	DECLMESSAGEFIELD(char, Kind)
+);
+
+DECLSTATICMESSAGE(LabelMessage,
+	DECLMESSAGEFIELD(int, Id),
+	DECLMESSAGEFIELD(std::string, Text)
+);
+
+DECLMESSAGE(MapMessage,
+	DECLMESSAGEFIELD(CellMessage, Origin),
+	DECLMESSAGEFIELD(LabelMessage, Title),
+	DECLMESSAGEFIELD(std::vector<CellMessage>, Cells)
+);
+
+using PersonWithPosition = messaging::CombinedMessage<PersonMessage, TeamMessage>;
+
+
+static void TestFieldNames() {
+	TEST_CHECK(PersonMessage::FieldName::FromString("Name") == PersonMessage::FieldName::Name);
+	TEST_CHECK(PersonMessage::FieldName::FromString("Unknown") == PersonMessage::FieldName::None);
+	TEST_CHECK(PersonMessage::FieldName(PersonMessage::FieldName::Age).ToString() == "Age");
+	TEST_CHECK(PersonMessage::FieldName::GetValueCount() == 4);
+}
+
+
+static void TestBinaryRoundTrip() {
+	PersonMessage person(23, std::string("Gerald"), std::vector<int>{ 1, 2, 3 });
+	TeamMessage team(std::string("Austria"), person, std::vector<bool>{ true, false, true });
+
+	const std::vector<messaging::Byte> bytes = messaging::binary_serilization::Serialize(team);
+	TEST_CHECK(bytes.size() == team.GetMessageSize());
+	TeamMessage result;
+	TEST_CHECK(messaging::binary_serilization::Deserialize(result, bytes) == bytes.size());
+	TEST_CHECK(result == team);
+	TEST_CHECK(result.GetLeader().GetNumbers().size() == 3);
+
+	const PositionMessage pos(1, 2);
+	const std::vector<messaging::Byte> posBytes = messaging::binary_serilization::Serialize(pos);
+	PositionMessage posResult;
+	messaging::binary_serilization::Deserialize(posResult, posBytes);
+	TEST_CHECK(posResult == pos);
+}
+
+
+static void TestNestedStaticMessages() {
+	const MapMessage map(CellMessage(1, 'a'), LabelMessage(7, std::string("start")),
+		std::vector<CellMessage>{ CellMessage(2, 'b'), CellMessage(3, 'c') });
+	//fields only : 5 bytes per cell, the padding of CellMessage is not written
+	const std::size_t CellSize = sizeof(int) + sizeof(char);
+	TEST_CHECK(CellMessage(1, 'a').GetMessageSize() == CellSize);
+	TEST_CHECK(map.GetMessageSize() == CellSize + sizeof(int) + sizeof(messaging::INTERNAL::SerializedSizeDataType) + 5 +
+		sizeof(messaging::INTERNAL::SerializedSizeDataType) + 2 * CellSize);
+
+	const std::vector<messaging::Byte> bytes = messaging::binary_serilization::Serialize(map);
+	TEST_CHECK(bytes.size() == map.GetMessageSize());
+	MapMessage result;
+	TEST_CHECK(messaging::binary_serilization::Deserialize(result, bytes) == bytes.size());
+	TEST_CHECK(result == map);
+	TEST_CHECK(result.GetTitle().GetText() == "start" && result.GetCells()[1].GetKind() == 'c');
+
+	MapMessage jsonResult;
+	messaging::json_serilization::Deserialize(jsonResult, messaging::json_serilization::Serialize(map));
+	TEST_CHECK(jsonResult == map);
+}
+
+
+static void TestJsonRoundTrip() {
+	PersonMessage person(42, std::string("Merlin"), std::vector<int>{ 7 });
+	const std::string json = messaging::json_serilization::Serialize(person);
+	PersonMessage result;
+	messaging::json_serilization::Deserialize(result, json);
+	TEST_CHECK(result == person);
+}
+
+
+static void TestCombinedMessage() {
+	PersonWithPosition combined;
+	combined.SetAge(5);
+	combined.SetTeamName("team");
+	const std::unique_ptr<messaging::IMessage> pClone = combined.Clone();
+	const auto* pCombinedClone = dynamic_cast<const PersonWithPosition*>(pClone.get());
+	TEST_CHECK(pCombinedClone != nullptr);
+	TEST_CHECK(*pCombinedClone == combined);
+
+	const std::vector<messaging::Byte> bytes = messaging::binary_serilization::Serialize(combined);
+	PersonWithPosition result;
+	messaging::binary_serilization::Deserialize(result, bytes);
+	TEST_CHECK(result == combined);
+}
+
+
+static void TestEmplaceAliasing() {
+	PersonMessage person;
+	person.SetName("a name that is too long for the small string buffer");
+	person.SetNumbers(std::vector<int>{ 1, 2, 3 });
+	person.EmplaceName(std::move(person.GetName()));
+	TEST_CHECK(person.GetName() == "a name that is too long for the small string buffer");
+	person.EmplaceName(person.GetName(), 2, 4);
+	TEST_CHECK(person.GetName() == "name");
+	person.EmplaceNumbers(person.GetNumbers().begin() + 1, person.GetNumbers().end());
+	TEST_CHECK((person.GetNumbers() == std::vector<int>{ 2, 3 }));
+}
+
+
+int main() {
+	TestFieldNames();
+	TestBinaryRoundTrip();
+	TestNestedStaticMessages();
+	TestJsonRoundTrip();
+	TestCombinedMessage();
+	TestEmplaceAliasing();
+	return 0;
+}
@@ -0,0 +1,140 @@
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/MessageSharedChannel.h"
+
+DECLMESSAGE(ChatMessage,
+	DECLMESSAGEFIELD(int, Channel),
+	DECLMESSAGEFIELD(std::string, Text)
+);
+
+
+static std::vector<messaging::Byte> MakeBytes(const std::size_t size, const int seed) {
+	std::vector<messaging::Byte> bytes(size);
+	for (std::size_t i = 0; i < size; ++i) {
+		bytes[i] = static_cast<messaging::Byte>((i + seed) & 0xFF);
+	}
+	return bytes;
+}
+
+
+static void TestRoundTrip() {
+	messaging::SharedChannelWriter writer = messaging::SharedChannelWriter::CreateAnonymous(4096);
+	//a reader only gets what is written after it joined
+	TEST_CHECK(writer.TryWriteMessage(ChatMessage(0, std::string("nobody"))));
+	messaging::SharedChannelReader reader = messaging::SharedChannelReader::FromFd(writer.GetFd());
+	TEST_CHECK(writer.GetReaderCount() == 1 && !reader.HasMessages());
+
+	TEST_CHECK(writer.TryWriteMessage(ChatMessage(1, std::string("hello"))));
+	TEST_CHECK(writer.TryWriteMessage(ChatMessage(2, std::string("world"))));
+	std::vector<ChatMessage> received;
+	TEST_CHECK(reader.Read([&received](const messaging::ByteSpan frame) {
+		ChatMessage msg;
+		TEST_CHECK(messaging::DeserializeFrame(msg, frame));
+		received.push_back(msg);
+	}) == 2);
+	TEST_CHECK(received.size() == 2);
+	TEST_CHECK(received[0] == ChatMessage(1, std::string("hello")) && received[1] == ChatMessage(2, std::string("world")));
+	TEST_CHECK(!reader.HasMessages());
+}
+
+
+static void TestWrapAround() {
+	messaging::SharedChannelWriter writer = messaging::SharedChannelWriter::CreateAnonymous(4096);
+	messaging::SharedChannelReader reader = messaging::SharedChannelReader::FromFd(writer.GetFd());
+	//1008 byte records : the 5th one does not fit behind the 4th and is written after a padding record at offset 0
+	for (int i = 0; i < 20; ++i) {
+		const std::vector<messaging::Byte> Bytes = MakeBytes(1000, i);
+		TEST_CHECK(writer.TryWrite(messaging::ByteSpan(Bytes)));
+		std::size_t count = 0;
+		reader.Read([&](const messaging::ByteSpan frame) {
+			TEST_CHECK(std::vector<messaging::Byte>(frame.begin(), frame.end()) == Bytes);
+			++count;
+		});
+		TEST_CHECK(count == 1);
+	}
+}
+
+
+static void TestSlowReaderBlocksWriter() {
+	messaging::SharedChannelWriter writer = messaging::SharedChannelWriter::CreateAnonymous(4096);
+	messaging::SharedChannelReader reader = messaging::SharedChannelReader::FromFd(writer.GetFd());
+	const std::vector<messaging::Byte> Bytes = MakeBytes(1000, 0);
+	std::size_t written = 0;
+	while (writer.TryWrite(messaging::ByteSpan(Bytes))) {
+		++written;
+	}
+	TEST_CHECK(written == 4);
+	//the record which did not fit was not written
+	TEST_CHECK(reader.Read([](const messaging::ByteSpan) {}, 1) == 1);
+	TEST_CHECK(writer.TryWrite(messaging::ByteSpan(Bytes)));
+	TEST_CHECK(!writer.TryWrite(messaging::ByteSpan(Bytes)));
+	TEST_CHECK(reader.Read([](const messaging::ByteSpan) {}) == 4);
+
+	const std::vector<messaging::Byte> TooBig = MakeBytes(8192, 0);
+	TEST_CHECK_THROWS(writer.TryWrite(messaging::ByteSpan(TooBig)), std::runtime_error);
+}
+
+
+static void TestDeadReader() {
+	messaging::SharedChannelWriter writer = messaging::SharedChannelWriter::CreateAnonymous(4096);
+	const pid_t Child = ::fork();
+	if (Child == 0) {
+		//registers as reader and exits without reading or unregistering, like a crash
+		messaging::SharedChannelReader reader = messaging::SharedChannelReader::FromFd(writer.GetFd());
+		::_exit(reader.HasMessages() ? 1 : 0);
+	}
+	int status = 0;
+	TEST_CHECK(Child > 0 && ::waitpid(Child, &status, 0) == Child);
+	TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	TEST_CHECK(writer.GetReaderCount() == 1);
+
+	//once the ring is full the dead reader is removed instead of blocking the writer
+	const std::vector<messaging::Byte> Bytes = MakeBytes(1000, 0);
+	for (int i = 0; i < 10; ++i) {
+		TEST_CHECK(writer.TryWrite(messaging::ByteSpan(Bytes)));
+	}
+	TEST_CHECK(writer.GetReaderCount() == 0);
+}
+
+
+static void TestWait() {
+	messaging::SharedChannelWriter writer = messaging::SharedChannelWriter::CreateAnonymous(4096);
+	messaging::SharedChannelReader reader = messaging::SharedChannelReader::FromFd(writer.GetFd());
+	TEST_CHECK(!reader.Wait(10));
+
+	std::thread sender([&writer] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		writer.TryWriteMessage(ChatMessage(3, std::string("wake up")));
+	});
+	const bool HasMessage = reader.Wait(5000);
+	sender.join();
+	TEST_CHECK(HasMessage);
+	TEST_CHECK(reader.Read([](const messaging::ByteSpan) {}) == 1);
+	TEST_CHECK(!reader.Wait(0));
+}
+
+
+static void TestInvalidCapacity() {
+	messaging::SharedChannelWriter writer = messaging::SharedChannelWriter::CreateAnonymous(8192);
+	//the header claims 8192 bytes of ring, but the file only has room for half of it
+	TEST_CHECK(::ftruncate(writer.GetFd(), messaging::INTERNAL::SharedChannelMapping::GetDataOffset() + 4096) == 0);
+	TEST_CHECK_THROWS(messaging::SharedChannelReader::FromFd(writer.GetFd()), std::runtime_error);
+}
+
+
+int main() {
+	TestRoundTrip();
+	TestWrapAround();
+	TestSlowReaderBlocksWriter();
+	TestDeadReader();
+	TestWait();
+	TestInvalidCapacity();
+	return 0;
+}
@@ -0,0 +1,96 @@
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/MessageTcpTransport.h"
+
+DECLMESSAGE(ChatMessage,
+	DECLMESSAGEFIELD(int, Channel),
+	DECLMESSAGEFIELD(std::string, Text)
+);
+
+
+static void PollBoth(messaging::TcpEventLoop& first, messaging::TcpEventLoop& second) {
+	first.Poll(1);
+	second.Poll(1);
+}
+
+
+static void TestEcho(const messaging::TcpBackend backend) {
+	messaging::TcpEventLoop server(messaging::TcpEventLoop::DefaultMaxFrameSize, backend);
+	messaging::TcpEventLoop client(messaging::TcpEventLoop::DefaultMaxFrameSize, backend);
+	std::vector<ChatMessage> received;
+	std::size_t badFrames = 0;
+	server.SetFrameHandler([&](messaging::TcpConnection& connection, messaging::ByteSpan frame) {
+		ChatMessage msg;
+		if (!messaging::DeserializeFrame(msg, frame)) {
+			++badFrames;
+			return;
+		}
+		received.push_back(msg);
+		messaging::TransmitMessage(connection, msg);
+	});
+	const std::uint16_t Port = server.Listen(0, "127.0.0.1");
+	std::size_t echoed = 0;
+	client.SetFrameHandler([&](messaging::TcpConnection&, messaging::ByteSpan frame) {
+		ChatMessage msg;
+		TEST_CHECK(messaging::DeserializeFrame(msg, frame));
+		++echoed;
+	});
+	messaging::TcpConnection& connection = client.Connect("127.0.0.1", Port);
+	const ChatMessage Small(1, std::string("one"));
+	const ChatMessage Big(2, std::string(60000, 'x'));
+	const int Count = 500;
+	for (int i = 0; i < Count; ++i) {
+		messaging::TransmitMessage(connection, Small);
+		messaging::TransmitMessage(connection, Big);
+	}
+	//a frame holding only the first bytes of a message
+	const std::vector<messaging::Byte> Bytes = messaging::binary_serilization::Serialize(Small);
+	connection.Send(messaging::ByteSpan(Bytes.data(), Bytes.size() - 1));
+	for (int i = 0; i < 5000 && (received.size() + badFrames < 2 * Count + 1 || echoed < received.size()); ++i) {
+		PollBoth(server, client);
+	}
+	TEST_CHECK(received.size() == 2 * Count);
+	TEST_CHECK(badFrames == 1);
+	TEST_CHECK(echoed == received.size());
+	TEST_CHECK(received.front() == Small && received.back() == Big);
+}
+
+
+//a send failing outside of Poll has to destroy the connection like any other error
+static void TestSendFailureCloses(const messaging::TcpBackend backend) {
+	messaging::TcpEventLoop server(messaging::TcpEventLoop::DefaultMaxFrameSize, backend);
+	messaging::TcpEventLoop client(messaging::TcpEventLoop::DefaultMaxFrameSize, backend);
+	const std::uint16_t Port = server.Listen(0, "127.0.0.1");
+	int connects = 0;
+	int disconnects = 0;
+	client.SetConnectHandler([&](messaging::TcpConnection&) { ++connects; });
+	client.SetDisconnectHandler([&](messaging::TcpConnection&) { ++disconnects; });
+	messaging::TcpConnection& connection = client.Connect("127.0.0.1", Port);
+	for (int i = 0; i < 1000 && (connects == 0 || server.GetConnectionCount() == 0); ++i) {
+		PollBoth(server, client);
+	}
+	TEST_CHECK(connects == 1);
+	//io_uring must not switch the socket to blocking, sends outside of Poll would block then
+	TEST_CHECK((::fcntl(connection.GetSocket(), F_GETFL) & O_NONBLOCK) != 0);
+
+	::shutdown(connection.GetSocket(), SHUT_WR);
+	messaging::TransmitMessage(connection, ChatMessage(1, std::string("lost")));
+	for (int i = 0; i < 100 && disconnects == 0; ++i) {
+		client.Poll(1);
+	}
+	TEST_CHECK(disconnects == 1);
+	TEST_CHECK(client.GetConnectionCount() == 0);
+}
+
+
+int main() {
+	for (const auto Backend : { messaging::TcpBackend::Epoll, messaging::TcpBackend::Auto }) {
+		TestEcho(Backend);
+		TestSendFailureCloses(Backend);
+	}
+	return 0;
+}
@@ -0,0 +1,91 @@
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TestUtils.h"
+#include "Reflective_Messages.h"
+#include "Messaging/MessageTransport.h"
+#include "Messaging/MessageSendQueue.h"
+
+DECLMESSAGE(ChatMessage,
+	DECLMESSAGEFIELD(int, Channel),
+	DECLMESSAGEFIELD(std::string, Text)
+);
+
+DECLMESSAGE(ListMessage,
+	DECLMESSAGEFIELD(std::vector<int>, Numbers),
+	DECLMESSAGEFIELD(std::string, Text),
+	DECLMESSAGEFIELD(std::vector<bool>, Flags)
+);
+
+
+static void TestLoopbackTransport() {
+	const ChatMessage first(5, std::string("hello"));
+	const ChatMessage second(6, std::string("x"));
+	messaging::LoopbackTransport transport;
+	messaging::TransmitMessage(transport, first);
+	messaging::TransmitMessages(transport, first, second);
+	TEST_CHECK(transport.GetSendCount() == 2);
+	//TransmitMessages writes all messages as one frame
+	TEST_CHECK(transport.GetFrameCount() == 2);
+	TEST_CHECK(transport.GetReceived().size() == 2 * first.GetMessageSize() + second.GetMessageSize());
+
+	std::vector<messaging::ByteSpan> frames;
+	transport.ForEachFrame([&frames](messaging::ByteSpan frame) { frames.push_back(frame); });
+	TEST_CHECK(frames.size() == 2);
+	ChatMessage msg;
+	TEST_CHECK(messaging::DeserializeFrame(msg, frames[0]));
+	TEST_CHECK(msg == first);
+	TEST_CHECK(!messaging::DeserializeFrame(msg, frames[1]));
+	TEST_CHECK(messaging::binary_serilization::Deserialize(msg, frames[1].data()) == first.GetMessageSize());
+	TEST_CHECK(msg == first);
+}
+
+
+static void TestSharedBuffers() {
+	const ChatMessage msg(1, std::string("shared"));
+	const messaging::SharedMessageBuffer buffer = messaging::SerializeShared(msg);
+	messaging::LoopbackTransport first;
+	messaging::LoopbackTransport second;
+	messaging::TransportRecipients recipients({ &first, &second });
+	TEST_CHECK(recipients.SendToAll(buffer) == 2);
+	TEST_CHECK(first.GetReceived() == *buffer);
+	TEST_CHECK(second.GetReceived() == *buffer);
+
+	const messaging::SharedMessageBuffer buffers[] = { buffer, buffer };
+	first.Clear();
+	messaging::TransmitBuffers(first, buffers, 2);
+	TEST_CHECK(first.GetSendCount() == 1);
+	TEST_CHECK(first.GetReceived().size() == 2 * buffer->size());
+}
+
+
+//every prefix of a serialized message is rejected without reading past its end
+static void TestTruncatedFrame() {
+	const ListMessage msg(std::vector<int>{ 1, 2, 3, 4 }, std::string("text"), std::vector<bool>{ true, false });
+	const std::vector<messaging::Byte> bytes = messaging::binary_serilization::Serialize(msg);
+	for (std::size_t len = 0; len < bytes.size(); ++len) {
+		//an exactly sized heap copy, so a sanitizer sees any read past the frame
+		std::unique_ptr<messaging::Byte[]> pFrame(new messaging::Byte[len + 1]);
+		std::memcpy(pFrame.get(), bytes.data(), len);
+		ListMessage result;
+		TEST_CHECK(!messaging::DeserializeFrame(result, messaging::ByteSpan(pFrame.get(), len)));
+	}
+	ListMessage result;
+	TEST_CHECK(messaging::DeserializeFrame(result, messaging::ByteSpan(bytes)));
+	TEST_CHECK(result == msg);
+
+	//a length prefix larger than the frame
+	std::vector<messaging::Byte> corrupted = bytes;
+	const messaging::INTERNAL::SerializedSizeDataType HugeLen = 60000;
+	std::memcpy(corrupted.data(), &HugeLen, sizeof(HugeLen));
+	TEST_CHECK(!messaging::DeserializeFrame(result, messaging::ByteSpan(corrupted)));
+}
+
+
+int main() {
+	TestLoopbackTransport();
+	TestSharedBuffers();
+	TestTruncatedFrame();
+	return 0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <iostream>
+#include <cstdlib>
+
+//unlike assert the check stays active in release builds, a failing check ends the test with exit code 1
+#define TEST_CHECK(expr) \
+	do { \
+		if (!(expr)) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << " check failed : " << #expr << std::endl; \
+			std::exit(1); \
+		} \
+	} while (false)
+
+//checks that the statement throws an exception of the given type
+#define TEST_CHECK_THROWS(statement, exceptionType) \
+	do { \
+		bool threw = false; \
+		try { statement; } catch (const exceptionType&) { threw = true; } \
+		TEST_CHECK(threw && #statement); \
+	} while (false)
@@ -36,12 +36,6 @@ namespace INTERNAL {
 	}
 
 
-	template<std::size_t LeftN, std::size_t RightN>
-	constexpr inline bool StringCompare(const char(&leftStr)[LeftN], const char(&rightStr)[RightN]) {
-		return (LeftN == RightN) && StringCompare(static_cast<const char*>(leftStr), static_cast<const char*>(rightStr));
-	}
-
-
 	constexpr inline bool StringCompare(const char* left, const char* right, std::size_t leftLen = 0, std::size_t rightLen = 0) {
 		leftLen = (leftLen == 0) ? StrLen(left) : leftLen;
 		rightLen = (rightLen == 0) ? StrLen(right) : rightLen;
@@ -53,4 +47,20 @@ namespace INTERNAL {
 		}
 		return INTERNAL::CompareStringContents(left, right, leftLen);
 	}
+
+
+	template<std::size_t LeftN, std::size_t RightN>
+	constexpr inline bool StringCompare(const char(&leftStr)[LeftN], const char(&rightStr)[RightN]) {
+		return (LeftN == RightN) && StringCompare(static_cast<const char*>(leftStr), static_cast<const char*>(rightStr));
+	}
+
+
+	//32 bit FNV-1a, usable at compile time e.g. for ids derived from names
+	constexpr inline std::uint32_t StrHash32(const char* str, const std::size_t Len) noexcept {
+		std::uint32_t hash = 2166136261u;
+		for (std::size_t i = 0; i < Len; ++i) {
+			hash = (hash ^ static_cast<std::uint8_t>(str[i])) * 16777619u;
+		}
+		return hash;
+	}
 }
\ No newline at end of file
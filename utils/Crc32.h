@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace utils {
+namespace INTERNAL {
+	struct Crc32Table {
+		constexpr Crc32Table() {
+			for (std::uint32_t i = 0; i < 256; ++i) {
+				std::uint32_t crc = i;
+				for (int bit = 0; bit < 8; ++bit) {
+					crc = (crc & 1u) ? (crc >> 1) ^ 0xEDB88320u : (crc >> 1);
+				}
+				m_data[i] = crc;
+			}
+		}
+		std::uint32_t m_data[256] = {};
+	};
+
+	static constexpr Crc32Table Crc32LookupTable{};
+}
+
+	//IEEE 802.3 crc32, pass the result of a previous call as crc to continue a checksum over several buffers
+	inline std::uint32_t Crc32(const void* pData, const std::size_t len, std::uint32_t crc = 0) noexcept {
+		const auto* pCur = static_cast<const std::uint8_t*>(pData);
+		crc = ~crc;
+		for (std::size_t i = 0; i < len; ++i) {
+			crc = INTERNAL::Crc32LookupTable.m_data[(crc ^ pCur[i]) & 0xFFu] ^ (crc >> 8);
+		}
+		return ~crc;
+	}
+}